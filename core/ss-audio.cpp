@@ -9,13 +9,25 @@
 #include "ss-globals.h"
 #include "y-fft.h"
 #include "y-waveform.h"
+#include "y-echo.h"
+#include "y-convolver.h"
+#include "y-tapdelay.h"
+#include "y-biquad.h"
+#include "y-spectrum.h"
+#include "y-onset.h"
+#include "y-graph.h"
+#include "x-param.h"
+#include "x-thread.h"
 #include <iostream>
+#include <cmath>
+#include <stdio.h>
 using namespace std;
 
 #define DRUM_CHANNEL 9
 
 // globals
 YFluidSynth * g_synth;
+YFluidSynth * g_drums;
 GLfloat g_BPM = 240;
 GLfloat g_BPS = g_BPM / 60;
 GLfloat g_period = 1 / g_BPS;
@@ -29,6 +41,54 @@ float g_velocity[16] = {1,0.5,0.7,0.5,\
                         1,0.5,0.7,0.5,\
                         1,0.5,0.7,0.5};
 
+// control parameters (UI -> audio, once per buffer; see XParams)
+int g_pBPM = -1;
+int g_pVolume = -1;
+int g_pEchoFeedback = -1;
+int g_pEchoMix = -1;
+int g_pVelocity[16];
+// per track EQ: high-pass, low-pass, low shelf, high shelf
+int g_pDrumsEQ[4];
+int g_pKeysEQ[4];
+
+
+// the master chain: a chain per track (synth -> EQ: drums, keys) -> master, plus
+// keys -> (sends) -> echo / ping-pong -> master and, given an impulse response, both
+// tracks -> (send) -> reverb -> master; tracks render in parallel on g_workers
+YGraph * g_graph = NULL;
+XWorkerPool * g_workers = NULL;
+int g_numWorkers = -1;
+YEcho * g_echo = NULL;
+YConvolver * g_reverb = NULL;
+std::string g_reverbPath;
+int g_drumsNode = -1;
+int g_keysNode = -1;
+YTrackEQ * g_drumsEQ = NULL;
+YTrackEQ * g_keysEQ = NULL;
+// master bus analyser (fed from the callback; runs on its own thread)
+static YSpectrum * g_spectrum = NULL;
+// input analyser -> onsets -> tempo (on its analysis thread); following:
+// the tempo drives "bpm"
+YSpectrum * g_inputSpectrum = NULL;
+YOnsetDetector * g_onsets = NULL;
+YTempoEstimator * g_tempo = NULL;
+std::atomic<bool> g_follow( false );
+// master bus history: min, max of the mono mix per column (see
+// ss_audio_history()), SS_HISTORY_SECONDS across SS_HISTORY_COLUMNS
+static XRingBuffer<float> g_history( 2 * SS_HISTORY_COLUMNS );
+static unsigned long g_historySpan = 1;
+static unsigned long g_historyCount = 0;
+static float g_historyMin = HUGE_VALF;
+static float g_historyMax = -HUGE_VALF;
+int g_echoNode = -1;
+bool g_echoSend = false;
+YTapDelay * g_pingpong = NULL;
+int g_pingpongNode = -1;
+bool g_pingpongSend = false;
+
+// beats played, for printing off the audio thread (see ss_audio_poll())
+XRingBuffer<int> g_beatLog( 64 );
+unsigned long long g_beatLogCursor = 0;
 
 // Note( int c, float p, float v, float d )
 
@@ -36,21 +96,22 @@ float g_velocity[16] = {1,0.5,0.7,0.5,\
 // play some notes
 void play( int beat )
 {
-    //ascii to terminal
-    printState(beat);
+    //ascii to terminal (later, from ss_audio_poll(); no iostreams in here)
+    g_beatLog.put( &beat, 1 );
     updatePlayPlaces();
 
+    // no copies (this is the audio thread)
     int lastBeat = beat-1 == -1 ? 15 : beat-1;
-    vector<int> lastDrumVec = Globals::drumPitchVecs[lastBeat];
-    vector<int> drumVec = Globals::drumPitchVecs[beat];
-    vector<int> lastPitchVec = Globals::pitchVecs[lastBeat];
-    vector<int> pitchVec = Globals::pitchVecs[beat];
+    const vector<int> & lastDrumVec = Globals::drumPitchVecs[lastBeat];
+    const vector<int> & drumVec = Globals::drumPitchVecs[beat];
+    const vector<int> & lastPitchVec = Globals::pitchVecs[lastBeat];
+    const vector<int> & pitchVec = Globals::pitchVecs[beat];
 
     //TURN OFF LAST BEAT
     // drums
     if(lastDrumVec.size()){
         for (int i = 0; i < lastDrumVec.size(); ++i)
-            g_synth->noteOff( DRUM_CHANNEL, lastDrumVec[i] );
+            g_drums->noteOff( DRUM_CHANNEL, lastDrumVec[i] );
     }
     if(lastPitchVec.size()){
         for (int i = 0; i < lastPitchVec.size(); ++i)
@@ -61,7 +122,7 @@ void play( int beat )
     //drums
     if(drumVec.size()){
         for (int i = 0; i < drumVec.size(); ++i)
-            g_synth->noteOn( DRUM_CHANNEL, drumVec[i], g_velocity[beat] * 127 );
+            g_drums->noteOn( DRUM_CHANNEL, drumVec[i], XParams::value( g_pVelocity[beat] ) * 127 );
     }
     if(pitchVec.size()){
         for (int i = 0; i < pitchVec.size(); ++i)
@@ -70,11 +131,100 @@ void play( int beat )
     
 }
 
+//-----------------------------------------------------------------------------
+// name: add_eq()
+// desc: register a track EQ's parameters (flat)
+//-----------------------------------------------------------------------------
+static void add_eq( const std::string & track, int * ids )
+{
+    ids[0] = XParams::add( track + ".hp", SS_EQ_LO, SS_EQ_LO, SS_EQ_HI, XPARAM_SLEW, SS_EQ_SLEW );
+    ids[1] = XParams::add( track + ".lp", SS_EQ_HI, SS_EQ_LO, SS_EQ_HI, XPARAM_SLEW, SS_EQ_SLEW );
+    ids[2] = XParams::add( track + ".low", 0, -SS_EQ_SHELF, SS_EQ_SHELF, XPARAM_LINEAR, SS_EQ_SLEW );
+    ids[3] = XParams::add( track + ".high", 0, -SS_EQ_SHELF, SS_EQ_SHELF, XPARAM_LINEAR, SS_EQ_SLEW );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: apply_eq()
+// desc: pick up a track EQ's changes (cutoffs: table lookups)
+//-----------------------------------------------------------------------------
+static void apply_eq( YTrackEQ * eq, const int * ids )
+{
+    if( XParams::changed( ids[0] ) ) eq->setHighPass( XParams::value( ids[0] ) );
+    if( XParams::changed( ids[1] ) ) eq->setLowPass( XParams::value( ids[1] ) );
+    if( XParams::changed( ids[2] ) ) eq->setLowShelf( XParams::value( ids[2] ) );
+    if( XParams::changed( ids[3] ) ) eq->setHighShelf( XParams::value( ids[3] ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: apply_params()
+// desc: pick up control changes, once per buffer (audio thread)
+//-----------------------------------------------------------------------------
+static void apply_params( unsigned int numFrames )
+{
+    XParams::block( numFrames, XAudioIO::srate() );
+
+    // tempo: takes effect at the next beat; synced delays follow
+    if( XParams::changed( g_pBPM ) )
+    {
+        g_BPM = XParams::value( g_pBPM );
+        g_BPS = g_BPM / 60;
+        g_period = 1 / g_BPS;
+        g_periodInSamples = g_period * XAudioIO::srate();
+        g_pingpong->setDelay( 0, g_period * 0.75f );
+        g_pingpong->setDelay( 1, g_period * 1.5f );
+    }
+    // echo (it ramps these itself)
+    if( XParams::changed( g_pEchoFeedback ) )
+        g_echo->setFeedback( XParams::value( g_pEchoFeedback ) );
+    if( XParams::changed( g_pEchoMix ) )
+        g_echo->setFxMix( XParams::value( g_pEchoMix ) );
+    // track EQs
+    apply_eq( g_drumsEQ, g_pDrumsEQ );
+    apply_eq( g_keysEQ, g_pKeysEQ );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: follow_frame()
+// desc: every input analysis frame (analysis thread): onsets, tempo, and,
+//       if following, the transport
+//-----------------------------------------------------------------------------
+static void follow_frame( const float * magnitudes, unsigned int numBins, void * data )
+{
+    if( !g_onsets->frame( magnitudes ) ) return;
+    g_tempo->onset( g_onsets->time() );
+
+    // sure enough?
+    if( !g_follow.load() || g_tempo->count() < SS_TEMPO_ONSETS ||
+        g_tempo->confidence() < SS_TEMPO_CONFIDENCE )
+        return;
+
+    // the estimate is good to an octave: take the one nearest where we are
+    float now = XParams::target( g_pBPM );
+    float steps = g_tempo->bpm() * SS_STEPS_PER_BEAT;
+    while( steps * 1.4142f < now && steps * 2 <= SS_BPM_MAX ) steps *= 2;
+    while( steps > now * 1.4142f && steps / 2 >= SS_BPM_MIN ) steps /= 2;
+    if( fabs( steps - now ) > 0.5f )
+        XParams::set( g_pBPM, steps );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: audio_callback
 // desc: audio callback
 //-----------------------------------------------------------------------------
-static void audio_callback( SAMPLE * buffer, unsigned int numFrames, void * userData )
+static void audio_callback( SAMPLE * buffer, const SAMPLE * input,
+                            unsigned int numFrames, void * userData )
 {
 
     // no sound during intro
@@ -83,21 +233,73 @@ static void audio_callback( SAMPLE * buffer, unsigned int numFrames, void * user
         return;
     }
 
-    g_synth->synthesize2( buffer, numFrames );
-    Globals::now += numFrames;
-    g_timeSinceLastPlayedInSamples += numFrames;
+    // control changes
+    apply_params( numFrames );
 
-    // hack to make it seem smoother
-    if( g_timeSinceLastPlayedInSamples >= g_periodInSamples-4096 ){
-            Globals::playheads[Globals::beats%16]->showThenFade();
+    // render up to each beat boundary, so beats land on the same sample
+    // whatever the buffer size (it can change under us; see XAudioIO::adapt())
+    unsigned int done = 0;
+    while( done < numFrames )
+    {
+        // progress the beat!
+        if( g_timeSinceLastPlayedInSamples >= g_periodInSamples ){
+            // play!
+            play(Globals::beats%16);
+            // book keep!
+            g_timeSinceLastPlayedInSamples -= g_periodInSamples;
+            Globals::beats++;
+        }
+
+        // frames until the next beat
+        unsigned int n = numFrames - done;
+        unsigned long untilBeat = (unsigned long)ceil( g_periodInSamples - g_timeSinceLastPlayedInSamples );
+        if( untilBeat < n ) n = untilBeat;
+
+        g_graph->run( buffer + done*XAudioIO::numChannels(), n );
+        Globals::now += n;
+        g_timeSinceLastPlayedInSamples += n;
+        done += n;
     }
-    // progress the beat!
-    if( g_timeSinceLastPlayedInSamples >= g_periodInSamples ){
-        // play!
-        play(Globals::beats%16);
-        // book keep!
-        g_timeSinceLastPlayedInSamples -= g_periodInSamples;
-        Globals::beats++;
+
+    // master volume, ramped across the buffer
+    float gain, inc;
+    XParams::ramp( g_pVolume, gain, inc );
+    if( gain != 1 || inc != 0 )
+    {
+        unsigned int channels = XAudioIO::numChannels();
+        for( unsigned int i = 0; i < numFrames; i++, gain += inc )
+            for( unsigned int j = 0; j < channels; j++ )
+                buffer[i*channels+j] *= gain;
+    }
+
+    // to the history: a column every g_historySpan frames
+    unsigned int channels = XAudioIO::numChannels();
+    for( unsigned int i = 0; i < numFrames; i++ )
+    {
+        float x = 0;
+        for( unsigned int j = 0; j < channels; j++ )
+            x += buffer[i*channels+j];
+        x /= channels;
+        if( x < g_historyMin ) g_historyMin = x;
+        if( x > g_historyMax ) g_historyMax = x;
+        if( ++g_historyCount >= g_historySpan )
+        {
+            float column[2] = { g_historyMin, g_historyMax };
+            g_history.put( column, 2 );
+            // empty (the next sample sets both)
+            g_historyCount = 0;
+            g_historyMin = HUGE_VALF;
+            g_historyMax = -HUGE_VALF;
+        }
+    }
+
+    // to the analysers (copies)
+    g_spectrum->push( buffer, numFrames );
+    if( g_inputSpectrum && input ) g_inputSpectrum->push( input, numFrames );
+
+    // hack to make it seem smoother (no playheads when headless)
+    if( g_timeSinceLastPlayedInSamples >= g_periodInSamples-4096 && Globals::playheads.size() ){
+            Globals::playheads[Globals::beats%16]->showThenFade();
     }
 
 }
@@ -119,12 +321,101 @@ bool ss_audio_init( unsigned int srate, unsigned int frameSize, unsigned channel
     }
 
     g_soloBuf = new SAMPLE[frameSize*channels];
+
+    // control parameters (before the audio starts)
+    g_pBPM = XParams::add( "bpm", g_BPM, SS_BPM_MIN, SS_BPM_MAX );
+    g_pVolume = XParams::add( "volume", 1, 0, 2, XPARAM_LINEAR, SS_VOLUME_RAMP );
+    g_pEchoFeedback = XParams::add( "echo.feedback", 0.4f, 0, 0.95f );
+    g_pEchoMix = XParams::add( "echo.mix", 1, 0, 1 );
+    for( int i = 0; i < 16; i++ )
+    {
+        char name[32];
+        snprintf( name, sizeof(name), "velocity.%d", i );
+        g_pVelocity[i] = XParams::add( name, g_velocity[i], 0, 1 );
+    }
+    add_eq( "drums", g_pDrumsEQ );
+    add_eq( "keys", g_pKeysEQ );
     
-    // instantiate a YFluidsynth
+    // instantiate a YFluidsynth per track (so they can render in parallel)
     g_synth = new YFluidSynth();
     g_synth->init( srate, 32 );
     g_synth->load( "data/sfonts/rocking8m11e.sf2", "" );
     g_synth->programChange( 0, 0 );
+    g_drums = new YFluidSynth();
+    g_drums->init( srate, 32 );
+    g_drums->load( "data/sfonts/rocking8m11e.sf2", "" );
+
+    // workers: one per spare core, up to one per track (none: serial)
+    if( g_numWorkers < 0 ) g_numWorkers = XWorkerPool::suggest( SS_NUM_TRACKS - 1 );
+    g_workers = new XWorkerPool();
+    if( g_numWorkers > 0 )
+        g_workers->start( g_numWorkers, XAudioIO::realtimePriority() );
+    cerr << "[ss]: track workers: " << g_workers->size()
+         << ( g_workers->size() ? "" : " (serial)" ) << endl;
+
+    // the master chain (echo is a send/return: fully wet, mixed back in)
+    g_echo = new YEcho( srate, 2.0, 0.375, 0.4, 1.0 );
+    g_graph = new YGraph( SS_MAX_FRAMESIZE );
+    g_graph->setPool( g_workers );
+    // a track is its synth into its EQ (g_*Node: the EQ, where sends come from)
+    g_drumsEQ = new YTrackEQ( srate );
+    g_keysEQ = new YTrackEQ( srate );
+    int drums = g_graph->addNode( "drums", new YDSPAdapter<YFluidSynth>( g_drums, true ) );
+    int keys = g_graph->addNode( "keys", new YDSPAdapter<YFluidSynth>( g_synth, true ) );
+    g_drumsNode = g_graph->addNode( "drums.eq", new YDSPAdapter<YTrackEQ>( g_drumsEQ ) );
+    g_keysNode = g_graph->addNode( "keys.eq", new YDSPAdapter<YTrackEQ>( g_keysEQ ) );
+    g_graph->connect( drums, g_drumsNode );
+    g_graph->connect( keys, g_keysNode );
+    g_echoNode = g_graph->addNode( "echo", new YDSPAdapter<YEcho>( g_echo ) );
+    int master = g_graph->addNode( "master" );
+    g_graph->connect( g_drumsNode, master );
+    g_graph->connect( g_keysNode, master );
+    g_graph->connect( g_echoNode, master );
+    g_graph->setMaster( master );
+
+    // ping-pong, synced: dotted eighth left, dotted quarter right (one line)
+    g_pingpong = new YTapDelay( srate, 2.0, SS_PINGPONG_FEEDBACK, 1.0 );
+    g_pingpong->addTap( g_period * 0.75f, 1, 0 );
+    g_pingpong->setFeedbackTap( g_pingpong->addTap( g_period * 1.5f, 0, 1 ) );
+    g_pingpongNode = g_graph->addNode( "pingpong", new YDSPAdapter<YTapDelay>( g_pingpong ) );
+    g_graph->connect( g_pingpongNode, master );
+
+    // convolution reverb (partitions the size of the device buffer)
+    if( g_reverbPath.size() )
+    {
+        g_reverb = new YConvolver( XAudioIO::framesize() );
+        if( g_reverb->load( g_reverbPath, srate ) )
+        {
+            int reverb = g_graph->addNode( "reverb", new YDSPAdapter<YConvolver>( g_reverb ) );
+            g_graph->connect( g_drumsNode, reverb, SS_REVERB_SEND );
+            g_graph->connect( g_keysNode, reverb, SS_REVERB_SEND );
+            g_graph->connect( reverb, master );
+            cerr << "[ss]: reverb: " << g_reverb->partitions() << " partitions of "
+                 << XAudioIO::framesize() << " frames" << endl;
+        }
+    }
+    // compile
+    if( !g_graph->commit() )
+        return false;
+
+    // master bus analyser
+    g_spectrum = new YSpectrum( srate, YSPECTRUM_SIZE, YSPECTRUM_HOP,
+                                YSPECTRUM_HANNING, channels );
+    // master bus history
+    g_historySpan = (unsigned long)( (double)SS_HISTORY_SECONDS * srate / SS_HISTORY_COLUMNS + .5 );
+    if( g_historySpan < 1 ) g_historySpan = 1;
+    g_historyCount = 0;
+    g_historyMin = HUGE_VALF;
+    g_historyMax = -HUGE_VALF;
+    // input onsets / tempo (see ss_audio_follow())
+    if( XAudioIO::numInputChannels() )
+    {
+        g_inputSpectrum = new YSpectrum( srate, SS_ONSET_SIZE, SS_ONSET_HOP,
+                                         YSPECTRUM_HANNING, XAudioIO::numInputChannels() );
+        g_onsets = new YOnsetDetector( g_inputSpectrum->numBins(), g_inputSpectrum->hopTime() );
+        g_tempo = new YTempoEstimator();
+        g_inputSpectrum->setCallback( follow_frame );
+    }
 
     // fill vecs with empty stuff
     for (int i = 0; i < 16; ++i)
@@ -163,6 +454,8 @@ bool ss_audio_init( unsigned int srate, unsigned int frameSize, unsigned channel
 
 // printState
 void updatePlayPlaces(){
+    // no graphics (headless)
+    if( Globals::playPlaces.size() < 16 ) return;
     for(int beat = 0; beat < 16; beat++){
         Globals::playPlaces[beat]->k = false;
         Globals::playPlaces[beat]->s = false;
@@ -219,6 +512,353 @@ bool ss_audio_start()
         // done
         return false;
     }
+    // and the analysers
+    if( !g_spectrum->start() )
+        cerr << "[ss]: cannot start spectrum analyser..." << endl;
+    if( g_inputSpectrum && !g_inputSpectrum->start() )
+        cerr << "[ss]: cannot start input analyser..." << endl;
     
     return true;
 }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_poll()
+// desc: audio thread follow-up work, from the main thread (e.g., printing)
+//-----------------------------------------------------------------------------
+void ss_audio_poll()
+{
+    int beats[64];
+    long n = g_beatLog.get( g_beatLogCursor, beats, 64 );
+    for( long i = 0; i < n; i++ )
+        printState( beats[i] );
+
+    // free graph programs the audio thread has let go of
+    g_graph->collect();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_echo()
+// desc: toggle the echo send (recompiles the master chain)
+//-----------------------------------------------------------------------------
+bool ss_audio_echo()
+{
+    g_echoSend = !g_echoSend;
+    if( g_echoSend ) g_graph->connect( g_keysNode, g_echoNode, SS_ECHO_SEND );
+    else g_graph->disconnect( g_keysNode, g_echoNode );
+    // hand it over
+    g_graph->commit();
+
+    return g_echoSend;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_pingpong()
+// desc: toggle the ping-pong send (recompiles the master chain)
+//-----------------------------------------------------------------------------
+bool ss_audio_pingpong()
+{
+    g_pingpongSend = !g_pingpongSend;
+    if( g_pingpongSend ) g_graph->connect( g_keysNode, g_pingpongNode, SS_PINGPONG_SEND );
+    else g_graph->disconnect( g_keysNode, g_pingpongNode );
+    // hand it over
+    g_graph->commit();
+
+    return g_pingpongSend;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_spectrum()
+// desc: the master bus analyser
+//-----------------------------------------------------------------------------
+YSpectrum * ss_audio_spectrum()
+{
+    return g_spectrum;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_history()
+// desc: master bus history: (min, max) pairs, one per column
+//-----------------------------------------------------------------------------
+XRingBuffer<float> * ss_audio_history()
+{
+    return &g_history;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_follow()
+// desc: toggle following the input's tempo; returns whether it's on
+//-----------------------------------------------------------------------------
+bool ss_audio_follow()
+{
+    if( g_inputSpectrum == NULL )
+    {
+        cerr << "[ss]: no audio input to follow..." << endl;
+        return false;
+    }
+
+    // (the estimator belongs to the analysis thread; it keeps listening
+    // either way, so following can start right away)
+    bool on = !g_follow.load();
+    g_follow = on;
+
+    return on;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_nudge()
+// desc: move a control parameter by delta; returns its new target
+//-----------------------------------------------------------------------------
+float ss_audio_nudge( const char * name, float delta )
+{
+    int id = XParams::find( name );
+    if( id < 0 ) return 0;
+    XParams::set( id, XParams::target( id ) + delta );
+
+    return XParams::target( id );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_beat()
+// desc: the next beat the listener will hear; Globals::beats runs ahead of
+//       the speaker by the output latency, which changes with the buffer size
+//-----------------------------------------------------------------------------
+unsigned long ss_audio_beat()
+{
+    // rendered but not yet heard
+    double behind = XAudioIO::latency();
+    double since = g_timeSinceLastPlayedInSamples;
+    unsigned long beat = Globals::beats;
+
+    // walk back over beats still in the pipe
+    while( behind > since && beat > 0 )
+    {
+        beat--;
+        since += g_periodInSamples;
+    }
+
+    return beat;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// recorder: drains the capture ring to a (float) .wav on its own thread
+//-----------------------------------------------------------------------------
+static XThread * g_recThread = NULL;
+static std::atomic<bool> g_recording( false );
+static FILE * g_recFile = NULL;
+static unsigned long g_recFrames = 0;
+
+// little-endian writers
+static void put32( FILE * f, unsigned int v )
+{ unsigned char b[4] = { (unsigned char)v, (unsigned char)(v>>8), (unsigned char)(v>>16), (unsigned char)(v>>24) }; fwrite( b, 1, 4, f ); }
+static void put16( FILE * f, unsigned short v )
+{ unsigned char b[2] = { (unsigned char)v, (unsigned char)(v>>8) }; fwrite( b, 1, 2, f ); }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: write_wav_header()
+// desc: 32-bit float wav header (sizes patched on close)
+//-----------------------------------------------------------------------------
+static void write_wav_header( FILE * f, unsigned int channels, unsigned int srate,
+                              unsigned long frames )
+{
+    unsigned int bytes = frames * channels * sizeof(float);
+    fwrite( "RIFF", 1, 4, f ); put32( f, 36 + bytes );
+    fwrite( "WAVE", 1, 4, f );
+    fwrite( "fmt ", 1, 4, f ); put32( f, 16 );
+    put16( f, 3 ); // IEEE float
+    put16( f, channels );
+    put32( f, srate );
+    put32( f, srate * channels * sizeof(float) );
+    put16( f, channels * sizeof(float) );
+    put16( f, 32 );
+    fwrite( "data", 1, 4, f ); put32( f, bytes );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rec_thread()
+// desc: recorder thread: copy out of the capture ring every 10ms
+//-----------------------------------------------------------------------------
+static THREAD_RETURN THREAD_TYPE rec_thread( void * data )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+    // ss_record_stop() asks us to leave; never get cancelled mid-write
+    pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL );
+#endif
+
+    XRingBuffer<SAMPLE> * ring = XAudioIO::capture();
+    unsigned int channels = XAudioIO::numInputChannels();
+    // start from now
+    unsigned long long cursor = ring->written();
+    SAMPLE buffer[4096];
+    // one more pass after the flag drops, to get the tail
+    bool more = true;
+
+    while( more )
+    {
+        more = g_recording.load();
+        long n;
+        while( ( n = ring->get( cursor, buffer, 4096 - 4096 % channels ) ) > 0 )
+        {
+            fwrite( buffer, sizeof(SAMPLE), n, g_recFile );
+            g_recFrames += n / channels;
+        }
+        if( more ) usleep( 10000 );
+    }
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_record_start()
+// desc: start recording device input to a .wav file
+//-----------------------------------------------------------------------------
+bool ss_record_start( const char * path )
+{
+    // check
+    if( g_recording.load() ) return true;
+    if( XAudioIO::capture() == NULL )
+    {
+        cerr << "[ss]: no audio input to record..." << endl;
+        return false;
+    }
+
+    // open
+    g_recFile = fopen( path, "wb" );
+    if( g_recFile == NULL )
+    {
+        cerr << "[ss]: cannot open '" << path << "' for recording..." << endl;
+        return false;
+    }
+    g_recFrames = 0;
+    write_wav_header( g_recFile, XAudioIO::numInputChannels(), XAudioIO::srate(), 0 );
+
+    // go
+    if( g_recThread == NULL ) g_recThread = new XThread();
+    g_recording = true;
+    if( !g_recThread->start( rec_thread ) )
+    {
+        cerr << "[ss]: cannot start recorder thread..." << endl;
+        g_recording = false;
+        fclose( g_recFile );
+        g_recFile = NULL;
+        return false;
+    }
+
+    cerr << "[ss]: recording input to '" << path << "'..." << endl;
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_record_stop()
+// desc: stop recording, and finish the file
+//-----------------------------------------------------------------------------
+void ss_record_stop()
+{
+    // check
+    if( !g_recording.exchange( false ) ) return;
+
+    // wait for the last of it
+    g_recThread->wait();
+    g_recThread->clear();
+
+    // patch sizes
+    fseek( g_recFile, 0, SEEK_SET );
+    write_wav_header( g_recFile, XAudioIO::numInputChannels(), XAudioIO::srate(), g_recFrames );
+    fclose( g_recFile );
+    g_recFile = NULL;
+
+    cerr << "[ss]: recorded " << (double)g_recFrames / XAudioIO::srate() << "s of input" << endl;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_recording()
+// desc: are we recording?
+//-----------------------------------------------------------------------------
+bool ss_recording()
+{
+    return g_recording.load();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_stop()
+// desc: stop audio system
+//-----------------------------------------------------------------------------
+void ss_audio_stop()
+{
+    // finish any recording
+    ss_record_stop();
+    // stop the audio
+    XAudioIO::stop();
+    // then its helpers
+    if( g_workers ) g_workers->stop();
+    if( g_spectrum ) g_spectrum->stop();
+    if( g_inputSpectrum ) g_inputSpectrum->stop();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_workers()
+// desc: set number of track workers (before ss_audio_init; -1 == auto)
+//-----------------------------------------------------------------------------
+void ss_audio_workers( int num )
+{
+    g_numWorkers = num;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ss_audio_reverb()
+// desc: set reverb impulse response (.wav; before ss_audio_init)
+//-----------------------------------------------------------------------------
+void ss_audio_reverb( const char * path )
+{
+    g_reverbPath = path;
+}
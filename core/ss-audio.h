@@ -8,13 +8,44 @@
 #ifndef __SS_AUDIO_H__
 #define __SS_AUDIO_H__
 
+// forward reference
+class YSpectrum;
+template <typename T> class XRingBuffer;
 
 
 
+
+// set number of track workers (before init; -1 == one per spare core)
+void ss_audio_workers( int num );
+// set reverb impulse response (.wav; before init)
+void ss_audio_reverb( const char * path );
 // init audio
 bool ss_audio_init( unsigned int srate, unsigned int frameSize, unsigned channels );
 // start audio
 bool ss_audio_start();
+// stop audio
+void ss_audio_stop();
+// audio thread follow-up work (call from the main thread)
+void ss_audio_poll();
+// next beat to be heard (latency compensated)
+unsigned long ss_audio_beat();
+// the master bus analyser (NULL before init)
+YSpectrum * ss_audio_spectrum();
+// the master bus history: (min, max) of the mono mix per column, the last
+// SS_HISTORY_SECONDS over SS_HISTORY_COLUMNS (one writer: the audio thread)
+XRingBuffer<float> * ss_audio_history();
+// toggle the echo send; returns whether it's on
+bool ss_audio_echo();
+// toggle the ping-pong send; returns whether it's on
+bool ss_audio_pingpong();
+// move a control parameter (see XParams) by delta; returns its new value
+float ss_audio_nudge( const char * name, float delta );
+// toggle following the tempo heard on the input; returns whether it's on
+bool ss_audio_follow();
+// record device input to a .wav file
+bool ss_record_start( const char * path );
+void ss_record_stop();
+bool ss_recording();
 
 // play some notes
 void play( float pitch, float velocity );
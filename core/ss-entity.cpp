@@ -8,6 +8,9 @@
 #include "ss-entity.h"
 #include "ss-globals.h"
 #include "x-fun.h"
+#include "x-audio.h"
+#include "ss-audio.h"
+#include "y-spectrum.h"
 #include <cmath> 
 using namespace std;
 
@@ -144,8 +147,8 @@ void SSSpark::setTexture( int _texture )
 //-------------------------------------------------------------------------------
 void SSSpark::update( YTimeInterval dt )
 {
-    // slew
-    ALPHA.interp( dt );
+    // slew (until there)
+    ALPHA.approach( dt );
     // set
     this->alpha = ALPHA.value;
 }
@@ -261,9 +264,9 @@ void SSCube::render()
 //-----------------------------------------------------------------------------
 void SSCube::update( YTimeInterval dt )
 {
-    // interp
-    size.interp( dt );
-    ialpha.interp( dt );
+    // interp (until there)
+    size.approach( dt );
+    ialpha.approach( dt );
     // set it
     alpha = ialpha.value;
 }
@@ -450,5 +453,359 @@ void SSPlayPlace::render( ){
 
 
 
+// refresh rate for the meter (seconds)
+#define SS_METER_REFRESH (.25)
+// seconds of load history
+#define SS_METER_HISTORY (10.0)
+
+//-----------------------------------------------------------------------------
+// name: SSAudioMeter()
+// desc: constructor
+//-----------------------------------------------------------------------------
+SSAudioMeter::SSAudioMeter( const Vector3D & _loc )
+    : m_time( 0 ), m_since( 0 )
+{
+    loc = _loc;
+
+    // histogram: one bin per tenth of the period, last bin == late
+    m_histogram = new YHistogram();
+    m_histogram->init( 4, 1.5, XAUDIO_STATS_BUCKETS );
+    m_histogram->setMaxValue( 100 );
+    for( int i = 0; i < XAUDIO_STATS_BUCKETS; i++ )
+    {
+        char buf[8];
+        // label
+        if( i == XAUDIO_STATS_BUCKETS - 1 ) snprintf( buf, sizeof(buf), "!!" );
+        else snprintf( buf, sizeof(buf), "%d", (i+1)*10 );
+        m_histogram->bin(i)->setName( buf );
+        // color: green to red
+        m_histogram->bin(i)->setColor( i == XAUDIO_STATS_BUCKETS - 1 ?
+            Vector3D( 1, .1, .1 ) : Vector3D( .1 + .08*i, .8 - .06*i, .2 ) );
+    }
+    this->addChild( m_histogram );
+
+    // load history (percent of period)
+    m_load = new YLineChart();
+    m_load->init( 4, 1 );
+    m_load->viewX( -SS_METER_HISTORY, 0 );
+    m_load->viewY( 0, 100 );
+    m_load->loc.set( 0, -1.5, 0 );
+    m_load->col.set( .4, .8, 1 );
+    this->addChild( m_load );
+
+    // text
+    m_xruns = new YText(1);
+    m_xruns->setWidth( 3.0 );
+    m_xruns->sca.set( 5, 5, 5 );
+    m_xruns->loc.set( 0, -2, 0 );
+    this->addChild( m_xruns );
+    m_worst = new YText(1);
+    m_worst->setWidth( 3.0 );
+    m_worst->sca.set( 5, 5, 5 );
+    m_worst->loc.set( 0, -2.4, 0 );
+    this->addChild( m_worst );
+    m_margin = new YText(1);
+    m_margin->setWidth( 3.0 );
+    m_margin->sca.set( 5, 5, 5 );
+    m_margin->loc.set( 0, -2.8, 0 );
+    this->addChild( m_margin );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: poll the audio telemetry (at SS_METER_REFRESH, not every frame)
+//-----------------------------------------------------------------------------
+void SSAudioMeter::update( YTimeInterval dt )
+{
+    // time
+    m_time += dt;
+    m_since += dt;
+    // not yet
+    if( m_since < SS_METER_REFRESH ) return;
+    m_since = 0;
+
+    // snapshot
+    XAudioStats stats;
+    XAudioIO::stats( stats );
+    // nothing yet
+    if( stats.callbacks == 0 || stats.period <= 0 ) return;
+
+    // histogram as percent of callbacks
+    for( int i = 0; i < XAUDIO_STATS_BUCKETS; i++ )
+        m_histogram->bin(i)->setValue( 100.0 * stats.buckets[i] / stats.callbacks );
+
+    // load history: scroll so that now is at 0
+    m_load->addValue( m_time, 100.0 * stats.lastDuration / stats.period );
+    m_load->trim( m_time - SS_METER_HISTORY - 1 );
+    m_load->viewX( m_time - SS_METER_HISTORY, m_time );
+
+    // text
+    char buf[64];
+    snprintf( buf, sizeof(buf), "xruns: %lu (%lu under, %lu over)",
+              stats.xruns, stats.underflows, stats.overflows );
+    m_xruns->set( buf );
+    snprintf( buf, sizeof(buf), "worst: %.2f ms / %.2f ms",
+              stats.worstDuration * 1000, stats.period * 1000 );
+    m_worst->set( buf );
+    snprintf( buf, sizeof(buf), "margin: %.2f ms", stats.worstMargin * 1000 );
+    m_margin->set( buf );
+    // red when the worst case ate the whole period
+    m_margin->col = stats.worstMargin <= 0 ? Vector3D( 1, .2, .2 ) : Vector3D( 1, 1, 1 );
+}
 
 
+
+
+//-----------------------------------------------------------------------------
+// name: render()
+// desc: children do the drawing
+//-----------------------------------------------------------------------------
+void SSAudioMeter::render()
+{
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: resetWorst()
+// desc: reset worst case
+//-----------------------------------------------------------------------------
+void SSAudioMeter::resetWorst()
+{
+    XAudioIO::resetWorst();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: SSInputMonitor()
+// desc: constructor
+//-----------------------------------------------------------------------------
+SSInputMonitor::SSInputMonitor( const Vector3D & _loc, unsigned int numFrames )
+    : m_numFrames( numFrames ), m_peak( 0 )
+{
+    loc = _loc;
+
+    // scratch (allocated once)
+    unsigned int channels = XAudioIO::numInputChannels();
+    m_interleaved.resize( numFrames * (channels ? channels : 1) );
+    m_mono.resize( numFrames );
+
+    // waveform
+    m_waveform = new YWaveform();
+    m_waveform->init( numFrames );
+    m_waveform->setWidth( 4 );
+    m_waveform->setHeight( 1 );
+    m_waveform->col.set( .5, 1, .5 );
+    this->addChild( m_waveform );
+
+    // level
+    m_level = new YText(1);
+    m_level->setWidth( 3.0 );
+    m_level->sca.set( 5, 5, 5 );
+    m_level->loc.set( -2, -.8, 0 );
+    m_level->set( "input: none" );
+    this->addChild( m_level );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: pull the most recent input (never touches the audio thread)
+//-----------------------------------------------------------------------------
+void SSInputMonitor::update( YTimeInterval dt )
+{
+    XRingBuffer<SAMPLE> * ring = XAudioIO::capture();
+    unsigned int channels = XAudioIO::numInputChannels();
+    // no input
+    if( ring == NULL || channels == 0 ) return;
+
+    // latest frames, oldest first
+    long n = ring->peek( &m_interleaved[0], m_interleaved.size() ) / channels;
+    if( n == 0 ) return;
+
+    // mix down, and measure
+    GLfloat sum = 0, peak = 0;
+    for( long i = 0; i < n; i++ )
+    {
+        SAMPLE v = 0;
+        for( unsigned int c = 0; c < channels; c++ )
+            v += m_interleaved[i*channels + c];
+        v /= channels;
+        m_mono[i] = v;
+        sum += v * v;
+        if( fabs( v ) > peak ) peak = fabs( v );
+    }
+    // zero the rest (e.g., just started)
+    for( long i = n; i < m_numFrames; i++ )
+        m_mono[i] = 0;
+    m_waveform->set( &m_mono[0], m_numFrames );
+
+    // peak hold, falling at 20 dB/s
+    m_peak *= pow( 10, -dt );
+    if( peak > m_peak ) m_peak = peak;
+
+    // text
+    char buf[64];
+    GLfloat rms = sqrt( sum / n );
+    snprintf( buf, sizeof(buf), "input: %.1f dB rms | %.1f dB peak",
+              20 * log10( rms + 1e-9 ), 20 * log10( m_peak + 1e-9 ) );
+    m_level->set( buf );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render()
+// desc: children do the drawing
+//-----------------------------------------------------------------------------
+void SSInputMonitor::render()
+{
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: SSSpectrum()
+// desc: constructor
+//-----------------------------------------------------------------------------
+SSSpectrum::SSSpectrum( const Vector3D & _loc, unsigned int numBins )
+{
+    loc = _loc;
+
+    // bars
+    m_histogram = new YHistogram();
+    m_histogram->init( 6, 2, numBins );
+    m_histogram->setMaxValue( 1 );
+    m_histogram->loc.set( -3, -1, 0 );
+    this->addChild( m_histogram );
+
+    // title
+    YText * title = new YText( 1 );
+    title->set( "Spectrum" );
+    title->loc.set( 0, 1.5, 0 );
+    title->setWidth( 3.0 );
+    title->sca.set( 10, 10, 10 );
+    this->addChild( title );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: pick up the analyser's newest frame, if there is one
+//-----------------------------------------------------------------------------
+void SSSpectrum::update( YTimeInterval dt )
+{
+    YSpectrum * spectrum = ss_audio_spectrum();
+    // no analyser (yet), or nothing new
+    if( spectrum == NULL || !spectrum->fresh() ) return;
+
+    long bars = m_histogram->numBins();
+    // bar edges: log-spaced, at least one fft bin each
+    if( m_edges.size() != bars + 1 )
+    {
+        m_edges.resize( bars + 1 );
+        unsigned int last = 0;
+        for( long i = 0; i <= bars; i++ )
+        {
+            GLfloat f = SS_SPECTRUM_LO * pow( (GLfloat)SS_SPECTRUM_HI / SS_SPECTRUM_LO, (GLfloat)i / bars );
+            unsigned int k = (unsigned int)( f / spectrum->frequency( 1 ) + .5f );
+            if( i > 0 && k <= last ) k = last + 1;
+            if( k > spectrum->numBins() ) k = spectrum->numBins();
+            m_edges[i] = last = k;
+        }
+    }
+
+    const float * mag = spectrum->magnitudes();
+    for( long i = 0; i < bars; i++ )
+    {
+        // loudest bin in the bar
+        float peak = 0;
+        for( unsigned int k = m_edges[i]; k < m_edges[i+1]; k++ )
+            if( mag[k] > peak ) peak = mag[k];
+        // dB, floor to 0 dBFS as 0 to 1
+        GLfloat db = 20 * log10( peak + 1e-9 );
+        GLfloat v = ( db - SS_SPECTRUM_FLOOR ) / -SS_SPECTRUM_FLOOR;
+        m_histogram->bin( i )->setValue( v < 0 ? 0 : v > 1 ? 1 : v );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render()
+// desc: children do the drawing
+//-----------------------------------------------------------------------------
+void SSSpectrum::render()
+{
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: SSHistory()
+// desc: constructor
+//-----------------------------------------------------------------------------
+SSHistory::SSHistory( const Vector3D & _loc )
+{
+    loc = _loc;
+    m_cursor = 0;
+    m_pairs.resize( 2 * SS_HISTORY_COLUMNS );
+
+    // waveform
+    m_waveform = new YWaveformHistory();
+    m_waveform->init( SS_HISTORY_COLUMNS, SS_HISTORY_ROWS );
+    m_waveform->setWidth( 6 );
+    m_waveform->setHeight( 2 );
+    m_waveform->col.set( .5f, 1, .5f );
+    this->addChild( m_waveform );
+
+    // title
+    YText * title = new YText( 1 );
+    title->set( "History" );
+    title->loc.set( 0, 1.5, 0 );
+    title->setWidth( 3.0 );
+    title->sca.set( 10, 10, 10 );
+    this->addChild( title );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: new columns from the audio thread (the ring holds a whole
+//       history, so after being hidden we catch up on all of it)
+//-----------------------------------------------------------------------------
+void SSHistory::update( YTimeInterval dt )
+{
+    XRingBuffer<float> * history = ss_audio_history();
+    long n;
+    while( ( n = history->get( m_cursor, &m_pairs[0], (long)m_pairs.size() ) ) > 0 )
+        for( long i = 0; i + 1 < n; i += 2 )
+            m_waveform->column( m_pairs[i], m_pairs[i+1] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render()
+// desc: children do the drawing
+//-----------------------------------------------------------------------------
+void SSHistory::render()
+{
+}
@@ -10,6 +10,8 @@
 using namespace std;
 
 #include "y-entity.h"
+#include "y-charting.h"
+#include "y-waveform.h"
 #include "x-buffer.h"
 #include <vector>
 
@@ -37,6 +39,8 @@ public:
     void update( YTimeInterval dt );
     // render
     void render();
+    // nothing to ramp
+    bool settled() const { return ALPHA.settled() && alpha == ALPHA.value; }
     
 public:
     // which ripple texture
@@ -89,6 +93,9 @@ public:
 public:
     virtual void update( YTimeInterval dt );
     virtual void render();
+    // faded / sized (idle cubes cost no update)
+    virtual bool settled() const
+    { return size.settled() && ialpha.settled() && alpha == ialpha.value; }
 
 public:
     Vector3D size;
@@ -173,6 +180,123 @@ public:
 
 
 
+//-----------------------------------------------------------------------------
+// name: class SSAudioMeter
+// desc: audio thread telemetry: callback duration histogram, load history,
+//       xrun count and worst-case margin (reads XAudioIO::stats())
+//-----------------------------------------------------------------------------
+class SSAudioMeter : public YEntity
+{
+public:
+    SSAudioMeter( const Vector3D & _loc );
+
+public:
+    virtual void update( YTimeInterval dt );
+    virtual void render();
+
+public:
+    // reset worst case (histogram and counters keep going)
+    void resetWorst();
+
+protected:
+    // duration histogram, in tenths of the period
+    YHistogram * m_histogram;
+    // load over time
+    YLineChart * m_load;
+    // text readouts
+    YText * m_xruns;
+    YText * m_worst;
+    YText * m_margin;
+    // elapsed time
+    YTimeInterval m_time;
+    // time since last refresh
+    YTimeInterval m_since;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class SSInputMonitor
+// desc: live device input: waveform and level, read from the capture ring
+//       (see XAudioIO::capture())
+//-----------------------------------------------------------------------------
+class SSInputMonitor : public YEntity
+{
+public:
+    SSInputMonitor( const Vector3D & _loc, unsigned int numFrames = 512 );
+
+public:
+    virtual void update( YTimeInterval dt );
+    virtual void render();
+
+protected:
+    // the waveform
+    YWaveform * m_waveform;
+    // level readout
+    YText * m_level;
+    // frames shown
+    unsigned int m_numFrames;
+    // interleaved scratch, and the mono mix of it
+    vector<SAMPLE> m_interleaved;
+    vector<SAMPLE> m_mono;
+    // peak hold (linear)
+    GLfloat m_peak;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class SSSpectrum
+// desc: master bus spectrum: the analyser's latest frame (see YSpectrum),
+//       grouped into log-spaced histogram bins, in dB
+//-----------------------------------------------------------------------------
+class SSSpectrum : public YEntity
+{
+public:
+    SSSpectrum( const Vector3D & _loc, unsigned int numBins );
+
+public:
+    virtual void update( YTimeInterval dt );
+    virtual void render();
+
+protected:
+    // the bars
+    YHistogram * m_histogram;
+    // first fft bin of each bar (+ one past the last), once known
+    vector<unsigned int> m_edges;
+};
+
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class SSHistory
+// desc: scrolling waveform of the master bus, the last SS_HISTORY_SECONDS
+//       (see ss_audio_history(), YWaveformHistory)
+//-----------------------------------------------------------------------------
+class SSHistory : public YEntity
+{
+public:
+    SSHistory( const Vector3D & _loc );
+
+public:
+    virtual void update( YTimeInterval dt );
+    virtual void render();
+
+protected:
+    // the waveform
+    YWaveformHistory * m_waveform;
+    // our read cursor into the history
+    unsigned long long m_cursor;
+    // scratch (min, max pairs)
+    vector<float> m_pairs;
+};
+
+
+
 #endif
 
 
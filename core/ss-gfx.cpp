@@ -14,6 +14,8 @@
 #include "x-gfx.h"
 #include "x-loadlum.h"
 #include "x-vector3d.h"
+#include "y-scene.h"
+#include "x-workers.h"
 
 #include <iostream>
 #include <vector>
@@ -22,8 +24,8 @@ using namespace std;
 
 // gfx globals
 // YEntities
-// Intro
-YEntity g_introRoot;
+// Intro (bokehs stored flat; see YFlatScene)
+YFlatScene g_introRoot;
 vector<YBokeh *> g_bokehs;
 YText * g_introText;
 
@@ -35,6 +37,18 @@ SSLineGrid * g_grid;
 
 // hud
 YEntity g_hud;
+// audio telemetry meter
+SSAudioMeter * g_meter;
+// live input
+SSInputMonitor * g_input;
+SSSpectrum * g_spectrumView;
+SSHistory * g_historyView;
+
+// scene update workers (see ss_gfx_workers(); 0 == serial). off by default:
+// the parallel update matches the serial one, but no speed-up has been
+// measured on a multi-core machine yet
+XWorkerPool * g_gfxWorkers = NULL;
+int g_numGfxWorkers = 0;
 
 // max sim step size in seconds
 #define SIM_SKIP_TIME (.25)
@@ -83,10 +97,10 @@ bool ss_gfx_init( int argc, const char ** argv )
 #else
     // store this globally
     Globals::path = cwd;
+#endif
 #endif
     // compute the datapath
     Globals::datapath = Globals::path + Globals::relpath;
-#endif
     
     // initialize GLUT
     glutInit( &argc, (char **)argv );
@@ -128,6 +142,16 @@ bool ss_gfx_init( int argc, const char ** argv )
     
     // do our own initialization
     initialize_graphics();
+    // scene update workers
+    if( g_numGfxWorkers < 0 ) g_numGfxWorkers = XWorkerPool::suggest( XWORKERS_MAX );
+    if( g_numGfxWorkers > 0 )
+    {
+        g_gfxWorkers = new XWorkerPool();
+        // not realtime, not pinned, not audio (no XRTGuard)
+        g_gfxWorkers->start( g_numGfxWorkers, 0, false, false );
+        YEntity::setUpdatePool( g_gfxWorkers );
+        cerr << "[ss]: scene update workers: " << g_gfxWorkers->size() << endl;
+    }
     // simulation
     initialize_simulation();
     // do data
@@ -149,6 +173,18 @@ bool ss_gfx_init( int argc, const char ** argv )
 
 
 
+//-----------------------------------------------------------------------------
+// name: ss_gfx_workers( )
+// desc: set number of scene update workers (before ss_gfx_init)
+//-----------------------------------------------------------------------------
+void ss_gfx_workers( int num )
+{
+    g_numGfxWorkers = num;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: ss_gfx_loop( )
 // desc: hand off to graphics loop
@@ -269,10 +305,11 @@ void initialize_simulation()
 
     // Intro
     // this part modded from  bokeh
+    g_introRoot.reserve<YBokeh>( 1024 );
     for( int i = 0; i < 1024; i++ )
     {
-        // create a spark
-        YBokeh * bokeh = new YBokeh();
+        // create a spark (in the scene's bokeh table, under the scene)
+        YBokeh * bokeh = g_introRoot.create<YBokeh>();
         // set attributes
         bokeh->set( 1.0f, 1.0f, 1.0f, 1.0f, SS_TEX_FLARE_TNG_1 );
         // set bokeh
@@ -288,8 +325,6 @@ void initialize_simulation()
                                Vector3D(XFun::rand2f(0,.1),XFun::rand2f(0,.2), XFun::rand2f(.3,.5)) );
         // alpha
         bokeh->setAlpha( .1 );
-        // add to simulation
-        g_introRoot.addChild( bokeh );
         g_bokehs.push_back( bokeh );
     }
 
@@ -298,6 +333,9 @@ void initialize_simulation()
     loveText->setCenterLocation(Vector3D(.5,0,0));
     g_introRoot.addChild( loveText );
     g_introText = loveText;
+    // the bokehs don't touch each other: update them in parallel (if there
+    // are workers)
+    g_introRoot.independent = true;
     Globals::sim.addChild( & g_introRoot );
 
 
@@ -388,6 +426,33 @@ void initialize_simulation()
 
     g_hud.addChild(inv);
 
+    // audio telemetry (toggle with 't')
+    g_meter = new SSAudioMeter(Vector3D(6,4,0));
+    YText * meterTitle = new YText(1);
+    meterTitle->set("Audio");
+    meterTitle->loc.set(0,2,0);
+    meterTitle->setWidth(3.0);
+    meterTitle->sca.x = 10.0f;
+    meterTitle->sca.y = 10.0f;
+    g_meter->addChild(meterTitle);
+    g_meter->active = false;
+    g_hud.addChild(g_meter);
+
+    // live input (toggle with 'i')
+    g_input = new SSInputMonitor(Vector3D(8,-4,0));
+    g_input->active = false;
+    g_hud.addChild(g_input);
+
+    // master spectrum (toggle with 'S')
+    g_spectrumView = new SSSpectrum(Vector3D(-6,-4,0), SS_SPECTRUM_BINS);
+    g_spectrumView->active = false;
+    g_hud.addChild(g_spectrumView);
+
+    // master history (toggle with 'W')
+    g_historyView = new SSHistory(Vector3D(-6,4,0));
+    g_historyView->active = false;
+    g_hud.addChild(g_historyView);
+
     g_hud.active = false;
     Globals::sim.addChild( & g_hud );
 
@@ -486,6 +551,18 @@ void ss_keys()
     fprintf( stderr, "  'd' - clear current beat\n" );
     fprintf( stderr, "  'D' - clear all beats\n" );
     fprintf( stderr, "  'zxcvbnm,.' - bottom row of keyboard for pitched sound\n" );
+    fprintf( stderr, "  't' - toggle audio meter\n" );
+    fprintf( stderr, "  'T' - reset audio meter worst case\n" );
+    fprintf( stderr, "  'i' - toggle input monitor\n" );
+    fprintf( stderr, "  'S' - toggle spectrum analyser\n" );
+    fprintf( stderr, "  'W' - toggle master waveform history\n" );
+    fprintf( stderr, "  'R' - start/stop recording input to %s\n", SS_RECORD_FILE );
+    fprintf( stderr, "  'e' - toggle echo send\n" );
+    fprintf( stderr, "  'p' - toggle ping-pong send\n" );
+    fprintf( stderr, "  '<' and '>' - slower/faster\n" );
+    fprintf( stderr, "  'F' - toggle following the input's tempo\n" );
+    fprintf( stderr, "  '{' and '}' - quieter/louder\n" );
+    fprintf( stderr, "  '(' and ')' - less/more echo feedback\n" );
     
 }
 
@@ -513,8 +590,27 @@ void ss_help()
 void ss_usage()
 {
     ss_line();
-    fprintf( stderr, "[ss]: no command line arguments\n" );
+    fprintf( stderr, "[ss]: usage: stepSequencer [options]\n" );
     ss_line();
+    fprintf( stderr, "  --audio=<api>     - audio backend (alsa, jack, oss, core, dummy,\n" );
+    fprintf( stderr, "                      null, null-fast)\n" );
+    fprintf( stderr, "  --period=<N>      - frames per buffer (default: %d)\n", SS_FRAMESIZE );
+    fprintf( stderr, "  --rt-guard=<mode> - catch heap use/page faults in the audio callback\n" );
+    fprintf( stderr, "                      (off, record, abort; implies --mlock)\n" );
+    fprintf( stderr, "  --mlock           - lock memory (no paging)\n" );
+    fprintf( stderr, "  --record=<file>   - record audio input to a .wav file\n" );
+    fprintf( stderr, "  --reverb=<file>   - convolution reverb with this impulse response (.wav)\n" );
+    fprintf( stderr, "  --adaptive=<N>    - grow the buffer up to N frames on xruns (default: %d; 0 == fixed)\n", SS_MAX_FRAMESIZE );
+    fprintf( stderr, "  --buffers=<N>     - number of device buffers (default: backend)\n" );
+    fprintf( stderr, "  --priority=<N>    - realtime priority, 0 to disable (default: %d)\n", SS_RT_PRIORITY );
+    fprintf( stderr, "  --workers=<N>     - threads helping render tracks, 0 for serial\n" );
+    fprintf( stderr, "                      (default: one per spare core)\n" );
+    fprintf( stderr, "  --gfx-workers=<N> - threads helping update large scenes, -1 for one\n" );
+    fprintf( stderr, "                      per spare core (default: 0, serial; experimental:\n" );
+    fprintf( stderr, "                      no speed-up measured yet)\n" );
+    fprintf( stderr, "  --set=<name>=<v>  - set a control parameter (e.g., --set=bpm=180)\n" );
+    fprintf( stderr, "  --headless=<sec>  - run the engine without graphics for <sec> seconds\n" );
+    fprintf( stderr, "                      (uses --audio=null unless another is given)\n" );
 
 }
 
@@ -575,7 +671,7 @@ void reshapeFunc( int w, int h )
 void look( )
 {
     // go
-    Globals::fov.interp( XGfx::delta() );
+    Globals::fov.approach( XGfx::delta() );
     // set the matrix mode to project
     glMatrixMode( GL_PROJECTION );
     // load the identity matrix
@@ -683,17 +779,17 @@ void keyboardFunc( unsigned char key, int x, int y )
                 }
                 break;
             case 'd': //delete
-                Globals::drumPitchVecs[Globals::beats%16].clear();
-                Globals::pitchVecs[Globals::beats%16].clear();
+                Globals::drumPitchVecs[ss_audio_beat()%16].clear();
+                Globals::pitchVecs[ss_audio_beat()%16].clear();
                 break;
             case 32: //spacebar
-                Globals::drumPitchVecs[Globals::beats%16].push_back(SS_KICK);
+                Globals::drumPitchVecs[ss_audio_beat()%16].push_back(SS_KICK);
                 break;
             case 'f':
-                Globals::drumPitchVecs[Globals::beats%16].push_back(SS_HIHAT);
+                Globals::drumPitchVecs[ss_audio_beat()%16].push_back(SS_HIHAT);
                 break;
             case 'j':
-                Globals::drumPitchVecs[Globals::beats%16].push_back(SS_SNARE);
+                Globals::drumPitchVecs[ss_audio_beat()%16].push_back(SS_SNARE);
                 break;
             case ']':
                 Globals::viewEyeY.y -= .1f;
@@ -716,37 +812,77 @@ void keyboardFunc( unsigned char key, int x, int y )
             case '+':
                 Globals::viewRadius.y = Globals::viewRadius.x + .7*(Globals::viewRadius.y-Globals::viewRadius.x);
                 break;
+            case 't': // audio meter
+                g_meter->active = !g_meter->active;
+                break;
+            case 'T': // reset worst case
+                g_meter->resetWorst();
+                break;
+            case 'i': // input monitor
+                g_input->active = !g_input->active;
+                break;
+            case 'S': // spectrum
+                g_spectrumView->active = !g_spectrumView->active;
+                break;
+            case 'W': // history
+                g_historyView->active = !g_historyView->active;
+                break;
+            case 'R': // record input
+                if( ss_recording() ) ss_record_stop();
+                else ss_record_start( SS_RECORD_FILE );
+                break;
+            case 'e': // echo send
+                fprintf( stderr, "[ss]: echo %s\n", ss_audio_echo() ? "on" : "off" );
+                break;
+            case 'p': // ping-pong send
+                fprintf( stderr, "[ss]: ping-pong %s\n", ss_audio_pingpong() ? "on" : "off" );
+                break;
+            case '<': // tempo
+            case '>':
+                fprintf( stderr, "[ss]: bpm: %.0f\n", ss_audio_nudge( "bpm", key == '<' ? -10 : 10 ) );
+                break;
+            case 'F': // tempo follow
+                fprintf( stderr, "[ss]: tempo follow %s\n", ss_audio_follow() ? "on" : "off" );
+                break;
+            case '{': // master volume
+            case '}':
+                fprintf( stderr, "[ss]: volume: %.2f\n", ss_audio_nudge( "volume", key == '{' ? -.1f : .1f ) );
+                break;
+            case '(': // echo feedback
+            case ')':
+                fprintf( stderr, "[ss]: echo feedback: %.2f\n", ss_audio_nudge( "echo.feedback", key == '(' ? -.05f : .05f ) );
+                break;
         }
 
         //
         switch( key )
         {
             case 'z':
-                Globals::pitchVecs[Globals::beats%16].push_back(55);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(55);
                 break;
             case 'x':
-                Globals::pitchVecs[Globals::beats%16].push_back(57);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(57);
                 break;
             case 'c':
-                Globals::pitchVecs[Globals::beats%16].push_back(59);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(59);
                 break;
             case 'v':
-                Globals::pitchVecs[Globals::beats%16].push_back(60);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(60);
                 break;
             case 'b':
-                Globals::pitchVecs[Globals::beats%16].push_back(62);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(62);
                 break;
             case 'n':
-                Globals::pitchVecs[Globals::beats%16].push_back(64);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(64);
                 break;
             case 'm':
-                Globals::pitchVecs[Globals::beats%16].push_back(65);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(65);
                 break;
             case ',':
-                Globals::pitchVecs[Globals::beats%16].push_back(67);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(67);
                 break;
             case '.':
-                Globals::pitchVecs[Globals::beats%16].push_back(69);
+                Globals::pitchVecs[ss_audio_beat()%16].push_back(69);
                 break;
         }
     }
@@ -813,6 +949,10 @@ void specialFunc( int key, int x, int y )
 //-----------------------------------------------------------------------------
 void idleFunc( )
 {
+    // grow/shrink the audio buffer on xruns
+    XAudioIO::adapt();
+    // print what the audio thread played
+    ss_audio_poll();
     // render the scene
     glutPostRedisplay( );
 }
@@ -826,9 +966,9 @@ void displayFunc( )
     // get current time (once per frame)
     XGfx::getCurrentTime( true );
 
-    // update
-    Globals::bgColor.interp( XGfx::delta() );
-    Globals::blendAlpha.interp( XGfx::delta() );
+    // update (settled slews are left alone)
+    Globals::bgColor.approach( XGfx::delta() );
+    Globals::blendAlpha.approach( XGfx::delta() );
     
     // clear or blend
     if( Globals::blendScreen && Globals::blendAlpha.value > .0001 )
@@ -853,8 +993,8 @@ void displayFunc( )
     glPushMatrix();
     
     // slew
-    Globals::viewEyeY.interp( XGfx::delta());
-    Globals::viewRadius.interp( XGfx::delta() );
+    Globals::viewEyeY.approach( XGfx::delta() );
+    Globals::viewRadius.approach( XGfx::delta() );
     look();
     
     // cascade simulation
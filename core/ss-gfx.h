@@ -13,6 +13,8 @@
 #include <string>
 
 
+// set number of scene update workers (before init; -1 == one per spare core)
+void ss_gfx_workers( int num );
 // entry point for graphics
 bool ss_gfx_init( int argc, const char ** argv );
 void ss_gfx_loop();
@@ -27,7 +27,35 @@ using namespace std;
 // defines
 #define SS_SRATE        44100
 #define SS_FRAMESIZE    256
+#define SS_MAX_FRAMESIZE 2048
 #define SS_NUMCHANNELS  2
+#define SS_NUMBUFFERS   0
+#define SS_RT_PRIORITY  70
+#define SS_RECORD_FILE  "ss-input.wav"
+#define SS_ECHO_SEND    0.3f
+#define SS_PINGPONG_SEND 0.3f
+#define SS_PINGPONG_FEEDBACK 0.45f
+#define SS_REVERB_SEND  0.25f
+#define SS_NUM_TRACKS   2
+#define SS_BPM_MIN      30
+#define SS_BPM_MAX      480
+#define SS_VOLUME_RAMP  0.05f
+#define SS_EQ_LO        20
+#define SS_EQ_HI        20000
+#define SS_EQ_SHELF     12
+#define SS_EQ_SLEW      0.03f
+#define SS_SPECTRUM_BINS 32
+#define SS_SPECTRUM_LO  40
+#define SS_SPECTRUM_HI  16000
+#define SS_SPECTRUM_FLOOR -60
+#define SS_ONSET_SIZE   1024
+#define SS_ONSET_HOP    128
+#define SS_STEPS_PER_BEAT 4
+#define SS_TEMPO_ONSETS 8
+#define SS_TEMPO_CONFIDENCE 0.25f
+#define SS_HISTORY_SECONDS 60
+#define SS_HISTORY_COLUMNS 1024
+#define SS_HISTORY_ROWS 128
 #define SS_MAX_TEXTURES 32
 
 #define SS_KICK  35 
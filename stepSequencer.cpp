@@ -6,9 +6,13 @@
 // date: fall 2013
 //----------------------------------------------------------------------------
 #include <iostream>
+#include <sys/time.h>
 #include "ss-audio.h"
 #include "ss-gfx.h"
 #include "ss-globals.h"
+#include "x-rtguard.h"
+#include "x-param.h"
+#include <vector>
 using namespace std;
 
 //----------------------------------------------------------------------------
@@ -17,9 +21,86 @@ using namespace std;
 //----------------------------------------------------------------------------
 int main( int argc, const char ** argv )
 {
-    system( "pwd" );
+    // audio settings
+    unsigned int frameSize = SS_FRAMESIZE;
+    // headless run length in seconds (0 == with graphics)
+    float headless = 0;
+    bool apiSet = false;
+    // record input to this file (empty == don't)
+    string record;
+    // lock memory
+    bool mlock = false;
+    vector<string> sets;
+    XAudioIO::setNumBuffers( SS_NUMBUFFERS );
+    XAudioIO::setRealtimePriority( SS_RT_PRIORITY );
+    XAudioIO::setAdaptive( SS_MAX_FRAMESIZE );
+
+    // parse our options (leave the rest for GLUT)
+    for( int i = 1; i < argc; i++ )
+    {
+        string arg = argv[i];
+        // not ours
+        if( arg.compare( 0, 2, "--" ) != 0 ) continue;
+
+        if( arg.compare( 0, 8, "--audio=" ) == 0 )
+        {
+            if( !XAudioIO::setApi( arg.substr( 8 ) ) )
+            {
+                XAudioIO::printApis();
+                return -1;
+            }
+            apiSet = true;
+        }
+        else if( arg.compare( 0, 9, "--period=" ) == 0 )
+            frameSize = atoi( arg.substr( 9 ).c_str() );
+        else if( arg.compare( 0, 11, "--adaptive=" ) == 0 )
+            XAudioIO::setAdaptive( atoi( arg.substr( 11 ).c_str() ) );
+        else if( arg.compare( 0, 10, "--buffers=" ) == 0 )
+            XAudioIO::setNumBuffers( atoi( arg.substr( 10 ).c_str() ) );
+        else if( arg.compare( 0, 11, "--priority=" ) == 0 )
+            XAudioIO::setRealtimePriority( atoi( arg.substr( 11 ).c_str() ) );
+        else if( arg.compare( 0, 11, "--rt-guard=" ) == 0 )
+        {
+            if( !XRTGuard::setMode( arg.substr( 11 ) ) ) return -1;
+            mlock = mlock || XRTGuard::mode() != XRT_GUARD_OFF;
+        }
+        else if( arg.compare( 0, 10, "--workers=" ) == 0 )
+            ss_audio_workers( atoi( arg.substr( 10 ).c_str() ) );
+        else if( arg.compare( 0, 14, "--gfx-workers=" ) == 0 )
+            ss_gfx_workers( atoi( arg.substr( 14 ).c_str() ) );
+        else if( arg.compare( 0, 9, "--reverb=" ) == 0 )
+            ss_audio_reverb( arg.substr( 9 ).c_str() );
+        else if( arg.compare( 0, 6, "--set=" ) == 0 )
+            sets.push_back( arg.substr( 6 ) );
+        else if( arg == "--mlock" )
+            mlock = true;
+        else if( arg.compare( 0, 9, "--record=" ) == 0 )
+            record = arg.substr( 9 );
+        else if( arg.compare( 0, 11, "--headless=" ) == 0 )
+            headless = atof( arg.substr( 11 ).c_str() );
+        else
+        {
+            // error message
+            cerr << "[ss]: unrecognized option '" << arg << "'..." << endl;
+            ss_usage();
+            return -1;
+        }
+    }
+
+    // headless: no graphics, the null device unless told otherwise
+    if( headless > 0 )
+    {
+        if( !apiSet ) XAudioIO::setNullMode( XAUDIO_NULL_REALTIME );
+        // skip the intro (it's silent)
+        Globals::isWelcome = false;
+    }
+    else
+    {
+        system( "pwd" );
+    }
+
     // invoke graphics setup and loop
-    if( !ss_gfx_init( argc, argv ) )
+    if( headless <= 0 && !ss_gfx_init( argc, argv ) )
     {
         // error message
         cerr << "[ss]: cannot initialize graphics/data system..." << endl;
@@ -27,12 +108,26 @@ int main( int argc, const char ** argv )
     }
     
     // start real-time audio
-    if( !ss_audio_init( SS_SRATE, SS_FRAMESIZE, SS_NUMCHANNELS ) )
+    if( !ss_audio_init( SS_SRATE, frameSize, SS_NUMCHANNELS ) )
     {
         // error message
         cerr << "[ss]: cannot initialize real-time audio I/O..." << endl;
         return -1;
     }
+
+    // control parameters (registered by ss_audio_init())
+    for( int i = 0; i < sets.size(); i++ )
+    {
+        size_t eq = sets[i].find( '=' );
+        if( eq == string::npos ||
+            !XParams::set( sets[i].substr( 0, eq ), atof( sets[i].substr( eq + 1 ).c_str() ) ) )
+        {
+            // error message
+            cerr << "[ss]: bad --set=" << sets[i] << "; parameters:" << endl;
+            XParams::print();
+            return -1;
+        }
+    }
     
     // start audio
     if( !ss_audio_start() )
@@ -42,6 +137,36 @@ int main( int argc, const char ** argv )
         return -1;
     }
     
+    // everything's loaded (incl. soundfont samples); keep it in RAM
+    if( mlock ) XRTGuard::lockMemory();
+    // say what the guard saw, on the way out
+    if( XRTGuard::mode() != XRT_GUARD_OFF ) atexit( XRTGuard::report );
+
+    // record from the start
+    if( record.size() ) ss_record_start( record.c_str() );
+
+    // headless: run the engine for a while and report
+    if( headless > 0 )
+    {
+        struct timeval start, end;
+        gettimeofday( &start, NULL );
+        // keep an eye on xruns while we wait (10 Hz)
+        for( long us = (long)(headless * 1000000); us > 0; us -= 100000 )
+        {
+            usleep( (useconds_t)( us < 100000 ? us : 100000 ) );
+            XAudioIO::adapt();
+            ss_audio_poll();
+        }
+        ss_audio_stop();
+        gettimeofday( &end, NULL );
+        // wall time
+        double wall = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+        double rendered = Globals::now / SS_SRATE;
+        fprintf( stderr, "[ss]: headless: %.2fs of audio in %.2fs (%.1fx realtime)\n",
+                 rendered, wall, rendered / wall );
+        return 0;
+    }
+
     // graphics loop
     ss_gfx_loop();
     
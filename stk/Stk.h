@@ -72,8 +72,15 @@ namespace stk {
 // Most data in STK is passed and calculated with the
 // following user-definable floating-point type.  You
 // can change this to "float" if you prefer or perhaps
-// a "long double" in the future.
+// a "long double" in the future.  Building with
+// __STK_FLOAT__ defined selects "float" (half the
+// memory per sample, twice the SIMD width; fractional
+// delays beyond 2^16 samples resolve to 1/128 sample).
+#if defined(__STK_FLOAT__)
+typedef float StkFloat;
+#else
 typedef double StkFloat;
+#endif
 
 //! STK error handling class.
 /*!
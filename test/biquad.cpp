@@ -0,0 +1,278 @@
+//-----------------------------------------------------------------------------
+// name: biquad.cpp
+// desc: YBiquadBank's process() and cascade() against a scalar transposed
+//       direct form II reference over odd block sizes, YBiquadTable's
+//       lookup() against design(); (--bench) ns per frame, bank vs scalar
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-biquad.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// sample rate
+#define SRATE 44100
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Biquad
+// desc: the scalar reference (same operation order as the SIMD lanes)
+//-----------------------------------------------------------------------------
+struct Biquad
+{
+    YBiquadCoefs c;
+    float s1, s2;
+
+    Biquad( const YBiquadCoefs & coefs ) : c( coefs ), s1( 0 ), s2( 0 ) { }
+    float tick( float x )
+    {
+        float y = c.b0 * x + s1;
+        s1 = c.b1 * x + s2 - c.a1 * y;
+        s2 = c.b2 * x - c.a2 * y;
+        return y;
+    }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: roll() / noise() / coefs()
+// desc: repeatable random integers / white noise / a random filter
+//-----------------------------------------------------------------------------
+static unsigned int g_seed = 1;
+static unsigned int roll()
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return g_seed >> 8;
+}
+static float noise()
+{ return roll() / 16777216.0f - .5f; }
+static YBiquadCoefs coefs()
+{
+    YBiquadType types[] = { YBIQUAD_LOWPASS, YBIQUAD_HIGHPASS, YBIQUAD_PEAK,
+                            YBIQUAD_LOWSHELF, YBIQUAD_HIGHSHELF, YBIQUAD_NOTCH };
+    return YBiquadCoefs::design( types[roll() % 6], SRATE, 40 + roll() % 15000,
+                                 .5f + ( roll() % 100 ) / 50.0f, ( roll() % 25 ) - 12.0f );
+}
+
+// block sizes to feed (odd on purpose)
+static const unsigned int BLOCKS[] = { 1, 3, 7, 13, 31, 64, 127, 257, 509 };
+#define NUM_BLOCKS 9
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_process()
+// desc: independent lanes vs one scalar biquad per lane
+//-----------------------------------------------------------------------------
+static void check_process()
+{
+    const int T = 20000;
+    for( int lanes = YBIQUAD_VECTOR; lanes <= YBIQUAD_MAX_LANES; lanes += YBIQUAD_VECTOR )
+    {
+        YBiquadBank bank( lanes );
+        vector<Biquad> ref;
+        for( int l = 0; l < lanes; l++ )
+        {
+            ref.push_back( Biquad( coefs() ) );
+            bank.set( l, ref.back().c );
+        }
+
+        vector<float> x( T * lanes ), y;
+        for( size_t i = 0; i < x.size(); i++ ) x[i] = noise();
+        y = x;
+        for( int done = 0, b = 0; done < T; b++ )
+        {
+            int n = min( (int)BLOCKS[b % NUM_BLOCKS], T - done );
+            bank.process( &y[done * lanes], n );
+            done += n;
+        }
+
+        double err = 0;
+        for( int i = 0; i < T; i++ )
+            for( int l = 0; l < lanes; l++ )
+                err = max( err, (double)fabsf( y[i*lanes+l] - ref[l].tick( x[i*lanes+l] ) ) );
+        fprintf( stderr, "[biquad]: process(), %2d lanes: max error %.2e\n", lanes, err );
+        T_CHECK( err < 1e-5, "process() matches scalar biquads" );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_cascade()
+// desc: stereo cascade vs a chain of scalar biquads per channel, allowing
+//       for the pipeline's lanes/2 - 1 samples of delay
+//-----------------------------------------------------------------------------
+static void check_cascade()
+{
+    const int T = 20000;
+    for( int lanes = YBIQUAD_VECTOR; lanes <= YBIQUAD_MAX_LANES; lanes += YBIQUAD_VECTOR )
+    {
+        int stages = lanes / 2, delay = stages - 1;
+        YBiquadBank bank( lanes );
+        vector<Biquad> ref[2];
+        for( int s = 0; s < stages; s++ )
+        {
+            YBiquadCoefs c = coefs();
+            ref[0].push_back( Biquad( c ) );
+            ref[1].push_back( Biquad( c ) );
+            bank.set( s * 2, c );
+            bank.set( s * 2 + 1, c );
+        }
+
+        vector<float> x( 2 * T ), y;
+        for( size_t i = 0; i < x.size(); i++ ) x[i] = noise();
+        y = x;
+        for( int done = 0, b = 0; done < T; b++ )
+        {
+            int n = min( (int)BLOCKS[b % NUM_BLOCKS], T - done );
+            bank.cascade( &y[2 * done], n );
+            done += n;
+        }
+
+        double err = 0;
+        for( int i = 0; i < T; i++ )
+            for( int c = 0; c < 2; c++ )
+            {
+                float v = x[2*i+c];
+                for( int s = 0; s < stages; s++ ) v = ref[c][s].tick( v );
+                if( i + delay < T ) err = max( err, (double)fabsf( y[2*(i+delay)+c] - v ) );
+            }
+        // and silence while the pipeline fills
+        for( int i = 0; i < delay; i++ )
+            err = max( err, (double)max( fabsf( y[2*i] ), fabsf( y[2*i+1] ) ) );
+        fprintf( stderr, "[biquad]: cascade(), %d stages (delay %d): max error %.2e\n",
+                 stages, delay, err );
+        T_CHECK( err < 1e-5, "cascade() matches a scalar chain, delayed" );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_table()
+// desc: lookup() against design() across the range (on and between entries)
+//-----------------------------------------------------------------------------
+static void check_table()
+{
+    YBiquadType types[] = { YBIQUAD_LOWPASS, YBIQUAD_HIGHPASS, YBIQUAD_LOWSHELF };
+    const char * names[] = { "low-pass", "high-pass", "low shelf (+6 dB)" };
+    for( int t = 0; t < 3; t++ )
+    {
+        float gain = types[t] == YBIQUAD_LOWSHELF ? 6 : 0;
+        YBiquadTable table( types[t], SRATE, .7071f, gain );
+        // error overall, and where it's worst
+        double err = 0, errLow = 0;
+        float worst = 0;
+        int unstable = 0;
+        // 8 points per table step
+        for( int i = 0; i <= 8 * ( YBIQUAD_TABLE - 1 ); i++ )
+        {
+            float freq = 20 * powf( 1000, (float)i / ( 8 * ( YBIQUAD_TABLE - 1 ) ) );
+            YBiquadCoefs a = table.lookup( freq );
+            YBiquadCoefs b = YBiquadCoefs::design( types[t], SRATE, freq, .7071f, gain );
+            float d[5] = { a.b0 - b.b0, a.b1 - b.b1, a.b2 - b.b2, a.a1 - b.a1, a.a2 - b.a2 };
+            for( int k = 0; k < 5; k++ )
+            {
+                if( fabsf( d[k] ) > err ) { err = fabsf( d[k] ); worst = freq; }
+                // the lerp error grows towards nyquist: below 10k separately
+                if( freq < 10000 ) errLow = max( errLow, (double)fabsf( d[k] ) );
+            }
+            // inside the stability triangle
+            if( !( fabsf( a.a2 ) < 1 && fabsf( a.a1 ) < 1 + a.a2 ) ) unstable++;
+        }
+        fprintf( stderr, "[biquad]: table, %-17s: max coefficient error %.2e (at %.0f Hz), "
+                 "%.2e below 10 kHz, %d unstable\n", names[t], err, worst, errLow, unstable );
+        T_CHECK( err < 1e-3, "lookup() is close to design()" );
+        T_CHECK( errLow < 2e-4, "lookup() is closer below 10 kHz" );
+        T_CHECK( unstable == 0, "lookup() stays stable" );
+    }
+
+    // clamped at the ends
+    YBiquadTable table( YBIQUAD_LOWPASS, SRATE );
+    YBiquadCoefs lo = table.lookup( 1 ), hi = table.lookup( 30000 );
+    YBiquadCoefs dlo = YBiquadCoefs::design( YBIQUAD_LOWPASS, SRATE, 20 );
+    YBiquadCoefs dhi = YBiquadCoefs::design( YBIQUAD_LOWPASS, SRATE, 20000 );
+    T_CHECK( fabsf( lo.a1 - dlo.a1 ) < 1e-5 && fabsf( hi.a1 - dhi.a1 ) < 1e-5,
+             "lookup() clamps to the range" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: ns per frame: bank (process / cascade) vs scalar, 256-frame blocks
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    const int N = 256, REPS = 20000;
+    for( int lanes = YBIQUAD_VECTOR; lanes <= YBIQUAD_MAX_LANES; lanes *= 2 )
+    {
+        YBiquadBank bank( lanes );
+        vector<Biquad> ref;
+        for( int l = 0; l < lanes; l++ )
+        { ref.push_back( Biquad( coefs() ) ); bank.set( l, ref.back().c ); }
+        vector<float> input( N * lanes ), buffer( N * lanes );
+        for( size_t i = 0; i < input.size(); i++ ) input[i] = noise();
+
+        // scalar, lane by lane
+        double start = t_now();
+        for( int r = 0; r < REPS; r++ )
+        {
+            copy( input.begin(), input.end(), buffer.begin() );
+            for( int l = 0; l < lanes; l++ )
+                for( int i = 0; i < N; i++ )
+                    buffer[i*lanes+l] = ref[l].tick( buffer[i*lanes+l] );
+        }
+        double scalar = ( t_now() - start ) / ( (double)REPS * N );
+        // bank
+        start = t_now();
+        for( int r = 0; r < REPS; r++ )
+        {
+            copy( input.begin(), input.end(), buffer.begin() );
+            bank.process( &buffer[0], N );
+        }
+        double simd = ( t_now() - start ) / ( (double)REPS * N );
+        // the same lanes as a stereo cascade
+        start = t_now();
+        for( int r = 0; r < REPS; r++ )
+        {
+            copy( input.begin(), input.begin() + 2 * N, buffer.begin() );
+            bank.cascade( &buffer[0], N );
+        }
+        double chain = ( t_now() - start ) / ( (double)REPS * N );
+
+        fprintf( stderr, "[biquad]: %2d lanes: scalar %6.2f ns/frame, process() %6.2f (%.1fx), "
+                 "cascade() of %d stages %6.2f\n", lanes, scalar * 1e9, simd * 1e9,
+                 scalar / simd, lanes / 2, chain * 1e9 );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    check_process();
+    check_cascade();
+    check_table();
+    return t_done( "biquad" );
+}
@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// name: convolver.cpp
+// desc: YConvolver against direct convolution, .wav edge cases, and
+//       (--bench) the cost of a 2 second stereo IR per block size
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-convolver.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: roll() / noise()
+// desc: repeatable random integers (24-bit) / white noise in [-.5, .5)
+//-----------------------------------------------------------------------------
+static unsigned int g_seed = 1;
+static unsigned int roll()
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return g_seed >> 8;
+}
+static float noise()
+{ return roll() / 16777216.0f - .5f; }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: write_wav()
+// desc: 16-bit mono .wav; dataSize overrides the data chunk's size field
+//-----------------------------------------------------------------------------
+static void write_wav( const char * path, int frames, unsigned int dataSize )
+{
+    FILE * file = fopen( path, "wb" );
+    unsigned char h[44] = { 'R','I','F','F', 0,0,0,0, 'W','A','V','E',
+        'f','m','t',' ', 16,0,0,0, 1,0, 1,0, 0x44,0xAC,0,0, 0x88,0x58,1,0,
+        2,0, 16,0, 'd','a','t','a' };
+    for( int i = 0; i < 4; i++ ) h[40+i] = ( dataSize >> ( 8*i ) ) & 0xFF;
+    fwrite( h, 1, 44, file );
+    for( int i = 0; i < frames; i++ )
+    {
+        // a decaying click
+        short s = (short)( 16000 * exp( -i / 50.0 ) );
+        fputc( s & 0xFF, file ); fputc( ( s >> 8 ) & 0xFF, file );
+    }
+    fclose( file );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_direct()
+// desc: stereo IR, random chunk sizes, against direct convolution
+//-----------------------------------------------------------------------------
+static void check_direct()
+{
+    const int L = 3000, T = 6000;
+    vector<float> ir( 2*L ), x( 2*T ), ref( 2*T, 0 );
+    for( int i = 0; i < 2*L; i++ ) ir[i] = noise() * expf( -i / 2000.0f );
+    for( int i = 0; i < 2*T; i++ ) x[i] = noise();
+    for( int c = 0; c < 2; c++ )
+        for( int n = 0; n < T; n++ )
+        {
+            double acc = 0;
+            for( int k = 0; k < L && k <= n; k++ )
+                acc += ir[2*k+c] * x[2*(n-k)+c];
+            ref[2*n+c] = (float)acc;
+        }
+
+    unsigned int blocks[] = { 4, 64, 256 };
+    for( int b = 0; b < 3; b++ )
+    {
+        YConvolver conv( blocks[b] );
+        conv.set( &ir[0], L, 2 );
+        vector<float> y = x;
+        for( int done = 0; done < T; )
+        {
+            int n = 1 + roll() % 300;
+            if( n > T - done ) n = T - done;
+            conv.synthesize2( &y[2*done], n );
+            done += n;
+        }
+        double err = 0;
+        for( int i = 0; i < 2*T; i++ ) err = max( err, (double)fabs( y[i] - ref[i] ) );
+        fprintf( stderr, "[convolver]: block %3u (%u partitions): max error %.2e\n",
+                 blocks[b], conv.partitions(), err );
+        T_CHECK( err < 1e-4, "partitioned convolution matches direct" );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_wav()
+// desc: streamed (0xFFFFFFFF data size) and empty .wavs
+//-----------------------------------------------------------------------------
+static void check_wav()
+{
+    const char * path = "convolver-test.wav";
+    YConvolver conv( 64 );
+
+    // a streamed .wav: size field unknown, load what's there
+    write_wav( path, 500, 0xFFFFFFFF );
+    T_CHECK( conv.load( path, 44100 ), "load a streamed .wav" );
+    T_CHECK( conv.partitions() == 8, "streamed .wav length from the file" );
+
+    // a data chunk claiming more than the file has
+    write_wav( path, 100, 100000 );
+    T_CHECK( conv.load( path, 44100 ), "load a truncated .wav" );
+
+    // no samples at all
+    write_wav( path, 0, 0 );
+    T_CHECK( !conv.load( path, 44100 ), "reject an empty .wav" );
+
+    remove( path );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: 2 s stereo IR at 44.1k; CPU and per-block time, per block size
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    const int SR = 44100, L = 2 * SR, SECONDS = 5;
+    vector<float> ir( 2*L );
+    for( int i = 0; i < 2*L; i++ ) ir[i] = noise() * expf( -i / (float)SR );
+
+    unsigned int blocks[] = { 64, 128, 256, 512, 1024 };
+    for( int b = 0; b < 5; b++ )
+    {
+        unsigned int N = blocks[b];
+        YConvolver conv( N );
+        conv.set( &ir[0], L, 2 );
+        vector<float> buffer( 2*N );
+        for( unsigned int i = 0; i < 2*N; i++ ) buffer[i] = noise();
+
+        vector<double> times;
+        double start = t_now();
+        for( long f = 0; f < (long)SECONDS * SR; f += N )
+        {
+            double t = t_now();
+            conv.synthesize2( &buffer[0], N );
+            times.push_back( t_now() - t );
+        }
+        double total = t_now() - start;
+        sort( times.begin(), times.end() );
+        fprintf( stderr, "[convolver]: block %4u (%4u partitions): %5.2f%% CPU, "
+                 "median %.0f p99 %.0f max %.0f us (period %.0f us)\n",
+                 N, conv.partitions(), 100 * total / SECONDS,
+                 times[times.size()/2] * 1e6, times[times.size()*99/100] * 1e6,
+                 times.back() * 1e6, N * 1e6 / SR );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    check_direct();
+    check_wav();
+    return t_done( "convolver" );
+}
@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// name: echo.cpp
+// desc: YEcho's impulse response against a per-sample stk::DelayL echo
+//       (same delay, feedback and mix), over uneven buffer sizes; and
+//       (--bench) ns per frame for buffers of 32 to 1024 frames
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-echo.h"
+#include "DelayL.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// sample rate
+#define SRATE 44100
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reference()
+// desc: the echo one sample at a time on a DelayL (one channel):
+//       line <- x + fb * delayed; out = x + mix * ( delayed - x )
+//-----------------------------------------------------------------------------
+static void reference( const vector<float> & x, vector<float> & y,
+                       double delay, float fb, float mix )
+{
+    // no longer than it has to be: DelayL's float read position is only as
+    // fine as its largest index allows
+    stk::DelayL line( delay, (unsigned long)delay + 2 );
+    y.resize( x.size() );
+    for( size_t n = 0; n < x.size(); n++ )
+    {
+        // what tick() will return (it doesn't depend on what's written)
+        float delayed = line.nextOut();
+        line.tick( x[n] + fb * delayed );
+        y[n] = x[n] + mix * ( delayed - x[n] );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: impulse response, stereo, random buffer sizes, against reference
+//-----------------------------------------------------------------------------
+static void check( float seconds, float fb, float mix )
+{
+    const int T = SRATE / 2;
+    // impulse on the left, a later (smaller) one on the right
+    vector<float> left( T, 0 ), right( T, 0 );
+    left[0] = 1;
+    right[100] = .5f;
+    vector<float> refLeft, refRight;
+    reference( left, refLeft, seconds * SRATE, fb, mix );
+    reference( right, refRight, seconds * SRATE, fb, mix );
+
+    YEcho echo( SRATE, 1.0, seconds, fb, mix );
+    vector<float> buffer( 2*T );
+    for( int i = 0; i < T; i++ ) { buffer[2*i] = left[i]; buffer[2*i+1] = right[i]; }
+    unsigned int seed = 1;
+    for( int done = 0; done < T; )
+    {
+        // 1 .. 1024 frames
+        seed = seed * 1664525 + 1013904223;
+        int n = 1 + ( seed >> 8 ) % 1024;
+        if( n > T - done ) n = T - done;
+        echo.synthesize2( &buffer[2*done], n );
+        done += n;
+    }
+
+    double err = 0, peak = 0;
+    for( int i = 0; i < T; i++ )
+    {
+        err = max( err, (double)fabsf( buffer[2*i] - refLeft[i] ) );
+        err = max( err, (double)fabsf( buffer[2*i+1] - refRight[i] ) );
+        peak = max( peak, (double)fabsf( refLeft[i] ) );
+    }
+    fprintf( stderr, "[echo]: %.2f ms, fb %.2f, mix %.2f: max error %.2e (peak %.2f)\n",
+             seconds * 1000, fb, mix, err, peak );
+    T_CHECK( err < 1e-5, "block echo matches the per-sample DelayL echo" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: ns per stereo frame, YEcho vs two per-sample DelayL echoes
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    const int SECONDS = 20;
+    const float fb = .5f, mix = .5f, seconds = .375f;
+
+    // input (copied in before every buffer: in place, the echo would feed
+    // on its own output and decay into denormals)
+    vector<float> input( 2 * 1024 ), buffer( 2 * 1024 );
+    for( size_t i = 0; i < input.size(); i++ ) input[i] = ( i % 97 ) / 97.0f - .5f;
+
+    // reference: two DelayL lines, a sample at a time
+    unsigned long longest = (unsigned long)( seconds * SRATE ) + 2;
+    stk::DelayL lines[2] = { stk::DelayL( seconds * SRATE, longest ),
+                             stk::DelayL( seconds * SRATE, longest ) };
+    double start = t_now();
+    for( long f = 0; f < (long)SECONDS * SRATE; f += 1024 )
+    {
+        copy( input.begin(), input.end(), buffer.begin() );
+        for( int i = 0; i < 2 * 1024; i++ )
+        {
+            float x = buffer[i];
+            float delayed = lines[i&1].nextOut();
+            lines[i&1].tick( x + fb * delayed );
+            buffer[i] = x + mix * ( delayed - x );
+        }
+    }
+    double ref = ( t_now() - start ) / ( (double)SECONDS * SRATE );
+    fprintf( stderr, "[echo]: per-sample DelayL: %6.2f ns/frame\n", ref * 1e9 );
+
+    for( unsigned int N = 32; N <= 1024; N *= 2 )
+    {
+        YEcho echo( SRATE, 2.0, seconds, fb, mix );
+        start = t_now();
+        for( long f = 0; f < (long)SECONDS * SRATE; f += N )
+        {
+            copy( input.begin(), input.begin() + 2*N, buffer.begin() );
+            echo.synthesize2( &buffer[0], N );
+        }
+        double each = ( t_now() - start ) / ( (double)SECONDS * SRATE );
+        fprintf( stderr, "[echo]: YEcho, %4u-frame buffers: %6.2f ns/frame (%.1fx)\n",
+                 N, each * 1e9, ref / each );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    // 10 ms (441 samples), feedback .5, all wet
+    check( .010f, .5f, 1 );
+    // a fractional delay, half wet
+    check( .00737f, .5f, .5f );
+    return t_done( "echo" );
+}
@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+// name: fft.cpp
+// desc: batched ffts (rfft_batch() / cfft_batch()) against K separate
+//       rfft() / cfft() calls, and (--bench) throughput per transform for
+//       K = 2..64, N = 512..4096
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-fft.h"
+#include <math.h>
+#include <vector>
+using namespace std;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: noise()
+// desc: repeatable white noise in [-1, 1)
+//-----------------------------------------------------------------------------
+static unsigned int g_seed = 5;
+static float noise()
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return ( g_seed >> 8 ) / 8388608.0f - 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_batch()
+// desc: K transforms of length floats (length / 2 complex points, as
+//       rfft() / cfft() count them), batched vs one at a time; returns
+//       the largest difference relative to the largest output
+//-----------------------------------------------------------------------------
+static double check_batch( bool real, long length, long K, unsigned int forward )
+{
+    vector<float> single( length * K ), batch( length * K );
+    vector<float *> lanes( K );
+    for( long i = 0; i < length * K; i++ ) single[i] = noise();
+    for( long k = 0; k < K; k++ ) lanes[k] = &single[k * length];
+    YFFTPlan::interleave( &lanes[0], &batch[0], length, K );
+
+    // one at a time
+    for( long k = 0; k < K; k++ )
+    {
+        if( real ) rfft( lanes[k], length / 2, forward );
+        else cfft( lanes[k], length / 2, forward );
+    }
+    // all at once
+    if( real ) rfft_batch( &batch[0], length / 2, K, forward );
+    else cfft_batch( &batch[0], length / 2, K, forward );
+
+    double err = 0, peak = 0;
+    for( long p = 0; p < length; p++ )
+        for( long k = 0; k < K; k++ )
+        {
+            err = fmax( err, fabs( batch[p*K + k] - lanes[k][p] ) );
+            peak = fmax( peak, fabs( lanes[k][p] ) );
+        }
+    return peak > 0 ? err / peak : err;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: every size and batch width, both kinds, both directions
+//-----------------------------------------------------------------------------
+static void check()
+{
+    long Ks[] = { 1, 2, 3, 4, 5, 8, 13, 16, 64 };
+    double worst = 0;
+    for( long N = 8; N <= 4096; N *= 2 )
+        for( int k = 0; k < 9; k++ )
+            for( int kind = 0; kind < 4; kind++ )
+            {
+                double err = check_batch( kind & 1, N, Ks[k], kind >> 1 );
+                worst = fmax( worst, err );
+                if( err > 1e-5 )
+                    fprintf( stderr, "[fft]: %s N=%ld K=%ld %s: %.2e\n",
+                             kind & 1 ? "rfft" : "cfft", N, Ks[k],
+                             kind >> 1 ? "forward" : "inverse", err );
+            }
+    fprintf( stderr, "[fft]: batch vs single, N = 8..4096, K = 1..64: "
+             "max error / peak %.2e\n", worst );
+    T_CHECK( worst <= 1e-5, "batched ffts match rfft() / cfft()" );
+
+    // forward then inverse gets the input back
+    long N = 1024, K = 8;
+    vector<float> x( N * K ), y;
+    for( long i = 0; i < N * K; i++ ) x[i] = noise();
+    y = x;
+    rfft_batch( &y[0], N / 2, K, FFT_FORWARD );
+    rfft_batch( &y[0], N / 2, K, FFT_INVERSE );
+    double err = 0;
+    for( long i = 0; i < N * K; i++ ) err = fmax( err, fabs( y[i] - x[i] ) );
+    fprintf( stderr, "[fft]: batch round trip (N=%ld, K=%ld): %.2e\n", N, K, err );
+    T_CHECK( err <= 1e-5, "batched rfft round trip" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: forward + inverse rfft, us per transform: K planned rfft() calls,
+//       one rfftBatch(), and the batch plus interleave / deinterleave
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    fprintf( stderr, "[fft]:    N   K  single   batch     +il  speedup (+il)\n" );
+    for( long N = 512; N <= 4096; N *= 2 )
+        for( long K = 2; K <= 64; K *= 2 )
+        {
+            const YFFTPlan * plan = YFFTPlan::get( N / 2 );
+            vector<float> data( N * K ), batch( N * K );
+            vector<float *> lanes( K );
+            for( long i = 0; i < N * K; i++ ) data[i] = noise();
+            for( long k = 0; k < K; k++ ) lanes[k] = &data[k * N];
+            // about the same work per row
+            long reps = 4000000 / ( N * K ) + 10;
+
+            double start = t_now();
+            for( long r = 0; r < reps; r++ )
+                for( long k = 0; k < K; k++ )
+                {
+                    plan->rfft( lanes[k], FFT_FORWARD );
+                    plan->rfft( lanes[k], FFT_INVERSE );
+                }
+            double single = t_now() - start;
+
+            start = t_now();
+            for( long r = 0; r < reps; r++ )
+            {
+                plan->rfftBatch( &batch[0], K, FFT_FORWARD );
+                plan->rfftBatch( &batch[0], K, FFT_INVERSE );
+            }
+            double batched = t_now() - start;
+
+            start = t_now();
+            for( long r = 0; r < reps; r++ )
+            {
+                YFFTPlan::interleave( &lanes[0], &batch[0], N, K );
+                plan->rfftBatch( &batch[0], K, FFT_FORWARD );
+                plan->rfftBatch( &batch[0], K, FFT_INVERSE );
+                YFFTPlan::deinterleave( &batch[0], &lanes[0], N, K );
+            }
+            double interleaved = t_now() - start;
+
+            double per = 1e6 / ( reps * K );
+            fprintf( stderr, "[fft]: %4ld %3ld  %6.2f  %6.2f  %6.2f  %5.2fx\n",
+                     N, K, single * per, batched * per, interleaved * per,
+                     single / interleaved );
+        }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    check();
+    return t_done( "fft" );
+}
@@ -0,0 +1,372 @@
+//-----------------------------------------------------------------------------
+// name: onset.cpp
+// desc: onsets and tempo (YSpectrum -> YOnsetDetector -> YTempoEstimator,
+//       as ss-audio runs them on the input) on synthesized drum takes with
+//       known onsets; --bench: precision / recall, detection latency, cost
+//       per hop, tempo and time to lock, for several tempos, and the same
+//       (less what needs ground truth) for recorded takes:
+//
+//         ./onset --bench [take.wav ...]   (e.g., from stepSequencer --record=)
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-spectrum.h"
+#include "y-onset.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+using namespace std;
+
+// as ss-audio (see ss-globals.h)
+#define SRATE 44100
+#define SIZE 1024
+#define HOP 128
+// take length (seconds)
+#define SECONDS 20
+// a detection this close to a true onset is a hit (seconds)
+#define MATCH 0.05
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: noise()
+// desc: repeatable white noise in [-1, 1)
+//-----------------------------------------------------------------------------
+static unsigned int g_seed = 3;
+static float noise()
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return ( g_seed >> 8 ) / 8388608.0f - 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: synthesize()
+// desc: kick (1, 3) / snare (2, 4) / eighth hats over a pad and a noise
+//       floor; every eighth is an onset, each moved by up to +/- jitter
+//-----------------------------------------------------------------------------
+static void synthesize( float bpm, float jitter, vector<float> & out,
+                        vector<double> & onsets )
+{
+    out.assign( SECONDS * SRATE, 0 );
+    onsets.clear();
+    float eighth = 30 / bpm;
+
+    // hits
+    for( int i = 0; ; i++ )
+    {
+        double t = .5 + i * eighth + jitter * noise();
+        long start = (long)( t * SRATE );
+        if( start + SRATE / 2 >= (long)out.size() ) break;
+        onsets.push_back( (double)start / SRATE );
+        bool beat = ( i % 2 ) == 0;
+        bool kick = beat && ( i / 2 ) % 2 == 0;
+        float phase = 0, last = 0;
+        for( long n = 0; n < SRATE / 2; n++ )
+        {
+            float s = n / (float)SRATE;
+            float v = 0;
+            if( kick )
+            {
+                // falling sine
+                phase += 2 * M_PI * ( 50 + 70 * expf( -s / .03f ) ) / SRATE;
+                v += .6f * sinf( phase ) * expf( -s / .15f );
+            }
+            else if( beat )
+            {
+                // noise and a body
+                v += ( .4f * noise() + .2f * sinf( 2 * M_PI * 180 * s ) ) * expf( -s / .08f );
+            }
+            // hat: differenced (bright) noise
+            float w = noise();
+            v += .25f * ( w - last ) * expf( -s / .02f );
+            last = w;
+            out[start + n] += v;
+        }
+    }
+
+    // pad + floor
+    for( size_t n = 0; n < out.size(); n++ )
+    {
+        float s = n / (float)SRATE;
+        out[n] += .05f * ( sinf( 2 * M_PI * 220 * s ) + sinf( 2 * M_PI * 277.2f * s ) +
+                           sinf( 2 * M_PI * 329.6f * s ) ) + .005f * noise();
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_take()
+// desc: a mono mix of a 16-bit or float .wav (what --record= writes)
+//-----------------------------------------------------------------------------
+static bool read_take( const char * path, vector<float> & out, int & srate )
+{
+    FILE * file = fopen( path, "rb" );
+    if( !file ) return false;
+    unsigned char h[12], chunk[8], fmt[16];
+    int format = 0, channels = 0, bits = 0;
+    bool ok = false;
+    if( fread( h, 1, 12, file ) == 12 && !memcmp( h, "RIFF", 4 ) && !memcmp( h + 8, "WAVE", 4 ) )
+    {
+        while( fread( chunk, 1, 8, file ) == 8 )
+        {
+            unsigned int size = chunk[4] | ( chunk[5] << 8 ) | ( chunk[6] << 16 ) | ( (unsigned int)chunk[7] << 24 );
+            if( !memcmp( chunk, "fmt ", 4 ) && size >= 16 && fread( fmt, 1, 16, file ) == 16 )
+            {
+                format = fmt[0] | ( fmt[1] << 8 );
+                channels = fmt[2] | ( fmt[3] << 8 );
+                srate = fmt[4] | ( fmt[5] << 8 ) | ( fmt[6] << 16 ) | ( fmt[7] << 24 );
+                bits = fmt[14] | ( fmt[15] << 8 );
+                fseek( file, size - 16 + ( size & 1 ), SEEK_CUR );
+            }
+            else if( !memcmp( chunk, "data", 4 ) )
+            {
+                ok = channels > 0 && ( ( format == 3 && bits == 32 ) || ( format == 1 && bits == 16 ) );
+                // read to the end (the size may be unpatched)
+                vector<float> frame( channels );
+                while( ok )
+                {
+                    float v = 0;
+                    for( int c = 0; c < channels && ok; c++ )
+                    {
+                        if( format == 3 ) ok = fread( &frame[c], 4, 1, file ) == 1;
+                        else { short s; ok = fread( &s, 2, 1, file ) == 1; frame[c] = s / 32768.0f; }
+                        v += frame[c];
+                    }
+                    if( ok ) out.push_back( v / channels );
+                }
+                ok = out.size() > 0;
+                break;
+            }
+            else fseek( file, size + ( size & 1 ), SEEK_CUR );
+        }
+    }
+    fclose( file );
+    return ok;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Run
+// desc: one take through the chain, and what came out
+//-----------------------------------------------------------------------------
+struct Run
+{
+    // magnitude frames (numBins each)
+    vector<float> frames;
+    unsigned int numBins;
+    unsigned long numFrames;
+    // detections: onset time, and when reported (end of the reporting hop)
+    vector<double> found;
+    vector<double> reported;
+    // tempo after each onset: bpm, confidence
+    vector<float> bpm;
+    vector<float> confidence;
+    // seconds: analyser (window + fft + magnitudes), detector + estimator
+    double analyseTime;
+    double detectTime;
+};
+
+// frame callback: keep the magnitudes (detection runs afterwards, timed)
+static void keep( const float * magnitudes, unsigned int numBins, void * data )
+{
+    Run * run = (Run *)data;
+    run->frames.insert( run->frames.end(), magnitudes, magnitudes + numBins );
+    run->numBins = numBins;
+    run->numFrames++;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: the take through the analyser (hop by hop, as the callback pushes
+//       it), then every frame through the detector and estimator
+//-----------------------------------------------------------------------------
+static void run( const vector<float> & take, int srate, Run & r )
+{
+    YSpectrum spectrum( srate, SIZE, HOP, YSPECTRUM_HANNING, 1 );
+    r.numFrames = 0;
+    r.frames.reserve( ( take.size() / HOP + 1 ) * ( SIZE / 2 ) );
+    spectrum.setCallback( keep, &r );
+    double start = t_now();
+    for( size_t i = 0; i + HOP <= take.size(); i += HOP )
+    {
+        spectrum.push( &take[i], HOP );
+        spectrum.analyse();
+    }
+    r.analyseTime = t_now() - start;
+
+    YOnsetDetector onsets( spectrum.numBins(), spectrum.hopTime() );
+    YTempoEstimator tempo;
+    vector<unsigned long> at;
+    start = t_now();
+    for( unsigned long f = 0; f < r.numFrames; f++ )
+    {
+        if( !onsets.frame( &r.frames[f * r.numBins] ) ) continue;
+        tempo.onset( onsets.time() );
+        at.push_back( f );
+        r.found.push_back( onsets.time() );
+        r.bpm.push_back( tempo.bpm() );
+        r.confidence.push_back( tempo.confidence() );
+    }
+    r.detectTime = t_now() - start;
+
+    // frame f is analysed once ( f + 1 ) hops are in
+    for( size_t i = 0; i < at.size(); i++ )
+        r.reported.push_back( ( at[i] + 1 ) * (double)HOP / srate );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Score
+// desc: a run against the true onsets
+//-----------------------------------------------------------------------------
+struct Score
+{
+    float precision, recall;
+    // true onset -> reported (seconds)
+    double latencyMean, latencyMax;
+    // last estimate, and when it first came within 1%
+    float bpm;
+    double lock;
+};
+
+// fold into [ YTEMPO_MIN, 2 YTEMPO_MIN )
+static float fold( float bpm )
+{
+    while( bpm >= 2 * YTEMPO_MIN ) bpm /= 2;
+    while( bpm > 0 && bpm < YTEMPO_MIN ) bpm *= 2;
+    return bpm;
+}
+
+static Score score( const Run & r, const vector<double> & truth, float bpm )
+{
+    Score s;
+    unsigned long hits = 0, matched = 0;
+    s.latencyMean = s.latencyMax = 0;
+    vector<bool> used( truth.size(), false );
+    for( size_t i = 0; i < r.found.size(); i++ )
+    {
+        // nearest true onset
+        size_t best = 0;
+        for( size_t j = 1; j < truth.size(); j++ )
+            if( fabs( truth[j] - r.found[i] ) < fabs( truth[best] - r.found[i] ) ) best = j;
+        if( truth.empty() || fabs( truth[best] - r.found[i] ) > MATCH ) continue;
+        hits++;
+        if( used[best] ) continue;
+        used[best] = true;
+        matched++;
+        double latency = r.reported[i] - truth[best];
+        s.latencyMean += latency;
+        if( latency > s.latencyMax ) s.latencyMax = latency;
+    }
+    s.precision = r.found.size() ? hits / (float)r.found.size() : 0;
+    s.recall = truth.size() ? matched / (float)truth.size() : 0;
+    if( matched ) s.latencyMean /= matched;
+
+    s.bpm = r.bpm.size() ? r.bpm.back() : 0;
+    s.lock = -1;
+    for( size_t i = 0; i < r.bpm.size() && s.lock < 0; i++ )
+        if( fabs( r.bpm[i] - fold( bpm ) ) <= .01f * fold( bpm ) )
+            s.lock = r.reported[i] - truth[0];
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: a 110 bpm take with 10ms jitter: every onset, and the tempo
+//-----------------------------------------------------------------------------
+static void check()
+{
+    vector<float> take;
+    vector<double> truth;
+    synthesize( 110, .01f, take, truth );
+    Run r;
+    run( take, SRATE, r );
+    Score s = score( r, truth, 110 );
+    fprintf( stderr, "[onset]: 110 bpm: precision %.2f recall %.2f latency %.1f / %.1f ms, "
+             "%.2f bpm\n", s.precision, s.recall, s.latencyMean * 1000,
+             s.latencyMax * 1000, s.bpm );
+    T_CHECK( s.precision >= .95f && s.recall >= .95f, "onsets found" );
+    T_CHECK( s.latencyMax <= ( SIZE / 2 + 2 * HOP ) / (double)SRATE, "onsets reported in time" );
+    T_CHECK( fabs( s.bpm - 110 ) <= 1.1f, "tempo within 1%" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: synthesized takes at several tempos, then any recorded ones
+//-----------------------------------------------------------------------------
+static void bench( int argc, const char ** argv )
+{
+    float tempos[][2] = { { 72, 0 }, { 72, .01f }, { 95, .01f }, { 110, .01f }, { 118.5f, .01f } };
+    fprintf( stderr, "[onset]:   bpm  jitter  prec  recall  latency mean/max  "
+             "us/hop: onset+tempo (analyser)  estimate  lock\n" );
+    for( int i = 0; i < 5; i++ )
+    {
+        vector<float> take;
+        vector<double> truth;
+        synthesize( tempos[i][0], tempos[i][1], take, truth );
+        Run r;
+        run( take, SRATE, r );
+        Score s = score( r, truth, tempos[i][0] );
+        fprintf( stderr, "[onset]: %5.1f  %4.0fms  %.2f  %.2f    %5.1f / %4.1f ms   "
+                 "        %5.1f (%5.1f)          %6.2f  %4.1f s\n", tempos[i][0], tempos[i][1] * 1000,
+                 s.precision, s.recall, s.latencyMean * 1000, s.latencyMax * 1000,
+                 r.detectTime * 1e6 / r.numFrames, r.analyseTime * 1e6 / r.numFrames,
+                 s.bpm, s.lock );
+    }
+
+    // recorded takes: no ground truth, so no precision / latency
+    for( int i = 1; i < argc; i++ )
+    {
+        if( argv[i][0] == '-' ) continue;
+        vector<float> take;
+        int srate = SRATE;
+        if( !read_take( argv[i], take, srate ) )
+        {
+            fprintf( stderr, "[onset]: cannot read '%s' (16-bit or float .wav)\n", argv[i] );
+            continue;
+        }
+        Run r;
+        run( take, srate, r );
+        fprintf( stderr, "[onset]: '%s': %.1f s, %lu onsets, us/hop %.1f (%.1f), "
+                 "%.2f bpm (confidence %.2f)\n", argv[i], take.size() / (float)srate,
+                 (unsigned long)r.found.size(), r.detectTime * 1e6 / r.numFrames,
+                 r.analyseTime * 1e6 / r.numFrames, r.bpm.size() ? r.bpm.back() : 0,
+                 r.confidence.size() ? r.confidence.back() : 0 );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench( argc, argv ); return 0; }
+
+    check();
+    return t_done( "onset" );
+}
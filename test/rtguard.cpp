@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------------
+// name: rtguard.cpp
+// desc: XRTGuard catches heap use inside a guarded section (malloc, new,
+//       vector growth) and stays quiet in a clean one; (--bench) the cost
+//       of a section and of an allocation under the guard
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "x-rtguard.h"
+#include <stdlib.h>
+#include <vector>
+using namespace std;
+
+// keeps allocations from being optimized away
+static void * volatile g_sink = NULL;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: counts()
+// desc: allocations / frees / page faults so far
+//-----------------------------------------------------------------------------
+static void counts( unsigned long & allocs, unsigned long & frees, unsigned long & faults )
+{
+    XRTGuardStats s;
+    XRTGuard::stats( s );
+    allocs = s.counts[XRT_ALLOC];
+    frees = s.counts[XRT_FREE];
+    faults = s.counts[XRT_FAULT];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_dirty()
+// desc: a section that allocates must report it
+//-----------------------------------------------------------------------------
+static void check_dirty()
+{
+    unsigned long a0, f0, p0, a1, f1, p1;
+
+    // malloc / free
+    counts( a0, f0, p0 );
+    XRTGuard::enter();
+    g_sink = malloc( 64 );
+    free( g_sink );
+    XRTGuard::leave();
+    counts( a1, f1, p1 );
+    fprintf( stderr, "[rtguard]: malloc/free: %lu allocation(s), %lu free(s)\n",
+             a1 - a0, f1 - f0 );
+    T_CHECK( a1 - a0 >= 1 && f1 - f0 >= 1, "malloc/free in a section are caught" );
+
+    // new / delete
+    counts( a0, f0, p0 );
+    XRTGuard::enter();
+    int * p = new int[16];
+    g_sink = p;
+    delete [] p;
+    XRTGuard::leave();
+    counts( a1, f1, p1 );
+    fprintf( stderr, "[rtguard]: new/delete:  %lu allocation(s), %lu free(s)\n",
+             a1 - a0, f1 - f0 );
+    T_CHECK( a1 - a0 >= 1 && f1 - f0 >= 1, "new/delete in a section are caught" );
+
+    // vector growth (room for 4, then 100 more)
+    vector<float> v( 4 );
+    counts( a0, f0, p0 );
+    XRTGuard::enter();
+    for( int i = 0; i < 100; i++ ) v.push_back( i );
+    g_sink = &v[0];
+    XRTGuard::leave();
+    counts( a1, f1, p1 );
+    fprintf( stderr, "[rtguard]: vector growth: %lu allocation(s), %lu free(s)\n",
+             a1 - a0, f1 - f0 );
+    T_CHECK( a1 - a0 >= 1, "vector growth in a section is caught" );
+
+    // outside a section: nothing
+    counts( a0, f0, p0 );
+    g_sink = malloc( 64 );
+    free( g_sink );
+    counts( a1, f1, p1 );
+    T_CHECK( a1 == a0 && f1 == f0, "allocations outside a section are not counted" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_clean()
+// desc: a section that only works on prepared memory reports nothing
+//-----------------------------------------------------------------------------
+static void check_clean()
+{
+    // prepared outside, touched before
+    vector<float> buffer( 4096 );
+    XRTGuard::prefault( &buffer[0], buffer.size() * sizeof(float) );
+
+    unsigned long a0, f0, p0, a1, f1, p1;
+    counts( a0, f0, p0 );
+    for( int n = 0; n < 100; n++ )
+    {
+        XRTGuard::enter();
+        // a callback's worth of work
+        for( size_t i = 0; i < buffer.size(); i++ )
+            buffer[i] = buffer[i] * .5f + n;
+        XRTGuard::leave();
+    }
+    counts( a1, f1, p1 );
+    fprintf( stderr, "[rtguard]: clean: %lu allocation(s), %lu free(s), %lu page fault(s)\n",
+             a1 - a0, f1 - f0, p1 - p0 );
+    T_CHECK( a1 == a0 && f1 == f0, "a clean section reports no heap use" );
+    T_CHECK( p1 == p0, "a clean section reports no page faults" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: cost of an empty section, and of malloc/free with the guard on
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    const int N = 1000000;
+    // an empty section (two getrusage() calls)
+    double start = t_now();
+    for( int i = 0; i < N / 10; i++ ) { XRTGuard::enter(); XRTGuard::leave(); }
+    double section = ( t_now() - start ) / ( N / 10 );
+    // malloc/free outside a section (the thread-local check only)
+    start = t_now();
+    for( int i = 0; i < N; i++ ) { g_sink = malloc( 64 ); free( g_sink ); }
+    double outside = ( t_now() - start ) / N;
+    // malloc/free inside one (counted)
+    XRTGuard::enter();
+    start = t_now();
+    for( int i = 0; i < N; i++ ) { g_sink = malloc( 64 ); free( g_sink ); }
+    double inside = ( t_now() - start ) / N;
+    XRTGuard::leave();
+
+    fprintf( stderr, "[rtguard]: empty section %.2f us | malloc+free: outside %.1f ns, "
+             "inside (recorded) %.1f ns\n", section * 1e6, outside * 1e9, inside * 1e9 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    XRTGuard::setMode( XRT_GUARD_RECORD );
+    // the first section on a thread pre-faults its stack: get it done
+    XRTGuard::enter();
+    XRTGuard::leave();
+
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    check_dirty();
+    check_clean();
+    return t_done( "rtguard" );
+}
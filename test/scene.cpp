@@ -0,0 +1,317 @@
+//-----------------------------------------------------------------------------
+// name: scene.cpp
+// desc: YFlatScene against the same bokehs in a YEntity tree (same state,
+//       frame for frame; settling and waking), and (--bench) update time
+//       per frame at 1k / 10k / 100k bokehs, moving and idle (settled);
+//       with --workers=N, serial vs the update pool instead
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "y-scene.h"
+#include "x-workers.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <thread>
+using namespace std;
+
+// frame time (seconds)
+#define DT ( 1 / 60.0 )
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setup()
+// desc: a bokeh as the intro makes them (repeatable: same seed, same bokehs)
+//-----------------------------------------------------------------------------
+static unsigned int g_seed = 1;
+static int roll( int n )
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return ( g_seed >> 8 ) % n;
+}
+static void setup( YBokeh * b )
+{
+    b->set( 1, 1, 1, 1, 0 );
+    b->setBokehParams( roll( 10 ), 1 + roll( 2 ), 50,
+                       Vector3D( roll( 10 ), roll( 8 ), 0 ), Vector3D( .1, .2, .4 ) );
+    b->setAlpha( .1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: same()
+// desc: do two bokehs look the same?
+//-----------------------------------------------------------------------------
+static bool same( const YBokeh * a, const YBokeh * b )
+{
+    return a->loc == b->loc && a->col == b->col && a->sca == b->sca &&
+           a->alpha == b->alpha && a->active == b->active;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: flat vs tree, then settling and waking
+//-----------------------------------------------------------------------------
+static void check()
+{
+    const int N = 500;
+    YEntity root;
+    YFlatScene scene;
+    vector<YBokeh *> tree, flat;
+    scene.reserve<YBokeh>( N );
+    g_seed = 1;
+    for( int i = 0; i < N; i++ )
+    { tree.push_back( new YBokeh() ); setup( tree.back() ); root.addChild( tree.back() ); }
+    g_seed = 1;
+    for( int i = 0; i < N; i++ )
+    { flat.push_back( scene.create<YBokeh>() ); setup( flat.back() ); }
+
+    // frame for frame (long enough to settle)
+    int differ = 0, frames = 0;
+    for( ; frames < 6000 && ( frames < 100 || scene.numAwake() ); frames++ )
+    {
+        root.updateAll( DT );
+        scene.updateAll( DT );
+        for( int i = 0; i < N; i++ )
+            if( !same( tree[i], flat[i] ) ) differ++;
+    }
+    fprintf( stderr, "[scene]: %d bokehs settled after %d frames; %d differences\n",
+             N, frames, differ );
+    T_CHECK( differ == 0, "flat scene updates as the tree does" );
+    T_CHECK( scene.numAwake() == 0, "settled bokehs leave the active set" );
+
+    // idle frames change nothing
+    root.updateAll( DT );
+    scene.updateAll( DT );
+    differ = 0;
+    for( int i = 0; i < N; i++ ) if( !same( tree[i], flat[i] ) ) differ++;
+    T_CHECK( differ == 0, "idle frames match" );
+
+    // a setter wakes its bokeh, and it moves again
+    Vector3D before = flat[7]->loc;
+    flat[7]->setBokehParams( 0, 1, 50, Vector3D( 3, 3, 3 ), Vector3D( .1, .2, .4 ) );
+    tree[7]->setBokehParams( 0, 1, 50, Vector3D( 3, 3, 3 ), Vector3D( .1, .2, .4 ) );
+    T_CHECK( scene.numAwake() == 1, "wake() puts a bokeh back" );
+    for( int f = 0; f < 10; f++ ) { root.updateAll( DT ); scene.updateAll( DT ); }
+    T_CHECK( !( flat[7]->loc == before ), "a woken bokeh moves" );
+    T_CHECK( same( tree[7], flat[7] ), "and moves as the tree's does" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_parallel()
+// desc: an independent scene on the update pool against the same scene
+//       serially; bokehs straight under the scene (split across the pool)
+//       and a flare under each (nested: serial), some of whose parents go
+//       inactive partway
+//-----------------------------------------------------------------------------
+static void check_parallel()
+{
+    const int N = 2000;
+    XWorkerPool pool;
+    pool.start( 3, 0, false, false );
+    YFlatScene serial, parallel;
+    parallel.independent = true;
+    vector<YBokeh *> a, b;
+    serial.reserve<YBokeh>( 2 * N );
+    parallel.reserve<YBokeh>( 2 * N );
+    // nested ones in a table of their own
+    serial.reserve<YFlare>( N );
+    parallel.reserve<YFlare>( N );
+    g_seed = 1;
+    for( int i = 0; i < N; i++ ) { a.push_back( serial.create<YBokeh>() ); setup( a.back() ); }
+    g_seed = 1;
+    for( int i = 0; i < N; i++ ) { b.push_back( parallel.create<YBokeh>() ); setup( b.back() ); }
+    vector<YFlare *> na, nb;
+    for( int i = 0; i < N; i++ )
+    {
+        na.push_back( serial.create<YFlare>( a[i] ) ); na.back()->setAlpha( .5 );
+        nb.push_back( parallel.create<YFlare>( b[i] ) ); nb.back()->setAlpha( .5 );
+    }
+
+    int differ = 0;
+    for( int f = 0; f < 600; f++ )
+    {
+        // parents going out partway
+        if( f == 200 )
+            for( int i = 0; i < N; i += 5 ) a[i]->active = b[i]->active = false;
+        YEntity::setUpdatePool( NULL );
+        serial.updateAll( DT );
+        YEntity::setUpdatePool( &pool );
+        parallel.updateAll( DT );
+        for( int i = 0; i < N; i++ )
+        {
+            if( !same( a[i], b[i] ) ) differ++;
+            if( !( na[i]->loc == nb[i]->loc ) || na[i]->alpha != nb[i]->alpha ||
+                na[i]->active != nb[i]->active ) differ++;
+        }
+    }
+    YEntity::setUpdatePool( NULL );
+    pool.stop();
+    fprintf( stderr, "[scene]: %d + %d nested bokehs on %d workers: %d differences\n",
+             N, N, 3, differ );
+    T_CHECK( differ == 0, "parallel update matches serial" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check_slew()
+// desc: slews settle at any magnitude (a large goal used to stall a step
+//       short of it, under half an ulp per frame, and never settle)
+//-----------------------------------------------------------------------------
+static void check_slew()
+{
+    float goals[] = { .5f, 100, 2500, -100000 };
+    for( int i = 0; i < 4; i++ )
+    {
+        Vector3D slew( 0, goals[i], .05f );
+        int frames = 0;
+        while( slew.approach( 1 ) && frames < 100000 ) frames++;
+        fprintf( stderr, "[scene]: slew to %g settled after %d frames\n", goals[i], frames );
+        T_CHECK( slew.settled(), "slews settle" );
+    }
+
+    // no rate, no snap
+    Vector3D stuck( 0, 100, 0 );
+    stuck.approach( 1 );
+    T_CHECK( stuck.value == 0, "a zero slew stays put" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: update time per frame, tree vs flat, moving and settled
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    fprintf( stderr, "[scene]:      n  tree  (back to back)      flat   | idle: tree      flat\n" );
+    for( int n = 1000; n <= 100000; n *= 10 )
+    {
+        int reps = 2000000 / n;
+        // tree: heap, other allocations in between (as in the running app)
+        YEntity scattered;
+        vector<string *> junk;
+        for( int i = 0; i < n; i++ )
+        {
+            YBokeh * b = new YBokeh(); setup( b ); scattered.addChild( b );
+            junk.push_back( new string( 40 + roll( 200 ), 'x' ) );
+        }
+        // tree, allocated back to back
+        YEntity packed;
+        for( int i = 0; i < n; i++ )
+        { YBokeh * b = new YBokeh(); setup( b ); packed.addChild( b ); }
+        // flat
+        YFlatScene scene;
+        scene.reserve<YBokeh>( n );
+        for( int i = 0; i < n; i++ ) setup( scene.create<YBokeh>() );
+
+        double start = t_now();
+        for( int r = 0; r < reps; r++ ) scattered.updateAll( DT );
+        double tree = ( t_now() - start ) / reps;
+        start = t_now();
+        for( int r = 0; r < reps; r++ ) packed.updateAll( DT );
+        double tree2 = ( t_now() - start ) / reps;
+        start = t_now();
+        for( int r = 0; r < reps; r++ ) scene.updateAll( DT );
+        double flat = ( t_now() - start ) / reps;
+
+        // settle everything, then idle frames
+        for( int f = 0; f < 20000 && scene.numAwake(); f++ )
+        { packed.updateAll( DT ); scene.updateAll( DT ); }
+        start = t_now();
+        for( int r = 0; r < reps; r++ ) packed.updateAll( DT );
+        double idleTree = ( t_now() - start ) / reps;
+        start = t_now();
+        for( int r = 0; r < reps; r++ ) scene.updateAll( DT );
+        double idleFlat = ( t_now() - start ) / reps;
+
+        fprintf( stderr, "[scene]: %6d  %8.1f (%8.1f) us  %8.1f us | %8.1f  %8.2f us\n",
+                 n, tree * 1e6, tree2 * 1e6, flat * 1e6, idleTree * 1e6, idleFlat * 1e6 );
+        for( size_t i = 0; i < junk.size(); i++ ) delete junk[i];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench_workers()
+// desc: update time per frame of an independent flat scene, serial vs on
+//       a pool of the given number of workers, at 10k / 100k moving bokehs
+//-----------------------------------------------------------------------------
+static void bench_workers( int workers )
+{
+    XWorkerPool pool;
+    pool.start( workers, 0, true, false );
+    fprintf( stderr, "[scene]: %d core(s), %d worker(s) started\n",
+             (int)std::thread::hardware_concurrency(), pool.size() );
+    fprintf( stderr, "[scene]:      n    serial      pool   speed-up\n" );
+    for( int n = 10000; n <= 100000; n *= 10 )
+    {
+        // few enough frames that nothing settles (everything keeps moving)
+        int reps = 2000000 / n;
+        YFlatScene scenes[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            scenes[k].independent = true;
+            scenes[k].reserve<YBokeh>( n );
+            g_seed = 1;
+            for( int i = 0; i < n; i++ ) setup( scenes[k].create<YBokeh>() );
+        }
+
+        YEntity::setUpdatePool( NULL );
+        double start = t_now();
+        for( int r = 0; r < reps; r++ ) scenes[0].updateAll( DT );
+        double serial = ( t_now() - start ) / reps;
+        YEntity::setUpdatePool( &pool );
+        start = t_now();
+        for( int r = 0; r < reps; r++ ) scenes[1].updateAll( DT );
+        double pooled = ( t_now() - start ) / reps;
+        YEntity::setUpdatePool( NULL );
+
+        fprintf( stderr, "[scene]: %6d  %8.1f  %8.1f us   %.2fx\n",
+                 n, serial * 1e6, pooled * 1e6, serial / pooled );
+    }
+    pool.stop();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) )
+    {
+        // --workers=N: serial vs the update pool instead
+        for( int i = 1; i < argc; i++ )
+            if( !strncmp( argv[i], "--workers=", 10 ) )
+            { bench_workers( atoi( argv[i] + 10 ) ); return 0; }
+        bench();
+        return 0;
+    }
+
+    check();
+    check_parallel();
+    check_slew();
+    return t_done( "scene" );
+}
@@ -0,0 +1,106 @@
+//-----------------------------------------------------------------------------
+// name: stk.cpp
+// desc: StkFloat equivalence: built once with double (the default) and once
+//       with __STK_FLOAT__; the double build prints its output, the float
+//       build reads that from stdin and checks it against its own:
+//
+//         ./stk-double | ./stk-float
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "Delay.h"
+#include "DelayL.h"
+#include <math.h>
+#include <vector>
+using namespace stk;
+using namespace std;
+
+// what's compared (one column each)
+enum { DELAY, DELAYL, DELAYL_LONG, FRAMES, NUM_COLUMNS };
+// largest difference from double allowed per column; the long DelayL is
+// loose because float holds an 88200 sample delay only to 1/128 sample
+static const double TOLERANCE[NUM_COLUMNS] = { 1e-5, 1e-6, 2e-3, 1e-5 };
+static const char * NAME[NUM_COLUMNS] =
+    { "Delay (1234)", "DelayL (777.37, retuned)", "DelayL (88200.37)",
+      "StkFrames interpolate/tick" };
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: push a repeatable signal through everything; rows of NUM_COLUMNS
+//-----------------------------------------------------------------------------
+static void run( vector<double> & out )
+{
+    const int N = 200000;
+    Delay delay( 1234, 100000 );
+    DelayL delayL( 777.37, 100000 );
+    DelayL delayLong( 88200.37, 100000 );
+    unsigned int seed = 7;
+
+    for( int i = 0; i < N; i++ )
+    {
+        seed = seed * 1664525 + 1013904223;
+        double x = sin( i * 0.013 ) * 0.7 + ( ( seed >> 8 ) / 16777216.0 - .5 ) * 0.3;
+        // retune now and then
+        if( i % 50000 == 0 ) delayL.setDelay( 500.125 + i / 1000.0 );
+        out.push_back( delay.tick( x ) );
+        out.push_back( delayL.tick( x ) );
+        out.push_back( delayLong.tick( x ) );
+        out.push_back( 0 );
+    }
+
+    // StkFrames: interpolate, then the frame tick paths
+    StkFrames frames( 4096, 1 ), outFrames( 4096, 1 );
+    for( unsigned int i = 0; i < frames.size(); i++ ) frames[i] = sin( i * 0.01 );
+    for( int i = 0; i < 1000; i++ )
+    { out.push_back( 0 ); out.push_back( 0 ); out.push_back( 0 );
+      out.push_back( frames.interpolate( i * 4.0913, 0 ) ); }
+    delay.tick( frames, 0 );
+    delayL.tick( frames, outFrames, 0, 0 );
+    for( unsigned int i = 0; i < frames.size(); i++ )
+    { out.push_back( 0 ); out.push_back( 0 ); out.push_back( 0 );
+      out.push_back( frames[i] + outFrames[i] ); }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    vector<double> out;
+    run( out );
+
+    // the reference: just print
+    if( sizeof( StkFloat ) == sizeof( double ) )
+    {
+        for( size_t i = 0; i < out.size(); i++ )
+            printf( "%.17g\n", out[i] );
+        return 0;
+    }
+
+    // compare against the reference
+    double worst[NUM_COLUMNS] = { 0 };
+    size_t i = 0;
+    double ref;
+    for( ; i < out.size() && scanf( "%lf", &ref ) == 1; i++ )
+    {
+        double d = fabs( out[i] - ref );
+        if( d > worst[i % NUM_COLUMNS] ) worst[i % NUM_COLUMNS] = d;
+    }
+    T_CHECK( i == out.size(), "reference (double build) on stdin" );
+    for( int c = 0; c < NUM_COLUMNS; c++ )
+    {
+        fprintf( stderr, "[stk]: %-28s max |float - double| %.2e (allowed %.0e)\n",
+                 NAME[c], worst[c], TOLERANCE[c] );
+        T_CHECK( worst[c] <= TOLERANCE[c], NAME[c] );
+    }
+    return t_done( "stk float" );
+}
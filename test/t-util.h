@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// name: t-util.h
+// desc: shared bits for the test/benchmark programs (timing, checks)
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __T_UTIL_H__
+#define __T_UTIL_H__
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+// failed checks so far
+static int g_failures = 0;
+
+// check a condition (report, but keep going)
+#define T_CHECK( cond, what ) \
+    do { if( !( cond ) ) { fprintf( stderr, "[test]: FAILED: %s (%s:%d)\n", \
+         what, __FILE__, __LINE__ ); g_failures++; } } while( 0 )
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: t_now()
+// desc: wall clock, in seconds
+//-----------------------------------------------------------------------------
+static double t_now()
+{
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: t_bench()
+// desc: was --bench given?
+//-----------------------------------------------------------------------------
+static bool t_bench( int argc, const char ** argv )
+{
+    for( int i = 1; i < argc; i++ )
+        if( !strcmp( argv[i], "--bench" ) ) return true;
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: t_done()
+// desc: summary line and exit code
+//-----------------------------------------------------------------------------
+static int t_done( const char * name )
+{
+    if( g_failures )
+        fprintf( stderr, "[test]: %s: %d check(s) failed\n", name, g_failures );
+    else
+        fprintf( stderr, "[test]: %s: ok\n", name );
+    return g_failures ? 1 : 0;
+}
+
+
+#endif
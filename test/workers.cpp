@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+// name: workers.cpp
+// desc: XWorkerPool under stress: back-to-back batches of alternating
+//       sizes, every item run exactly once and none still running after
+//       the join; (--bench) fork/join cost per batch
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "t-util.h"
+#include "x-workers.h"
+#include <atomic>
+#include <thread>
+using namespace std;
+
+// most items in a batch
+#define MAX_ITEMS 64
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Batch
+// desc: what a batch's items record (two of these take turns)
+//-----------------------------------------------------------------------------
+struct Batch
+{
+    // times each item ran
+    atomic<int> runs[MAX_ITEMS];
+    // items running right now (shared by both batches)
+    atomic<int> * running;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: item()
+// desc: a job: count the run, do a little (uneven) work
+//-----------------------------------------------------------------------------
+static void item( int index, void * data )
+{
+    Batch * batch = (Batch *)data;
+    batch->running->fetch_add( 1 );
+    batch->runs[index].fetch_add( 1 );
+    // uneven, so items finish out of order
+    volatile int spin = 0;
+    for( int i = 0; i < ( index % 7 ) * 50; i++ ) spin++;
+    batch->running->fetch_sub( 1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: empty()
+// desc: a job that does nothing (for the bench)
+//-----------------------------------------------------------------------------
+static void empty( int index, void * data )
+{ }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: alternating batch sizes, per-index run counts, 1..3 workers
+//-----------------------------------------------------------------------------
+static void check()
+{
+    // alternate small and large: a late worker from a small batch meets a
+    // large one (and the other way round)
+    const int sizes[] = { 2, 37, 3, 64, 5, 16, 2, 63 };
+    const int BATCHES = 20000;
+
+    for( int workers = 1; workers <= 3; workers++ )
+    {
+        XWorkerPool pool;
+        pool.start( workers, 0, false, false );
+        atomic<int> running( 0 );
+        Batch batches[2];
+        for( int b = 0; b < 2; b++ )
+        {
+            batches[b].running = &running;
+            for( int i = 0; i < MAX_ITEMS; i++ ) batches[b].runs[i] = 0;
+        }
+
+        int wrong = 0, busy = 0;
+        for( int n = 0; n < BATCHES; n++ )
+        {
+            Batch & batch = batches[n % 2];
+            int count = sizes[n % 8];
+            pool.run( item, &batch, count );
+            // nothing may still be running once run() returns
+            if( running.load() != 0 ) busy++;
+            // each item exactly once
+            for( int i = 0; i < MAX_ITEMS; i++ )
+            {
+                int runs = batch.runs[i].exchange( 0 );
+                if( runs != ( i < count ? 1 : 0 ) ) wrong++;
+            }
+            // and nothing from the batch before turned up late
+            Batch & other = batches[( n + 1 ) % 2];
+            for( int i = 0; i < MAX_ITEMS; i++ )
+                if( other.runs[i].load() != 0 ) wrong++;
+        }
+        pool.stop();
+
+        fprintf( stderr, "[workers]: %d worker(s), %d batches: %d wrong counts, "
+                 "%d joins with items still running\n", workers, BATCHES, wrong, busy );
+        T_CHECK( wrong == 0, "every item runs exactly once" );
+        T_CHECK( busy == 0, "run() returns after every item is done" );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bench()
+// desc: fork/join cost per batch of empty jobs, serial vs pooled
+//-----------------------------------------------------------------------------
+static void bench()
+{
+    const int BATCHES = 20000;
+    const int sizes[] = { 2, 4, 16, 64 };
+    int cores = (int)std::thread::hardware_concurrency();
+    fprintf( stderr, "[workers]: %d core(s)\n", cores );
+    for( int workers = 0; workers <= 3; workers++ )
+    {
+        XWorkerPool pool;
+        pool.start( workers, 0, true, false );
+        for( int s = 0; s < 4; s++ )
+        {
+            double start = t_now();
+            for( int n = 0; n < BATCHES; n++ ) pool.run( empty, NULL, sizes[s] );
+            double each = ( t_now() - start ) / BATCHES;
+            fprintf( stderr, "[workers]: %d worker(s), %2d items: %6.2f us per batch\n",
+                     workers, sizes[s], each * 1e6 );
+        }
+        pool.stop();
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, const char ** argv )
+{
+    if( t_bench( argc, argv ) ) { bench(); return 0; }
+
+    check();
+    return t_done( "workers" );
+}
@@ -36,8 +36,17 @@
 //   date: 2013
 //-----------------------------------------------------------------------------
 #include "x-audio.h"
+#include "x-thread.h"
+#include "x-rtguard.h"
 #include "RtAudio.h"
 #include <iostream>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#if defined(__PLATFORM_LINUX__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 using namespace std;
 
 
@@ -46,11 +55,185 @@ using namespace std;
 // static instantiation
 RtAudio * XAudioIO::o_audio;
 XAudioCallback XAudioIO::o_callback;
-SAMPLE * XAudioIO::o_input_buffer;
-SAMPLE * XAudioIO::o_output_buffer;
 unsigned int XAudioIO::o_num_frames;
 unsigned int XAudioIO::o_num_channels;
+unsigned int XAudioIO::o_num_input_channels;
 unsigned int XAudioIO::o_srate;
+unsigned int XAudioIO::o_num_buffers = 0;
+unsigned int XAudioIO::o_latency = 0;
+int XAudioIO::o_api = RtAudio::UNSPECIFIED;
+int XAudioIO::o_rt_priority = 0;
+std::atomic<int> XAudioIO::o_rt_state( XAUDIO_RT_OFF );
+std::atomic<int> XAudioIO::o_rt_error( 0 );
+float XAudioIO::o_capture_seconds = 2;
+XRingBuffer<SAMPLE> * XAudioIO::o_capture = NULL;
+unsigned int XAudioIO::o_adapt_min = 0;
+unsigned int XAudioIO::o_adapt_max = 0;
+int XAudioIO::o_null_mode = XAUDIO_NULL_OFF;
+void * XAudioIO::o_user_data;
+SAMPLE * XAudioIO::o_null_output;
+SAMPLE * XAudioIO::o_null_input;
+XThread * XAudioIO::o_null_thread;
+std::atomic<bool> XAudioIO::o_null_running( false );
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: now_ns()
+// desc: monotonic wall clock, in nanoseconds
+//-----------------------------------------------------------------------------
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct XAudioTelemetry
+// desc: audio thread health counters; written only by the audio thread,
+//       published to readers through a sequence counter (seqlock), so
+//       neither side ever blocks
+//-----------------------------------------------------------------------------
+struct XAudioTelemetry
+{
+    // odd while the audio thread is writing
+    std::atomic<unsigned long> seq;
+    // counters
+    std::atomic<unsigned long> callbacks;
+    std::atomic<unsigned long> underflows;
+    std::atomic<unsigned long> overflows;
+    std::atomic<unsigned long> buckets[XAUDIO_STATS_BUCKETS];
+    // nanoseconds
+    std::atomic<long long> period;
+    std::atomic<long long> last;
+    std::atomic<long long> worst;
+    std::atomic<long long> worstMargin;
+    // set by resetWorst(), honored by the audio thread
+    std::atomic<bool> resetWorst;
+};
+
+// the one instance (zero-initialized)
+static XAudioTelemetry g_telemetry;
+// device status for the current callback (audio thread only)
+static RtAudioStreamStatus g_status = 0;
+
+
+
+
+// adaptive buffer size: grow after this many xruns...
+#define XAUDIO_ADAPT_XRUNS   3
+// ...within this many seconds (also the hold-off after a change)
+#define XAUDIO_ADAPT_WINDOW  2.0
+// step back down after this many seconds without an xrun
+#define XAUDIO_ADAPT_STABLE  30.0
+
+//-----------------------------------------------------------------------------
+// name: struct XAudioAdapt
+// desc: adapt() state (control thread only)
+//-----------------------------------------------------------------------------
+struct XAudioAdapt
+{
+    // xrun count at last look
+    unsigned long lastXruns;
+    // xruns in the current window
+    unsigned long windowXruns;
+    // nanoseconds
+    long long windowStart;
+    long long lastXrun;
+    long long holdUntil;
+};
+
+// the one instance
+static XAudioAdapt g_adapt;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct XAudioApiName
+// desc: backend name to RtAudio api mapping
+//-----------------------------------------------------------------------------
+struct XAudioApiName
+{
+    const char * name;
+    RtAudio::Api api;
+};
+
+static const XAudioApiName g_apiNames[] =
+{
+    { "alsa", RtAudio::LINUX_ALSA },
+    { "jack", RtAudio::UNIX_JACK },
+    { "oss", RtAudio::LINUX_OSS },
+    { "core", RtAudio::MACOSX_CORE },
+    { "asio", RtAudio::WINDOWS_ASIO },
+    { "ds", RtAudio::WINDOWS_DS },
+    { "dummy", RtAudio::RTAUDIO_DUMMY },
+    { NULL, RtAudio::UNSPECIFIED }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: api2name()
+// desc: backend name for an RtAudio api
+//-----------------------------------------------------------------------------
+static const char * api2name( int api )
+{
+    for( int i = 0; g_apiNames[i].name; i++ )
+        if( g_apiNames[i].api == api ) return g_apiNames[i].name;
+    return "default";
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bump()
+// desc: increment a counter that only the audio thread writes
+//-----------------------------------------------------------------------------
+static inline void bump( std::atomic<unsigned long> & counter )
+{
+    counter.store( counter.load( std::memory_order_relaxed ) + 1,
+                   std::memory_order_relaxed );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: promote_thread()
+// desc: try to put the calling (audio callback) thread into SCHED_FIFO;
+//       runs once, on the first callback
+//-----------------------------------------------------------------------------
+static int promote_thread( int priority )
+{
+#if defined(__PLATFORM_LINUX__)
+    int policy;
+    struct sched_param param;
+    // some backends (e.g., JACK) already run us realtime
+    if( pthread_getschedparam( pthread_self(), &policy, &param ) == 0 &&
+        ( policy == SCHED_FIFO || policy == SCHED_RR ) )
+        return 0;
+
+    // clamp
+    int min = sched_get_priority_min( SCHED_FIFO );
+    int max = sched_get_priority_max( SCHED_FIFO );
+    if( priority < min ) priority = min;
+    else if( priority > max ) priority = max;
+    // ask
+    param.sched_priority = priority;
+    return pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+#else
+    // scheduling is up to the backend (CoreAudio threads are time-constrained)
+    return 0;
+#endif
+}
 
 
 
@@ -63,8 +246,8 @@ static int audio_callback(
     void * outputBuffer, void * inputBuffer, unsigned int numFrames,
     double streamTime, RtAudioStreamStatus status, void * data )
 {
-    // check status
-    if( status ) cerr << "[x-audio]: overflow/underflow detected..." << endl;
+    // xruns get counted in cb() (no printing here; see XAudioIO::stats())
+    g_status = status;
 
     // call to XAudioIO
     return XAudioIO::cb( (SAMPLE *)outputBuffer, (SAMPLE *)inputBuffer, numFrames,
@@ -81,6 +264,14 @@ static int audio_callback(
 int XAudioIO::cb( SAMPLE * outputBuffer, SAMPLE * inputBuffer,
                   unsigned int numFrames, double streamTime, void * data )
 {
+    // realtime promotion (first callback only)
+    if( o_rt_state.load() == XAUDIO_RT_PENDING )
+    {
+        int err = promote_thread( o_rt_priority );
+        o_rt_error = err;
+        o_rt_state = err == 0 ? XAUDIO_RT_GRANTED : XAUDIO_RT_DENIED;
+    }
+
     // check if callback
     if( !o_callback )
     {
@@ -95,13 +286,52 @@ int XAudioIO::cb( SAMPLE * outputBuffer, SAMPLE * inputBuffer,
         return 0;
     }
     
-    // copy
-    memcpy( o_input_buffer, inputBuffer, sizeof(SAMPLE)*numFrames*o_num_channels );
-    // call back
-    o_callback( o_input_buffer, numFrames, data );
-    // copy
-    memcpy( o_output_buffer, o_input_buffer, sizeof(SAMPLE)*numFrames*o_num_channels );
-    memcpy( outputBuffer, o_output_buffer, sizeof(SAMPLE)*numFrames*o_num_channels );
+    // no heap, no page faults from here (if XRTGuard is on)
+    XRTGuard::enter();
+
+    // capture device input (the one copy; readers never touch this thread)
+    if( o_capture && inputBuffer )
+        o_capture->put( inputBuffer, numFrames * o_num_input_channels );
+
+    // time it
+    long long start = now_ns();
+    // call back, straight into the device buffers (no copies)
+    o_callback( outputBuffer, o_num_input_channels ? inputBuffer : NULL,
+                numFrames, data );
+    long long duration = now_ns() - start;
+
+    // publish telemetry
+    XAudioTelemetry & t = g_telemetry;
+    long long period = (long long)numFrames * 1000000000LL / o_srate;
+    unsigned long seq = t.seq.load( std::memory_order_relaxed );
+    t.seq.store( seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    // start over on request
+    if( t.resetWorst.exchange( false, std::memory_order_relaxed ) ||
+        t.callbacks.load( std::memory_order_relaxed ) == 0 )
+    {
+        t.worst.store( 0, std::memory_order_relaxed );
+        t.worstMargin.store( period, std::memory_order_relaxed );
+    }
+    bump( t.callbacks );
+    if( g_status & RTAUDIO_OUTPUT_UNDERFLOW ) bump( t.underflows );
+    if( g_status & RTAUDIO_INPUT_OVERFLOW ) bump( t.overflows );
+    g_status = 0;
+    t.period.store( period, std::memory_order_relaxed );
+    t.last.store( duration, std::memory_order_relaxed );
+    if( duration > t.worst.load( std::memory_order_relaxed ) )
+        t.worst.store( duration, std::memory_order_relaxed );
+    if( period - duration < t.worstMargin.load( std::memory_order_relaxed ) )
+        t.worstMargin.store( period - duration, std::memory_order_relaxed );
+    // bucket by tenths of the period; last bucket == late
+    long bucket = period > 0 ? (long)( duration * 10 / period ) : 0;
+    if( duration > period ) bucket = XAUDIO_STATS_BUCKETS - 1;
+    else if( bucket > XAUDIO_STATS_BUCKETS - 2 ) bucket = XAUDIO_STATS_BUCKETS - 2;
+    bump( t.buckets[bucket] );
+    t.seq.store( seq + 2, std::memory_order_release );
+
+    // done
+    XRTGuard::leave();
 
     return 0;
 }
@@ -119,83 +349,134 @@ bool XAudioIO::init( unsigned int inputDevice,
                      unsigned int & frameSize,
                      unsigned int numChannels,
                      XAudioCallback cb,
-                     void * userData )
+                     void * userData,
+                     unsigned int numInputChannels )
 {
     // check if already init
-    if( o_audio != NULL )
+    if( o_audio != NULL || o_null_thread != NULL )
     {
         // error message
         cerr << "[x-audio]: already initialized..." << endl;
         return false;
     }
     
-    // instantiate rt audio
-    o_audio = new RtAudio();
-
-    // make param structs
-    RtAudio::StreamParameters iParams, oParams;
-
     // copy
     o_srate = srate;
     o_num_frames = frameSize;
     o_num_channels = numChannels;
+    o_num_input_channels = numInputChannels;
+    o_user_data = userData;
+
+    // open a device
+    if( o_null_mode != XAUDIO_NULL_OFF )
+    {
+        if( !openNull( userData ) ) return false;
+    }
+    else
+    {
+        if( !openRtAudio( userData ) )
+        {
+            // clean up
+            SAFE_DELETE( o_audio );
+            return false;
+        }
+    }
+    
+    // set the callback
+    o_callback = cb;
+    
+    // copy actual frame size
+    frameSize = o_num_frames;
+    // adapt() never goes below this
+    o_adapt_min = o_num_frames;
+    // capture ring (sized in time, so it survives reopen())
+    if( o_num_input_channels && o_capture_seconds > 0 )
+        o_capture = new XRingBuffer<SAMPLE>(
+            (long)( o_capture_seconds * o_srate ) * o_num_input_channels );
+    // the first callback shouldn't be the one to fault these in
+    XRTGuard::prefault( &g_telemetry, sizeof(g_telemetry) );
+    updateLatency();
+    // realtime gets sorted out on the first callback
+    // (never for null-fast: a busy SCHED_FIFO loop would starve the box)
+    o_rt_state = o_rt_priority > 0 && o_null_mode != XAUDIO_NULL_FAST ?
+                 XAUDIO_RT_PENDING : XAUDIO_RT_OFF;
 
-    inputDevice = o_audio->getDefaultInputDevice();
-    outputDevice = o_audio->getDefaultOutputDevice();
+    // log
+    cerr << "[x-audio]: " << apiName() << " | " << o_srate << " Hz | "
+         << o_num_frames << " frames";
+    if( o_num_buffers ) cerr << " x " << o_num_buffers << " buffers";
+    cerr << " | " << o_latency * 1000.0 / o_srate << " ms";
+    if( o_adapt_max > o_num_frames ) cerr << " | adaptive up to " << o_adapt_max;
+    cerr << endl;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: openRtAudio()
+// desc: open a stream on a real device
+//-----------------------------------------------------------------------------
+bool XAudioIO::openRtAudio( void * userData )
+{
+    // instantiate rt audio (once; reopen() reuses it)
+    if( o_audio == NULL )
+    {
+        o_audio = new RtAudio( (RtAudio::Api)o_api );
+        // RtAudio falls back to another backend if the requested one fails
+        if( o_api != RtAudio::UNSPECIFIED && o_audio->getCurrentApi() != o_api )
+        {
+            cerr << "[x-audio]: WARNING -- '" << api2name( o_api )
+                 << "' backend unavailable, using '" << apiName() << "'..." << endl;
+        }
+    }
+
+    // make param structs
+    RtAudio::StreamParameters iParams, oParams;
+    // stream options
+    RtAudio::StreamOptions options;
+    options.numberOfBuffers = o_num_buffers;
+    options.streamName = "ss";
+    if( o_rt_priority > 0 )
+    {
+        options.flags |= RTAUDIO_SCHEDULE_REALTIME;
+        options.priority = o_rt_priority;
+    }
 
     // first available device
-    iParams.deviceId = inputDevice;
-    iParams.nChannels = 1;
+    iParams.deviceId = o_audio->getDefaultInputDevice();
+    iParams.nChannels = o_num_input_channels;
     
     // first available device
-    oParams.deviceId = outputDevice;
+    oParams.deviceId = o_audio->getDefaultOutputDevice();
     oParams.nChannels = o_num_channels;
 
     try {
         // try to open stream
-        o_audio->openStream( &oParams, &iParams, RTAUDIO_FLOAT32,
-                             srate, &o_num_frames, &audio_callback, userData );
+        o_audio->openStream( &oParams, o_num_input_channels ? &iParams : NULL,
+                             RTAUDIO_FLOAT32, o_srate, &o_num_frames,
+                             &audio_callback, userData, &options );
     } catch ( RtError& e ) {
         try { // again
             // HACK: bump the oparams device id (on some systems, default in/out devices differ)
             oParams.deviceId++;
             // try to open stream
-            o_audio->openStream( &oParams, &iParams, RTAUDIO_FLOAT32,
-                                srate, &o_num_frames, &audio_callback, userData );
+            o_audio->openStream( &oParams, o_num_input_channels ? &iParams : NULL,
+                                 RTAUDIO_FLOAT32, o_srate, &o_num_frames,
+                                 &audio_callback, userData, &options );
         } catch( RtError & e ) {
             // error message
             cerr << "[x-audio]: cannot initialize real-time audio I/O..." << endl;
             cerr << "[x-audio]: | - " << e.getMessage() << endl;
-            // clean up
-            SAFE_DELETE( o_audio );
             // done
             return false;
         }
     }
-    
-    // allocate buffer
-    o_input_buffer = new SAMPLE[o_num_frames*numChannels];
-    o_output_buffer = new SAMPLE[o_num_frames*numChannels];
-    // check it
-    if( !o_input_buffer || !o_output_buffer )
-    {
-        // error
-        cerr << "[x-audio]: cannot allocate audio buffer(s)..." << endl;
-        // clean up
-        SAFE_DELETE_ARRAY( o_input_buffer );
-        SAFE_DELETE_ARRAY( o_output_buffer );
-        o_num_frames = 0;
-        // clean up
-        SAFE_DELETE( o_audio );
-        // done
-        return false;
-    }
 
-    // set the callback
-    o_callback = cb;
-    
-    // copy actual frame size
-    frameSize = o_num_frames;
+    // copy actual number of buffers (if the backend reports it)
+    o_num_buffers = options.numberOfBuffers;
 
     return true;
 }
@@ -204,26 +485,202 @@ bool XAudioIO::init( unsigned int inputDevice,
 
 
 //-----------------------------------------------------------------------------
-// name: start()
-// desc: start the real-time audio
+// name: openNull()
+// desc: set up the built-in null device
 //-----------------------------------------------------------------------------
-bool XAudioIO::start()
+bool XAudioIO::openNull( void * userData )
 {
+    // the "device" buffers; input is silence (reopen() replaces them)
+    SAFE_DELETE_ARRAY( o_null_output );
+    SAFE_DELETE_ARRAY( o_null_input );
+    o_null_output = new SAMPLE[o_num_frames*o_num_channels];
+    o_null_input = new SAMPLE[o_num_frames*(o_num_input_channels ? o_num_input_channels : 1)];
+    memset( o_null_output, 0, sizeof(SAMPLE)*o_num_frames*o_num_channels );
+    memset( o_null_input, 0, sizeof(SAMPLE)*o_num_frames*(o_num_input_channels ? o_num_input_channels : 1) );
+    // remember for the callback
+    o_user_data = userData;
+    // one period in flight
+    o_num_buffers = 1;
+    // the thread (started in start())
+    if( o_null_thread == NULL ) o_null_thread = new XThread();
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: null_thread()
+// desc: thread routine for the null device
+//-----------------------------------------------------------------------------
+static THREAD_RETURN THREAD_TYPE null_thread( void * data )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+    // stop() asks us to leave; never get cancelled mid-callback
+    pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL );
+#endif
+    // go
+    XAudioIO::nullLoop();
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sleep_until_ns()
+// desc: sleep until an absolute monotonic time
+//-----------------------------------------------------------------------------
+static void sleep_until_ns( long long deadline )
+{
+#if defined(__PLATFORM_LINUX__)
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000LL;
+    ts.tv_nsec = deadline % 1000000000LL;
+    while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL ) == EINTR ) { }
+#else
+    long long delta = deadline - now_ns();
+    if( delta <= 0 ) return;
+    struct timespec ts;
+    ts.tv_sec = delta / 1000000000LL;
+    ts.tv_nsec = delta % 1000000000LL;
+    nanosleep( &ts, NULL );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: nullLoop()
+// desc: null device loop (should not be used by client)
+//
+//   realtime: one callback per period on absolute wall-clock deadlines (no
+//             drift); a callback that finishes past its deadline is reported
+//             as an output underflow and the clock resyncs, like a device
+//             that dropped a buffer
+//   fast: back-to-back callbacks; stream time is simulated
+//-----------------------------------------------------------------------------
+void XAudioIO::nullLoop()
+{
+    // period in nanoseconds
+    long long period = (long long)o_num_frames * 1000000000LL / o_srate;
+    // frames elapsed (device clock)
+    unsigned long long frames = 0;
+    // next deadline
+    long long deadline = now_ns() + period;
+    // status for the next callback
+    RtAudioStreamStatus status = 0;
+
+    while( o_null_running.load() )
+    {
+        // call back through the same trampoline a device would use
+        audio_callback( o_null_output, o_null_input, o_num_frames,
+                        (double)frames / o_srate, status, o_user_data );
+        frames += o_num_frames;
+        status = 0;
+
+        // as fast as possible
+        if( o_null_mode == XAUDIO_NULL_FAST ) continue;
+
+        // missed the deadline?
+        long long now = now_ns();
+        if( now > deadline )
+        {
+            // xrun; drop the late period(s) and resync
+            status = RTAUDIO_OUTPUT_UNDERFLOW;
+            deadline = now + period;
+        }
+        else
+        {
+            // wait for the period to elapse
+            sleep_until_ns( deadline );
+            deadline += period;
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: startDevice()
+// desc: start the device (no reporting)
+//-----------------------------------------------------------------------------
+bool XAudioIO::startDevice()
+{
+    // null device
+    if( o_null_thread )
+    {
+        // already going?
+        if( o_null_running.load() ) return true;
+        // start the timer thread
+        o_null_running = true;
+        if( !o_null_thread->start( null_thread ) )
+        {
+            // error message
+            cerr << "[x-audio]: cannot start null audio device thread..." << endl;
+            o_null_running = false;
+            return false;
+        }
+    }
     // check flag
-    if( !o_audio )
+    else if( !o_audio )
     {
         cerr << "[x-audio]: trying to start uninitialized audio..." << endl;
         return false;
     }
+    else
+    {
+        try {
+            // try to start the stream
+            o_audio->startStream();
+        } catch ( RtError& e ) {
+            // error message
+            cerr << "[x-audio]: cannot start real-time audio I/O..." << endl;
+            cerr << "[x-audio]: | - " << e.getMessage() << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start()
+// desc: start the real-time audio
+//-----------------------------------------------------------------------------
+bool XAudioIO::start()
+{
+    // go
+    if( !startDevice() ) return false;
+
+    // give the first callback up to a second to sort out realtime
+    for( int i = 0; i < 100 && realtime() == XAUDIO_RT_PENDING; i++ )
+        usleep( 10000 );
     
-    try {
-        // try to start the stream
-        o_audio->startStream();
-    } catch ( RtError& e ) {
-        // error message
-        cerr << "[x-audio]: cannot start real-time audio I/O..." << endl;
-        cerr << "[x-audio]: | - " << e.getMessage() << endl;
-        return false;
+    // report
+    switch( realtime() )
+    {
+        case XAUDIO_RT_GRANTED:
+            cerr << "[x-audio]: callback thread is running realtime (SCHED_FIFO)" << endl;
+            break;
+        case XAUDIO_RT_DENIED:
+            cerr << "[x-audio]: WARNING -- realtime priority " << o_rt_priority
+                 << " NOT granted: " << strerror( o_rt_error ) << endl;
+            cerr << "[x-audio]: | - expect dropouts under load; grant CAP_SYS_NICE or" << endl;
+            cerr << "[x-audio]: | - an 'rtprio' limit (/etc/security/limits.conf)" << endl;
+            break;
+        case XAUDIO_RT_PENDING:
+            cerr << "[x-audio]: WARNING -- no callback yet, realtime priority unknown" << endl;
+            break;
+        default:
+            break;
     }
     
     return true;
@@ -238,6 +695,17 @@ bool XAudioIO::start()
 //-----------------------------------------------------------------------------
 void XAudioIO::stop()
 {
+    // null device
+    if( o_null_thread )
+    {
+        // ask the loop to finish its current callback, then join
+        if( o_null_running.exchange( false ) )
+            o_null_thread->wait();
+        // ready for another start()
+        o_null_thread->clear();
+        return;
+    }
+
     // check flag
     if( !o_audio )
     {
@@ -255,3 +723,307 @@ void XAudioIO::stop()
         cerr << "[x-audio]: | - " << e.getMessage() << endl;
     }
 }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: running()
+// desc: is the device running?
+//-----------------------------------------------------------------------------
+bool XAudioIO::running()
+{
+    if( o_null_thread ) return o_null_running.load();
+    return o_audio && o_audio->isStreamRunning();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: updateLatency()
+// desc: recompute output latency after (re)negotiation
+//-----------------------------------------------------------------------------
+void XAudioIO::updateLatency()
+{
+    // what the backend reports, if anything
+    long frames = 0;
+    if( o_audio && o_audio->isStreamOpen() )
+        frames = o_audio->getStreamLatency();
+    // otherwise one period per device buffer (double buffered by default)
+    if( frames <= 0 )
+        frames = o_num_frames * ( o_num_buffers ? o_num_buffers : 2 );
+
+    o_latency = (unsigned int)frames;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reopen()
+// desc: renegotiate the device buffer size (not from the audio thread);
+//       the callback sees the new size on its next call, so anything the
+//       client keeps (e.g., transport position) carries straight over
+//-----------------------------------------------------------------------------
+bool XAudioIO::reopen( unsigned int frameSize )
+{
+    // check
+    if( o_audio == NULL && o_null_thread == NULL )
+    {
+        cerr << "[x-audio]: trying to reopen uninitialized audio..." << endl;
+        return false;
+    }
+    // nothing to do
+    if( frameSize == o_num_frames ) return true;
+
+    // remember
+    bool wasRunning = running();
+    unsigned int oldFrames = o_num_frames;
+
+    // wait for the callback in flight to finish
+    if( wasRunning ) stop();
+
+    // new size
+    o_num_frames = frameSize;
+    if( o_null_thread )
+    {
+        // new buffers
+        openNull( o_user_data );
+    }
+    else
+    {
+        // close (rejoins the backend's callback thread)
+        o_audio->closeStream();
+        // open with the new size; fall back to the old one
+        if( !openRtAudio( o_user_data ) )
+        {
+            o_num_frames = oldFrames;
+            if( !openRtAudio( o_user_data ) )
+            {
+                // error message
+                cerr << "[x-audio]: cannot reopen real-time audio I/O..." << endl;
+                SAFE_DELETE( o_audio );
+                return false;
+            }
+        }
+    }
+
+    // new thread (RtAudio) or not, sort out realtime again
+    if( o_rt_state.load() != XAUDIO_RT_OFF ) o_rt_state = XAUDIO_RT_PENDING;
+    // new period, new worst case
+    resetWorst();
+    updateLatency();
+
+    // log
+    cerr << "[x-audio]: buffer " << oldFrames << " -> " << o_num_frames
+         << " frames | " << o_latency * 1000.0 / o_srate << " ms" << endl;
+
+    // resume
+    if( wasRunning && !startDevice() ) return false;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: adapt()
+// desc: watch xruns and grow/shrink the buffer (see setAdaptive()):
+//       XAUDIO_ADAPT_XRUNS within XAUDIO_ADAPT_WINDOW seconds doubles it (up
+//       to the max); XAUDIO_ADAPT_STABLE seconds without one halves it (down
+//       to the size asked for in init()); call from a non-audio thread
+//-----------------------------------------------------------------------------
+bool XAudioIO::adapt()
+{
+    // off
+    if( o_adapt_max <= o_adapt_min || !running() ) return false;
+
+    XAudioAdapt & a = g_adapt;
+    XAudioStats stats;
+    XAudioIO::stats( stats );
+    long long now = now_ns();
+    long long window = (long long)( XAUDIO_ADAPT_WINDOW * 1e9 );
+
+    // first look
+    if( a.windowStart == 0 )
+    {
+        a.lastXruns = stats.xruns;
+        a.windowStart = a.lastXrun = now;
+        return false;
+    }
+
+    // new xruns
+    unsigned long xruns = stats.xruns - a.lastXruns;
+    a.lastXruns = stats.xruns;
+    // settling after a change (restarting a stream can glitch by itself)
+    if( now < a.holdUntil ) return false;
+    // count within the window
+    if( now - a.windowStart > window )
+    {
+        a.windowStart = now;
+        a.windowXruns = 0;
+    }
+    if( xruns )
+    {
+        a.windowXruns += xruns;
+        a.lastXrun = now;
+    }
+
+    // pick a size
+    unsigned int frames = o_num_frames;
+    if( a.windowXruns >= XAUDIO_ADAPT_XRUNS && frames < o_adapt_max )
+        frames = frames * 2 < o_adapt_max ? frames * 2 : o_adapt_max;
+    else if( now - a.lastXrun > (long long)( XAUDIO_ADAPT_STABLE * 1e9 ) && frames > o_adapt_min )
+        frames = frames / 2 > o_adapt_min ? frames / 2 : o_adapt_min;
+    else
+        return false;
+
+    // renegotiate
+    unsigned int before = o_num_frames;
+    bool grow = frames > before;
+    if( !reopen( frames ) ) return false;
+
+    // the backend wouldn't budge (e.g., JACK owns the period); stop trying
+    if( grow && o_num_frames <= before )
+    {
+        cerr << "[x-audio]: backend keeps " << o_num_frames
+             << " frames; not adapting any further..." << endl;
+        o_adapt_max = o_adapt_min;
+    }
+
+    // start over
+    a.windowStart = a.lastXrun = now;
+    a.windowXruns = 0;
+    a.holdUntil = now + window;
+
+    return o_num_frames != before;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setApi()
+// desc: select audio backend by name
+//-----------------------------------------------------------------------------
+bool XAudioIO::setApi( const std::string & name )
+{
+    // built-in null device
+    if( name == "null" || name == "null-fast" )
+    {
+        o_null_mode = name == "null" ? XAUDIO_NULL_REALTIME : XAUDIO_NULL_FAST;
+        return true;
+    }
+    // a real device
+    o_null_mode = XAUDIO_NULL_OFF;
+
+    // compiled backends
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi( apis );
+
+    // look up
+    for( int i = 0; g_apiNames[i].name; i++ )
+    {
+        if( name != g_apiNames[i].name ) continue;
+        // check it's compiled in
+        for( size_t j = 0; j < apis.size(); j++ )
+        {
+            if( apis[j] == g_apiNames[i].api )
+            {
+                o_api = g_apiNames[i].api;
+                return true;
+            }
+        }
+        break;
+    }
+
+    // error message
+    cerr << "[x-audio]: audio backend '" << name << "' not available..." << endl;
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: apiName()
+// desc: get name of the backend in use
+//-----------------------------------------------------------------------------
+std::string XAudioIO::apiName()
+{
+    // built-in null device
+    if( o_null_mode != XAUDIO_NULL_OFF )
+        return o_null_mode == XAUDIO_NULL_REALTIME ? "null" : "null-fast";
+
+    return api2name( o_audio ? o_audio->getCurrentApi() : o_api );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: printApis()
+// desc: print the compiled backends
+//-----------------------------------------------------------------------------
+void XAudioIO::printApis()
+{
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi( apis );
+
+    cerr << "[x-audio]: compiled backends:";
+    for( size_t i = 0; i < apis.size(); i++ )
+        cerr << " " << api2name( apis[i] );
+    cerr << " null null-fast" << endl;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stats()
+// desc: get a consistent snapshot of audio thread health (lock-free;
+//       retries if the audio thread was mid-update)
+//-----------------------------------------------------------------------------
+void XAudioIO::stats( XAudioStats & out )
+{
+    XAudioTelemetry & t = g_telemetry;
+    unsigned long before, after;
+
+    do
+    {
+        before = t.seq.load( std::memory_order_acquire );
+        // writer busy
+        if( before & 1 ) continue;
+
+        // copy
+        out.callbacks = t.callbacks.load( std::memory_order_relaxed );
+        out.underflows = t.underflows.load( std::memory_order_relaxed );
+        out.overflows = t.overflows.load( std::memory_order_relaxed );
+        out.period = t.period.load( std::memory_order_relaxed ) / 1e9;
+        out.lastDuration = t.last.load( std::memory_order_relaxed ) / 1e9;
+        out.worstDuration = t.worst.load( std::memory_order_relaxed ) / 1e9;
+        out.worstMargin = t.worstMargin.load( std::memory_order_relaxed ) / 1e9;
+        for( int i = 0; i < XAUDIO_STATS_BUCKETS; i++ )
+            out.buckets[i] = t.buckets[i].load( std::memory_order_relaxed );
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+        after = t.seq.load( std::memory_order_relaxed );
+    } while( (before & 1) || before != after );
+
+    // total
+    out.xruns = out.underflows + out.overflows;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: resetWorst()
+// desc: reset worst-case duration/margin (applied on the next callback)
+//-----------------------------------------------------------------------------
+void XAudioIO::resetWorst()
+{
+    g_telemetry.resetWorst = true;
+}
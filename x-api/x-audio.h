@@ -39,6 +39,9 @@
 #define __MCD_X_AUDIO_H__
 
 #include "x-def.h"
+#include "x-buffer.h"
+#include <string>
+#include <atomic>
 
 
 
@@ -46,10 +49,62 @@
 // audio sample define
 typedef float SAMPLE;
 // typedef for audio callback function
-typedef void (* XAudioCallback)( SAMPLE * buffer, unsigned int numFrames, void * userData );
+//   output: the device output buffer (interleaved, numChannels() wide)
+//    input: read-only device input (interleaved, numInputChannels() wide), or NULL
+typedef void (* XAudioCallback)( SAMPLE * output, const SAMPLE * input,
+                                 unsigned int numFrames, void * userData );
 
 // forward reference
 class RtAudio;
+struct XThread;
+
+// callback duration histogram: one bucket per 10% of the period, plus
+// one for callbacks that blew the deadline
+#define XAUDIO_STATS_BUCKETS 11
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct XAudioStats
+// desc: snapshot of audio thread health (see XAudioIO::stats())
+//-----------------------------------------------------------------------------
+struct XAudioStats
+{
+    // number of callbacks
+    unsigned long callbacks;
+    // xruns reported by the device (underflows + overflows)
+    unsigned long xruns;
+    unsigned long underflows;
+    unsigned long overflows;
+    // period (deadline) of the last callback, in seconds
+    double period;
+    // duration of the last callback, in seconds
+    double lastDuration;
+    // longest callback since start/reset, in seconds
+    double worstDuration;
+    // smallest (period - duration) since start/reset; negative == late
+    double worstMargin;
+    // callback durations as fraction of the period
+    unsigned long buckets[XAUDIO_STATS_BUCKETS];
+};
+
+// realtime scheduling state of the callback thread
+enum XAudioRealtime
+{
+    XAUDIO_RT_OFF = 0,  // not requested
+    XAUDIO_RT_PENDING,  // requested, waiting for first callback
+    XAUDIO_RT_GRANTED,  // callback thread is running SCHED_FIFO/SCHED_RR
+    XAUDIO_RT_DENIED    // requested but the OS said no
+};
+
+// built-in null device (no hardware; callbacks driven by a timer thread)
+enum XAudioNullMode
+{
+    XAUDIO_NULL_OFF = 0,  // use a real device
+    XAUDIO_NULL_REALTIME, // paced by the wall clock, one buffer per period
+    XAUDIO_NULL_FAST      // simulated clock, as fast as possible
+};
 
 
 
@@ -68,33 +123,113 @@ public:
                       unsigned int & frameSize,
                       unsigned int numChannels,
                       XAudioCallback cb,
-                      void * userData );
+                      void * userData,
+                      unsigned int numInputChannels = 1 );
     // start the real-time audio
     static bool start();
     // stop the real-time audio
     static void stop();
-    
+    // renegotiate the device buffer size (not from the audio thread);
+    // stops at a callback boundary, reopens, and resumes if running
+    static bool reopen( unsigned int frameSize );
+    // watch xruns and grow/shrink the buffer (see setAdaptive()); call
+    // periodically from a non-audio thread; returns true if it changed
+    static bool adapt();
+
+public: // options (set these before init)
+    // select audio backend by name: "alsa", "jack", "oss", "core", "dummy",
+    // or the built-in "null" (realtime paced) / "null-fast" devices
+    // (returns false if that backend is not compiled in)
+    static bool setApi( const std::string & name );
+    // use the built-in null device (same as setApi( "null" / "null-fast" ))
+    static void setNullMode( XAudioNullMode mode ) { o_null_mode = mode; }
+    // number of device buffers/periods (0 == backend default)
+    static void setNumBuffers( unsigned int num ) { o_num_buffers = num; }
+    // request SCHED_FIFO for the callback thread (0 == don't)
+    static void setRealtimePriority( int priority ) { o_rt_priority = priority; }
+    // seconds of device input to keep in the capture ring (0 == none)
+    static void setCapture( float seconds ) { o_capture_seconds = seconds; }
+    // let adapt() grow the buffer up to maxFrames on xruns (0 == fixed size);
+    // it never goes below the frame size requested in init()
+    static void setAdaptive( unsigned int maxFrames ) { o_adapt_max = maxFrames; }
+    // print the compiled backends
+    static void printApis();
+
 public:
     // get sample rate
     static unsigned int srate() { return o_srate; }
     // get number of channels
     static unsigned int numChannels() { return o_num_channels; }
+    // get number of input channels (0 if no input)
+    static unsigned int numInputChannels() { return o_num_input_channels; }
     // get framesize
     static unsigned int framesize() { return o_num_frames; }
+    // get number of device buffers/periods (as negotiated)
+    static unsigned int numBuffers() { return o_num_buffers; }
+    // get output latency in frames (rendered but not yet heard)
+    static unsigned int latency() { return o_latency; }
+    // get the capture ring: device input, interleaved numInputChannels()
+    // wide, written by the audio thread only (NULL if no input/capture)
+    static XRingBuffer<SAMPLE> * capture() { return o_capture; }
+    // get name of the backend in use
+    static std::string apiName();
+    // get requested realtime priority (0 == none)
+    static int realtimePriority() { return o_rt_priority; }
+    // get realtime scheduling state of the callback thread
+    static XAudioRealtime realtime() { return (XAudioRealtime)o_rt_state.load(); }
+    // get a consistent snapshot of audio thread health (lock-free)
+    static void stats( XAudioStats & out );
+    // reset worst-case duration/margin
+    static void resetWorst();
     
 public:
     // internal callback (should not be used by client)
     static int cb( SAMPLE * outputBuffer, SAMPLE * inputBuffer,
                    unsigned int numFrames, double streamTime, void * data );
+    // null device loop (should not be used by client)
+    static void nullLoop();
+
+protected:
+    // open a stream on a real device
+    static bool openRtAudio( void * userData );
+    // set up the built-in null device
+    static bool openNull( void * userData );
+    // start the device (no reporting)
+    static bool startDevice();
+    // is the device running?
+    static bool running();
+    // recompute latency after (re)negotiation
+    static void updateLatency();
     
 protected:
     static RtAudio * o_audio;
     static XAudioCallback o_callback;
-    static SAMPLE * o_input_buffer;
-    static SAMPLE * o_output_buffer;
     static unsigned int o_num_frames;
     static unsigned int o_num_channels;
+    static unsigned int o_num_input_channels;
     static unsigned int o_srate;
+    static unsigned int o_num_buffers;
+    static unsigned int o_latency;
+    static int o_api;
+    static int o_rt_priority;
+    static std::atomic<int> o_rt_state;
+    static std::atomic<int> o_rt_error;
+
+protected: // input capture
+    static float o_capture_seconds;
+    static XRingBuffer<SAMPLE> * o_capture;
+
+protected: // adaptive buffer size
+    static unsigned int o_adapt_min;
+    static unsigned int o_adapt_max;
+
+protected: // null device
+    static int o_null_mode;
+    static void * o_user_data;
+    static SAMPLE * o_null_output;
+    static SAMPLE * o_null_input;
+    static XThread * o_null_thread;
+    static std::atomic<bool> o_null_running;
 };
 
 
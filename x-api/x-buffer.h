@@ -30,7 +30,8 @@
 
 //-----------------------------------------------------------------------------
 // name: x-buffer.h
-// desc: templated simple circular buffer
+// desc: templated simple circular buffer, and a lock-free ring for
+//       handing audio off between threads
 //
 // authors: Ge Wang (ge@ccrma.stanford.edu)
 //    date: Spring 2012
@@ -40,6 +41,7 @@
 #define __MCD_X_BUFFER_H__
 
 #include <iostream>
+#include <atomic>
 
 
 
@@ -384,4 +386,344 @@ long XCircleBuffer<T>::pop( long numItems )
 
 
 
+//-----------------------------------------------------------------------------
+// name: class XRingBuffer
+// desc: lock-free ring with XCircleBuffer semantics (over capacity discards
+//       the least recently put items) for one writer thread and any number
+//       of reader threads; each reader owns a cursor, so nobody waits on
+//       anybody, and a reader that falls behind skips ahead
+//-----------------------------------------------------------------------------
+template <typename T>
+class XRingBuffer
+{
+public:
+    XRingBuffer( long length = 0 );
+    ~XRingBuffer();
+
+public:
+    // reset capacity, rounded up to a power of 2 (not while in use)
+    void init( long length );
+    // get length (capacity)
+    long length() const { return m_length; }
+
+public: // writer (one thread)
+    // put items - they will be copied
+    void put( const T * items, long numItems );
+    // total number of items ever put (the write cursor)
+    unsigned long long written() const { return m_write.load( std::memory_order_acquire ); }
+
+public: // readers (each with its own cursor)
+    // get up to numItems starting at cursor, and advance it; if the writer
+    // lapped the cursor, skips ahead to the oldest intact item
+    long get( unsigned long long & cursor, T * array, long numItems );
+    // get the most recent numItems (oldest first) - returns number returned
+    long peek( T * array, long numItems );
+
+protected:
+    // the buffer
+    T * m_buffer;
+    // the buffer length (capacity, power of 2)
+    long m_length;
+    // items the writer has finished
+    std::atomic<unsigned long long> m_write;
+    // items the writer has started (>= m_write)
+    std::atomic<unsigned long long> m_claim;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: XRingBuffer()
+// desc: constructor
+//-----------------------------------------------------------------------------
+template <typename T>
+XRingBuffer<T>::XRingBuffer( long length )
+    : m_buffer( NULL ), m_length( 0 ), m_write( 0 ), m_claim( 0 )
+{
+    // call init
+    this->init( length );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~XRingBuffer
+// desc: destructor
+//-----------------------------------------------------------------------------
+template <typename T>
+XRingBuffer<T>::~XRingBuffer()
+{
+    SAFE_DELETE_ARRAY( m_buffer );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: init()
+// desc: reset capacity (rounded up to a power of 2)
+//-----------------------------------------------------------------------------
+template <typename T>
+void XRingBuffer<T>::init( long length )
+{
+    // clean up
+    SAFE_DELETE_ARRAY( m_buffer );
+    m_length = 0;
+    m_write = m_claim = 0;
+
+    // check for zero length
+    if( length <= 0 ) return;
+
+    // round up (cursors map to slots with a mask)
+    long size = 1;
+    while( size < length ) size <<= 1;
+
+    // allocate (zeroed, so the writer never faults on a fresh page)
+    m_buffer = new T[size]();
+    m_length = size;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: put()
+// desc: put items (writer thread only); never blocks
+//-----------------------------------------------------------------------------
+template <typename T>
+void XRingBuffer<T>::put( const T * items, long numItems )
+{
+    // sanity check
+    if( m_buffer == NULL || numItems <= 0 ) return;
+
+    unsigned long long w = m_write.load( std::memory_order_relaxed );
+    unsigned long long end = w + numItems;
+    // only the last m_length items survive anyway
+    if( numItems > m_length )
+    {
+        items += numItems - m_length;
+        w = end - m_length;
+    }
+
+    // claim before touching any slot, so readers can tell what got clobbered
+    m_claim.store( end, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    // copy (at most two runs)
+    long mask = m_length - 1;
+    for( ; w < end; w++ )
+        m_buffer[w & mask] = *items++;
+
+    // publish
+    m_write.store( end, std::memory_order_release );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get()
+// desc: get up to numItems from cursor, and advance it (reader's own thread)
+//-----------------------------------------------------------------------------
+template <typename T>
+long XRingBuffer<T>::get( unsigned long long & cursor, T * array, long numItems )
+{
+    // sanity check
+    if( m_buffer == NULL || numItems <= 0 ) return 0;
+
+    unsigned long long w = m_write.load( std::memory_order_acquire );
+    // cursor from some other life (e.g., before init)
+    if( cursor > w ) cursor = w;
+    // lapped: skip ahead to the oldest item still there
+    if( w - cursor > (unsigned long long)m_length ) cursor = w - m_length;
+
+    // how many
+    long count = (long)( w - cursor );
+    if( count > numItems ) count = numItems;
+
+    // copy
+    long mask = m_length - 1;
+    for( long i = 0; i < count; i++ )
+        array[i] = m_buffer[(cursor + i) & mask];
+
+    // did the writer get to any of that while we were copying?
+    std::atomic_thread_fence( std::memory_order_acquire );
+    unsigned long long claim = m_claim.load( std::memory_order_relaxed );
+    if( claim > (unsigned long long)m_length && cursor < claim - m_length )
+    {
+        // drop the clobbered (oldest) part
+        long torn = (long)( claim - m_length - cursor );
+        if( torn > count ) torn = count;
+        for( long i = torn; i < count; i++ )
+            array[i-torn] = array[i];
+        count -= torn;
+        cursor += torn;
+    }
+
+    // advance
+    cursor += count;
+
+    return count;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: peek()
+// desc: get the most recent numItems (oldest first), without a cursor
+//-----------------------------------------------------------------------------
+template <typename T>
+long XRingBuffer<T>::peek( T * array, long numItems )
+{
+    // start numItems back from the writer
+    unsigned long long w = m_write.load( std::memory_order_acquire );
+    unsigned long long cursor = w > (unsigned long long)numItems ? w - numItems : 0;
+
+    return get( cursor, array, numItems );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class XTripleBuffer
+// desc: latest-value handoff of a block of T (e.g., an analysis frame) from
+//       one writer thread to one reader thread: the writer fills its own
+//       slot and swaps it with the middle one; the reader swaps the middle
+//       one with its own when there's something new; nobody ever waits
+//-----------------------------------------------------------------------------
+template <typename T>
+class XTripleBuffer
+{
+public:
+    XTripleBuffer( long length = 0 );
+    ~XTripleBuffer();
+
+public:
+    // reset to 3 blocks of length (zeroed; not while in use)
+    void init( long length );
+    // block length
+    long length() const { return m_length; }
+
+public: // writer
+    // the block to fill
+    T * back() { return m_slots[m_back]; }
+    // hand it over (the reader gets this one next, unless a newer one comes)
+    void publish();
+
+public: // reader
+    // the newest block published (or the last one read, if nothing's new);
+    // valid until the next call
+    const T * front();
+    // has anything been published since the last front()?
+    bool fresh() const { return ( m_middle.load( std::memory_order_acquire ) & XTRIPLE_FRESH ) != 0; }
+
+protected:
+    // middle slot index, plus a bit: published, not yet read
+    enum { XTRIPLE_FRESH = 4 };
+
+    T * m_slots[3];
+    long m_length;
+    // writer's, reader's
+    int m_back;
+    int m_front;
+    // in between
+    std::atomic<int> m_middle;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: XTripleBuffer()
+// desc: constructor
+//-----------------------------------------------------------------------------
+template <typename T>
+XTripleBuffer<T>::XTripleBuffer( long length )
+    : m_length( 0 ), m_back( 0 ), m_front( 1 ), m_middle( 2 )
+{
+    m_slots[0] = m_slots[1] = m_slots[2] = NULL;
+    // call init
+    this->init( length );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~XTripleBuffer()
+// desc: destructor
+//-----------------------------------------------------------------------------
+template <typename T>
+XTripleBuffer<T>::~XTripleBuffer()
+{
+    for( int i = 0; i < 3; i++ )
+        SAFE_DELETE_ARRAY( m_slots[i] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: init()
+// desc: reset to 3 blocks of length
+//-----------------------------------------------------------------------------
+template <typename T>
+void XTripleBuffer<T>::init( long length )
+{
+    // clean up
+    for( int i = 0; i < 3; i++ )
+        SAFE_DELETE_ARRAY( m_slots[i] );
+    m_length = 0;
+    m_back = 0;
+    m_front = 1;
+    m_middle = 2;
+
+    // check for zero length
+    if( length <= 0 ) return;
+
+    for( int i = 0; i < 3; i++ )
+        m_slots[i] = new T[length]();
+    m_length = length;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: publish()
+// desc: swap the filled block into the middle (writer)
+//-----------------------------------------------------------------------------
+template <typename T>
+void XTripleBuffer<T>::publish()
+{
+    int old = m_middle.exchange( m_back | XTRIPLE_FRESH, std::memory_order_acq_rel );
+    m_back = old & ~XTRIPLE_FRESH;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: front()
+// desc: take the middle block if it's new (reader)
+//-----------------------------------------------------------------------------
+template <typename T>
+const T * XTripleBuffer<T>::front()
+{
+    if( fresh() )
+    {
+        int old = m_middle.exchange( m_front, std::memory_order_acq_rel );
+        m_front = old & ~XTRIPLE_FRESH;
+    }
+
+    return m_slots[m_front];
+}
+
+
+
+
 #endif
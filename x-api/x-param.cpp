@@ -0,0 +1,212 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-param.cpp
+// desc: parameter registry
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "x-param.h"
+#include <math.h>
+#include <stdio.h>
+
+
+
+
+// static
+XParams::Param XParams::o_params[XPARAMS_MAX];
+std::atomic<int> XParams::o_count( 0 );
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: add()
+// desc: register a parameter (filled in before it's published)
+//-----------------------------------------------------------------------------
+int XParams::add( const std::string & name, float value, float min, float max,
+                  XParamSmoothing smoothing, float time )
+{
+    int id = o_count.load();
+    // full
+    if( id >= XPARAMS_MAX ) return -1;
+
+    Param & p = o_params[id];
+    p.name = name;
+    p.min = min;
+    p.max = max;
+    p.smoothing = time > 0 ? smoothing : XPARAM_STEP;
+    p.time = time;
+    // clamp
+    if( value < min ) value = min;
+    else if( value > max ) value = max;
+    p.target = value;
+    p.start = p.end = value;
+    p.inc = 0;
+    // publish
+    o_count.store( id + 1, std::memory_order_release );
+
+    return id;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: find()
+// desc: find by name
+//-----------------------------------------------------------------------------
+int XParams::find( const std::string & name )
+{
+    int count = o_count.load( std::memory_order_acquire );
+    for( int i = 0; i < count; i++ )
+        if( o_params[i].name == name ) return i;
+    return -1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: print()
+// desc: print them all
+//-----------------------------------------------------------------------------
+void XParams::print()
+{
+    static const char * smoothing[] = { "step", "linear", "slew" };
+    int count = o_count.load( std::memory_order_acquire );
+    for( int i = 0; i < count; i++ )
+    {
+        const Param & p = o_params[i];
+        fprintf( stderr, "[x-param]: %-16s %8.3f  [%g, %g] %s",
+                 p.name.c_str(), p.target.load(), p.min, p.max, smoothing[p.smoothing] );
+        if( p.smoothing != XPARAM_STEP ) fprintf( stderr, " %gs", p.time );
+        fprintf( stderr, "\n" );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set()
+// desc: set target (control side)
+//-----------------------------------------------------------------------------
+void XParams::set( int id, float value )
+{
+    // sanity check
+    if( id < 0 || id >= o_count.load( std::memory_order_acquire ) ) return;
+
+    Param & p = o_params[id];
+    // clamp
+    if( value < p.min ) value = p.min;
+    else if( value > p.max ) value = p.max;
+    p.target.store( value, std::memory_order_relaxed );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set()
+// desc: set target by name
+//-----------------------------------------------------------------------------
+bool XParams::set( const std::string & name, float value )
+{
+    int id = find( name );
+    if( id < 0 ) return false;
+    set( id, value );
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: target()
+// desc: get target (control side)
+//-----------------------------------------------------------------------------
+float XParams::target( int id )
+{
+    // sanity check
+    if( id < 0 || id >= o_count.load( std::memory_order_acquire ) ) return 0;
+
+    return o_params[id].target.load( std::memory_order_relaxed );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: block()
+// desc: pick up targets and smooth, once per block (audio thread)
+//-----------------------------------------------------------------------------
+void XParams::block( unsigned int numFrames, float srate )
+{
+    // sanity check
+    if( numFrames == 0 ) return;
+
+    int count = o_count.load( std::memory_order_acquire );
+    for( int i = 0; i < count; i++ )
+    {
+        Param & p = o_params[i];
+        float goal = p.target.load( std::memory_order_relaxed );
+        float v = p.end;
+        p.start = v;
+
+        if( v != goal )
+        {
+            switch( p.smoothing )
+            {
+                case XPARAM_STEP:
+                    v = goal;
+                    break;
+                case XPARAM_LINEAR:
+                {
+                    // the full range in time seconds
+                    float step = ( p.max - p.min ) * numFrames / ( p.time * srate );
+                    if( fabsf( goal - v ) <= step ) v = goal;
+                    else v += goal > v ? step : -step;
+                    break;
+                }
+                case XPARAM_SLEW:
+                    v = goal + ( v - goal ) * expf( -(float)numFrames / ( p.time * srate ) );
+                    // close enough
+                    if( fabsf( v - goal ) < 1e-6f * ( p.max - p.min ) ) v = goal;
+                    break;
+            }
+        }
+
+        p.end = v;
+        p.inc = ( v - p.start ) / numFrames;
+    }
+}
@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-param.h
+// desc: parameter registry: the one path for control changes from the UI
+//       (or any non-audio thread) to the audio thread; each parameter is
+//       an atomic target, picked up and smoothed once per block
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_X_PARAM_H__
+#define __MCD_X_PARAM_H__
+
+#include "x-def.h"
+#include <string>
+#include <atomic>
+
+// most parameters
+#define XPARAMS_MAX 64
+
+// how a parameter gets from its old value to a new target
+enum XParamSmoothing
+{
+    XPARAM_STEP = 0,    // jump, at the next block
+    XPARAM_LINEAR,      // ramp at a fixed rate: the full range in time seconds
+    XPARAM_SLEW         // exponential approach, time seconds per 1/e
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class XParams
+// desc: static parameter registry
+//-----------------------------------------------------------------------------
+class XParams
+{
+public: // setup (any thread; no allocation once registered)
+    // register a parameter; returns its id (-1 if full)
+    static int add( const std::string & name, float value, float min, float max,
+                    XParamSmoothing smoothing = XPARAM_STEP, float time = 0 );
+    // find by name (-1 if none)
+    static int find( const std::string & name );
+    // print them all
+    static void print();
+
+public: // control side (UI)
+    // set target (clamped); lock-free
+    static void set( int id, float value );
+    // set by name
+    static bool set( const std::string & name, float value );
+    // get target
+    static float target( int id );
+
+public: // audio side (one thread)
+    // pick up targets and advance smoothing by one block
+    static void block( unsigned int numFrames, float srate );
+    // value at the end of this block
+    static float value( int id ) { return o_params[id].end; }
+    // this block's ramp: value at its start, and per-frame step
+    static void ramp( int id, float & start, float & inc )
+    { start = o_params[id].start; inc = o_params[id].inc; }
+    // did it move in this block?
+    static bool changed( int id ) { return o_params[id].start != o_params[id].end; }
+
+protected:
+    // a parameter
+    struct Param
+    {
+        // fixed at add()
+        std::string name;
+        float min;
+        float max;
+        XParamSmoothing smoothing;
+        float time;
+        // written by control, read by audio
+        std::atomic<float> target;
+        // audio side: this block
+        float start;
+        float end;
+        float inc;
+    };
+
+    static Param o_params[XPARAMS_MAX];
+    static std::atomic<int> o_count;
+};
+
+
+
+
+#endif
@@ -0,0 +1,516 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-rtguard.cpp
+// desc: real-time safety guard (debug)
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "x-rtguard.h"
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+#include <alloca.h>
+#include <execinfo.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+using namespace std;
+
+// glibc: interpose malloc & co. too (catches C libraries, e.g., FluidSynth);
+// elsewhere only new/delete are caught
+#if defined(__PLATFORM_LINUX__) && defined(__GLIBC__)
+#define XRT_GUARD_MALLOC
+extern "C" {
+void * __libc_malloc( size_t size );
+void * __libc_calloc( size_t num, size_t size );
+void * __libc_realloc( void * ptr, size_t size );
+void __libc_free( void * ptr );
+}
+#define XRT_RAW_MALLOC __libc_malloc
+#define XRT_RAW_FREE __libc_free
+#else
+#define XRT_RAW_MALLOC malloc
+#define XRT_RAW_FREE free
+#endif
+
+
+
+
+// mode
+static std::atomic<int> g_mode( XRT_GUARD_OFF );
+// counts
+static std::atomic<unsigned long> g_counts[XRT_NUM_VIOLATIONS];
+static std::atomic<unsigned long> g_sections( 0 );
+// call sites (first come, first kept)
+static std::atomic<void *> g_sites[XRT_GUARD_SITES];
+static std::atomic<unsigned long> g_siteCounts[XRT_GUARD_SITES];
+static std::atomic<int> g_siteKinds[XRT_GUARD_SITES];
+// names
+static const char * g_kindNames[XRT_NUM_VIOLATIONS] =
+    { "allocation", "free", "page fault" };
+
+// per thread: in a guarded section?
+static thread_local int t_inside = 0;
+// per thread: stack warmed?
+static thread_local bool t_warm = false;
+// per thread: page faults at enter()
+static thread_local long t_faults = 0;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: thread_faults()
+// desc: page faults (minor + major) so far on the calling thread
+//-----------------------------------------------------------------------------
+static long thread_faults()
+{
+#if defined(__PLATFORM_LINUX__)
+    struct rusage ru;
+    if( getrusage( RUSAGE_THREAD, &ru ) == 0 )
+        return ru.ru_minflt + ru.ru_majflt;
+#endif
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: record()
+// desc: count a violation, and remember where (allocation-free)
+//-----------------------------------------------------------------------------
+static void record( int kind, void * caller, unsigned long n )
+{
+    g_counts[kind].fetch_add( n, std::memory_order_relaxed );
+    // no site (e.g., page faults)
+    if( caller == NULL ) return;
+
+    // find or claim a slot
+    for( int i = 0; i < XRT_GUARD_SITES; i++ )
+    {
+        void * site = g_sites[i].load( std::memory_order_acquire );
+        if( site == NULL )
+        {
+            void * expected = NULL;
+            if( g_sites[i].compare_exchange_strong( expected, caller ) )
+            {
+                g_siteKinds[i] = kind;
+                site = caller;
+            }
+            else site = expected;
+        }
+        if( site == caller )
+        {
+            g_siteCounts[i].fetch_add( n, std::memory_order_relaxed );
+            return;
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: die()
+// desc: print the violation and the stack, then abort (no heap)
+//-----------------------------------------------------------------------------
+static void die( int kind, void * caller )
+{
+    char msg[128];
+    int len = snprintf( msg, sizeof(msg),
+        "[x-rtguard]: %s in a real-time section (caller %p); aborting...\n",
+        g_kindNames[kind], caller );
+    if( write( 2, msg, len ) < 0 ) { }
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+    void * frames[64];
+    int n = backtrace( frames, 64 );
+    backtrace_symbols_fd( frames, n, 2 );
+#endif
+    abort();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setMode()
+// desc: set mode (before the audio starts)
+//-----------------------------------------------------------------------------
+void XRTGuard::setMode( XRTGuardMode mode )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+    // the first backtrace() can load libgcc (and allocate); get it over with
+    void * frame[1];
+    backtrace( frame, 1 );
+#endif
+    g_mode = mode;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setMode()
+// desc: set mode by name
+//-----------------------------------------------------------------------------
+bool XRTGuard::setMode( const std::string & name )
+{
+    if( name == "off" ) setMode( XRT_GUARD_OFF );
+    else if( name == "record" ) setMode( XRT_GUARD_RECORD );
+    else if( name == "abort" ) setMode( XRT_GUARD_ABORT );
+    else
+    {
+        // error message
+        cerr << "[x-rtguard]: unknown mode '" << name << "' (off, record, abort)..." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: mode()
+// desc: get mode
+//-----------------------------------------------------------------------------
+XRTGuardMode XRTGuard::mode()
+{
+    return (XRTGuardMode)g_mode.load( std::memory_order_relaxed );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lockMemory()
+// desc: lock all current and future pages into RAM (no paging, ever)
+//-----------------------------------------------------------------------------
+bool XRTGuard::lockMemory()
+{
+#if defined(__PLATFORM_LINUX__)
+    if( mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 )
+    {
+        // error message
+        cerr << "[x-rtguard]: WARNING -- cannot lock memory: " << strerror( errno ) << endl;
+        cerr << "[x-rtguard]: | - raise the 'memlock' limit (ulimit -l, or" << endl;
+        cerr << "[x-rtguard]: | - /etc/security/limits.conf)" << endl;
+        return false;
+    }
+    cerr << "[x-rtguard]: memory locked" << endl;
+    return true;
+#else
+    cerr << "[x-rtguard]: memory locking not supported on this platform..." << endl;
+    return false;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: prefault()
+// desc: touch every page of a buffer (writes back what's there, so the page
+//       is really mapped, not just the shared zero page)
+//-----------------------------------------------------------------------------
+void XRTGuard::prefault( void * buffer, size_t bytes )
+{
+    // sanity check
+    if( buffer == NULL || bytes == 0 ) return;
+
+    long page = sysconf( _SC_PAGESIZE );
+    volatile char * p = (volatile char *)buffer;
+    for( size_t i = 0; i < bytes; i += page )
+        p[i] = p[i];
+    // the last page
+    p[bytes-1] = p[bytes-1];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: prefaultStack()
+// desc: touch the calling thread's stack
+//-----------------------------------------------------------------------------
+void XRTGuard::prefaultStack( size_t bytes )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+    long page = sysconf( _SC_PAGESIZE );
+    volatile char * stack = (volatile char *)alloca( bytes );
+    for( size_t i = 0; i < bytes; i += page )
+        stack[i] = 0;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: enter()
+// desc: enter a guarded section on this thread
+//-----------------------------------------------------------------------------
+void XRTGuard::enter()
+{
+    // off
+    if( g_mode.load( std::memory_order_relaxed ) == XRT_GUARD_OFF ) return;
+
+    // first time on this thread (e.g., a new audio thread after reopen)
+    if( !t_warm )
+    {
+        prefaultStack();
+        t_warm = true;
+    }
+
+    // count
+    g_sections.store( g_sections.load( std::memory_order_relaxed ) + 1,
+                      std::memory_order_relaxed );
+    // faults so far
+    t_faults = thread_faults();
+    // in
+    t_inside = 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: leave()
+// desc: leave a guarded section (checks for page faults since enter())
+//-----------------------------------------------------------------------------
+void XRTGuard::leave()
+{
+    // not in one
+    if( !t_inside ) return;
+    // out
+    t_inside = 0;
+
+    // faulted?
+    long faults = thread_faults() - t_faults;
+    if( faults > 0 )
+    {
+        record( XRT_FAULT, NULL, faults );
+        if( mode() == XRT_GUARD_ABORT ) die( XRT_FAULT, NULL );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: inside()
+// desc: is this thread in a guarded section?
+//-----------------------------------------------------------------------------
+bool XRTGuard::inside()
+{
+    return t_inside != 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: violation()
+// desc: report one (allocation-free)
+//-----------------------------------------------------------------------------
+void XRTGuard::violation( XRTViolation kind, void * caller )
+{
+    // no recursion (e.g., if something below allocates)
+    int wasInside = t_inside;
+    t_inside = 0;
+
+    // count it
+    record( kind, caller, 1 );
+    // or not
+    if( mode() == XRT_GUARD_ABORT ) die( kind, caller );
+
+    t_inside = wasInside;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stats()
+// desc: get counts
+//-----------------------------------------------------------------------------
+void XRTGuard::stats( XRTGuardStats & out )
+{
+    for( int i = 0; i < XRT_NUM_VIOLATIONS; i++ )
+        out.counts[i] = g_counts[i].load( std::memory_order_relaxed );
+    out.sections = g_sections.load( std::memory_order_relaxed );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: report()
+// desc: print counts and call sites (not from a guarded section)
+//-----------------------------------------------------------------------------
+void XRTGuard::report()
+{
+    // off
+    if( mode() == XRT_GUARD_OFF ) return;
+
+    XRTGuardStats s;
+    stats( s );
+    cerr << "[x-rtguard]: " << s.sections << " real-time sections | "
+         << s.counts[XRT_ALLOC] << " allocations | "
+         << s.counts[XRT_FREE] << " frees | "
+         << s.counts[XRT_FAULT] << " page faults" << endl;
+
+    // call sites
+    for( int i = 0; i < XRT_GUARD_SITES; i++ )
+    {
+        void * site = g_sites[i].load();
+        if( site == NULL ) break;
+        cerr << "[x-rtguard]: | - " << g_siteCounts[i].load() << " x "
+             << g_kindNames[g_siteKinds[i].load()] << " at: " << flush;
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) )
+        backtrace_symbols_fd( &site, 1, 2 );
+#else
+        cerr << site << endl;
+#endif
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// allocator interposition: checks one thread-local flag, then does the real
+// thing; violations only ever happen inside a guarded section
+//-----------------------------------------------------------------------------
+#define XRT_CHECK( kind ) \
+    do { if( t_inside ) XRTGuard::violation( kind, __builtin_return_address(0) ); } while(0)
+
+#if defined(XRT_GUARD_MALLOC)
+extern "C" void * malloc( size_t size )
+{
+    XRT_CHECK( XRT_ALLOC );
+    return __libc_malloc( size );
+}
+
+extern "C" void * calloc( size_t num, size_t size )
+{
+    XRT_CHECK( XRT_ALLOC );
+    return __libc_calloc( num, size );
+}
+
+extern "C" void * realloc( void * ptr, size_t size )
+{
+    XRT_CHECK( XRT_ALLOC );
+    return __libc_realloc( ptr, size );
+}
+
+extern "C" void free( void * ptr )
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    __libc_free( ptr );
+}
+#endif
+
+void * operator new( size_t size )
+{
+    XRT_CHECK( XRT_ALLOC );
+    void * ptr = XRT_RAW_MALLOC( size ? size : 1 );
+    if( ptr == NULL ) throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new[]( size_t size )
+{
+    XRT_CHECK( XRT_ALLOC );
+    void * ptr = XRT_RAW_MALLOC( size ? size : 1 );
+    if( ptr == NULL ) throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new( size_t size, const std::nothrow_t & ) noexcept
+{
+    XRT_CHECK( XRT_ALLOC );
+    return XRT_RAW_MALLOC( size ? size : 1 );
+}
+
+void * operator new[]( size_t size, const std::nothrow_t & ) noexcept
+{
+    XRT_CHECK( XRT_ALLOC );
+    return XRT_RAW_MALLOC( size ? size : 1 );
+}
+
+void operator delete( void * ptr ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+
+void operator delete[]( void * ptr ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+
+void operator delete( void * ptr, const std::nothrow_t & ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+
+void operator delete[]( void * ptr, const std::nothrow_t & ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+
+#if __cplusplus >= 201402L
+void operator delete( void * ptr, size_t ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+
+void operator delete[]( void * ptr, size_t ) noexcept
+{
+    if( ptr ) XRT_CHECK( XRT_FREE );
+    XRT_RAW_FREE( ptr );
+}
+#endif
@@ -0,0 +1,132 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-rtguard.h
+// desc: real-time safety guard (debug): catches heap use and page faults
+//       inside guarded sections (i.e., the audio callback), and locks /
+//       pre-faults memory so they don't happen in the first place
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_X_RTGUARD_H__
+#define __MCD_X_RTGUARD_H__
+
+#include "x-def.h"
+#include <string>
+#include <stddef.h>
+
+
+
+
+// how many distinct call sites to remember
+#define XRT_GUARD_SITES 32
+// how much stack to pre-fault on a thread's first guarded section
+#define XRT_GUARD_STACK (256*1024)
+
+// what to do about a violation
+enum XRTGuardMode
+{
+    XRT_GUARD_OFF = 0,  // nothing (no overhead beyond a thread-local check)
+    XRT_GUARD_RECORD,   // count it, remember the call site (see report())
+    XRT_GUARD_ABORT     // print the stack and abort()
+};
+
+// kinds of violation
+enum XRTViolation
+{
+    XRT_ALLOC = 0,  // malloc/calloc/realloc/new
+    XRT_FREE,       // free/delete
+    XRT_FAULT,      // page fault (minor or major)
+    XRT_NUM_VIOLATIONS
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct XRTGuardStats
+// desc: violation counts (see XRTGuard::stats())
+//-----------------------------------------------------------------------------
+struct XRTGuardStats
+{
+    // per kind
+    unsigned long counts[XRT_NUM_VIOLATIONS];
+    // guarded sections entered
+    unsigned long sections;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class XRTGuard
+// desc: static real-time safety guard
+//-----------------------------------------------------------------------------
+class XRTGuard
+{
+public:
+    // set mode (before the audio starts)
+    static void setMode( XRTGuardMode mode );
+    // set mode by name: "off", "record", "abort"
+    static bool setMode( const std::string & name );
+    // get mode
+    static XRTGuardMode mode();
+
+public: // memory
+    // lock all current and future pages into RAM
+    static bool lockMemory();
+    // touch every page of a buffer (writes back what's there)
+    static void prefault( void * buffer, size_t bytes );
+    // touch the calling thread's stack
+    static void prefaultStack( size_t bytes = XRT_GUARD_STACK );
+
+public: // guarded sections (e.g., around the audio callback)
+    // enter a section on this thread
+    static void enter();
+    // leave it (checks for page faults since enter())
+    static void leave();
+    // is this thread in a section?
+    static bool inside();
+
+public: // violations
+    // report one (called by the interposed allocators; allocation-free)
+    static void violation( XRTViolation kind, void * caller );
+    // get counts
+    static void stats( XRTGuardStats & out );
+    // print counts and call sites (not from a guarded section)
+    static void report();
+};
+
+
+
+
+#endif
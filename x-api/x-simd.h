@@ -0,0 +1,114 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-simd.h
+// desc: four floats at a time: SSE where there is SSE, plain floats (same
+//       layout, same results) elsewhere; inline only
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_X_SIMD_H__
+#define __MCD_X_SIMD_H__
+
+#include <string.h>
+
+// floats per vector
+#define XSIMD_WIDTH 4
+
+
+
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+
+typedef __m128 xvec;
+// unaligned load / store
+static inline xvec xv_load( const float * p ) { return _mm_loadu_ps( p ); }
+static inline void xv_store( float * p, xvec a ) { _mm_storeu_ps( p, a ); }
+// all lanes = v
+static inline xvec xv_set1( float v ) { return _mm_set1_ps( v ); }
+// [ a b c d ]
+static inline xvec xv_set( float a, float b, float c, float d ) { return _mm_setr_ps( a, b, c, d ); }
+// arithmetic
+static inline xvec xv_add( xvec a, xvec b ) { return _mm_add_ps( a, b ); }
+static inline xvec xv_sub( xvec a, xvec b ) { return _mm_sub_ps( a, b ); }
+static inline xvec xv_mul( xvec a, xvec b ) { return _mm_mul_ps( a, b ); }
+// [ a1 a0 a3 a2 ] (swap re/im of two interleaved complex values)
+static inline xvec xv_swap( xvec a ) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE(2,3,0,1) ); }
+// [ a2 a3 b0 b1 ]
+static inline xvec xv_shift2( xvec a, xvec b ) { return _mm_shuffle_ps( a, b, _MM_SHUFFLE(1,0,3,2) ); }
+// [ p0 p1 b0 b1 ]
+static inline xvec xv_in2( const float * p, xvec b ) { return _mm_loadl_pi( _mm_movelh_ps( b, b ), (const __m64 *)p ); }
+// [ a2 a3 ] -> p
+static inline void xv_out2( float * p, xvec a ) { _mm_storeh_pi( (__m64 *)p, a ); }
+// [ a0 a1 ] -> p
+static inline void xv_out2lo( float * p, xvec a ) { _mm_storel_pi( (__m64 *)p, a ); }
+// 4x4 transpose: rows a, b, c, d become columns
+static inline void xv_transpose4( xvec & a, xvec & b, xvec & c, xvec & d ) { _MM_TRANSPOSE4_PS( a, b, c, d ); }
+
+//-----------------------------------------------------------------------------
+// name: struct XFlushDenormals
+// desc: flush denormals to zero while in scope (decaying recursions get
+//       slow otherwise)
+//-----------------------------------------------------------------------------
+struct XFlushDenormals
+{
+    unsigned int csr;
+    XFlushDenormals() : csr( _mm_getcsr() ) { _mm_setcsr( csr | 0x8040 ); }
+    ~XFlushDenormals() { _mm_setcsr( csr ); }
+};
+
+#else
+
+struct xvec { float v[4]; };
+static inline xvec xv_load( const float * p ) { xvec a; memcpy( a.v, p, sizeof(a.v) ); return a; }
+static inline void xv_store( float * p, xvec a ) { memcpy( p, a.v, sizeof(a.v) ); }
+static inline xvec xv_set1( float v ) { xvec a = { { v, v, v, v } }; return a; }
+static inline xvec xv_set( float a, float b, float c, float d ) { xvec r = { { a, b, c, d } }; return r; }
+static inline xvec xv_add( xvec a, xvec b ) { for( int i = 0; i < 4; i++ ) a.v[i] += b.v[i]; return a; }
+static inline xvec xv_sub( xvec a, xvec b ) { for( int i = 0; i < 4; i++ ) a.v[i] -= b.v[i]; return a; }
+static inline xvec xv_mul( xvec a, xvec b ) { for( int i = 0; i < 4; i++ ) a.v[i] *= b.v[i]; return a; }
+static inline xvec xv_swap( xvec a ) { xvec c = { { a.v[1], a.v[0], a.v[3], a.v[2] } }; return c; }
+static inline xvec xv_shift2( xvec a, xvec b ) { xvec c = { { a.v[2], a.v[3], b.v[0], b.v[1] } }; return c; }
+static inline xvec xv_in2( const float * p, xvec b ) { xvec c = { { p[0], p[1], b.v[0], b.v[1] } }; return c; }
+static inline void xv_out2( float * p, xvec a ) { p[0] = a.v[2]; p[1] = a.v[3]; }
+static inline void xv_out2lo( float * p, xvec a ) { p[0] = a.v[0]; p[1] = a.v[1]; }
+static inline void xv_transpose4( xvec & a, xvec & b, xvec & c, xvec & d )
+{ xvec r[4] = { a, b, c, d }; for( int i = 0; i < 4; i++ ) { a.v[i] = r[i].v[0]; b.v[i] = r[i].v[1]; c.v[i] = r[i].v[2]; d.v[i] = r[i].v[3]; } }
+struct XFlushDenormals { };
+
+#endif
+
+
+
+
+#endif
@@ -51,6 +51,10 @@
   #include <GL/glu.h>
 #endif
 
+// slews closer than this to their goal (relative, past 1) snap to it
+// (see approach())
+#define XSLEW_EPSILON 1e-4f
+
 
 
 
@@ -79,6 +83,8 @@ public:
         if( index == 2 ) return z; return zero; }
     const Vector3D & operator =( const Vector3D & rhs )
     { x = rhs.x; y = rhs.y; z = rhs.z; return *this; }
+    bool operator ==( const Vector3D & rhs ) const
+    { return x == rhs.x && y == rhs.y && z == rhs.z; }
     
     Vector3D operator +( const Vector3D & rhs ) const
     { Vector3D result = *this; result += rhs; return result; }
@@ -136,6 +142,17 @@ public: // using the 3-tuple for interpolation
     { goal = value = _goalAndValue; }
     inline void updateSet( GLfloat _goalAndValue, GLfloat _slew )
     { goal = value = _goalAndValue; slew = _slew; }
+    // at the goal (nothing left to interpolate)
+    inline bool settled() const
+    { return value == goal; }
+    // interp, snapping to the goal once within epsilon (relative to the goal
+    // past 1), or once a step is too small to change value; false if settled
+    inline bool approach( GLfloat delta, GLfloat epsilon = XSLEW_EPSILON )
+    { if( value == goal ) return false; GLfloat last = value; interp( delta );
+      if( ( value == last && slew * delta > 0 ) ||
+          ::fabs( goal - value ) <= epsilon * ( ::fabs( goal ) > 1 ? ::fabs( goal ) : 1 ) )
+          value = goal;
+      return true; }
     
 public:
     // either use as .x, .y, .z OR .value, .goal, .slew
@@ -183,9 +200,19 @@ public:
     void update( Vector3D goal, float slew )
     { m_slewX.update( goal.x, slew ); m_slewY.update( goal.y, slew ); m_slewZ.update( goal.z, slew ); }
     void updateSet( Vector3D goalAndValue )
-    { m_slewX.updateSet( goalAndValue.x ); m_slewY.updateSet( goalAndValue.y ); m_slewZ.updateSet( goalAndValue.z ); }
+    { m_slewX.updateSet( goalAndValue.x ); m_slewY.updateSet( goalAndValue.y ); m_slewZ.updateSet( goalAndValue.z );
+        m_actual = goalAndValue; }
     void updateSet( Vector3D goalAndValue, float slew )
-    { m_slewX.updateSet( goalAndValue.x, slew ); m_slewY.updateSet( goalAndValue.y, slew ); m_slewZ.updateSet( goalAndValue.z, slew ); }
+    { m_slewX.updateSet( goalAndValue.x, slew ); m_slewY.updateSet( goalAndValue.y, slew ); m_slewZ.updateSet( goalAndValue.z, slew );
+        m_actual = goalAndValue; }
+    // all three at their goals
+    bool settled() const
+    { return m_slewX.settled() && m_slewY.settled() && m_slewZ.settled(); }
+    // interp the ones still moving (see Vector3D::approach()); false if settled
+    bool approach( float delta, float epsilon = XSLEW_EPSILON )
+    { bool moving = m_slewX.approach( delta, epsilon ) | m_slewY.approach( delta, epsilon ) | m_slewZ.approach( delta, epsilon );
+        if( moving ) { m_actual.x = m_slewX.value; m_actual.y = m_slewY.value; m_actual.z = m_slewZ.value; }
+        return moving; }
     
 public:
     const Vector3D & actual() const { return m_actual; }
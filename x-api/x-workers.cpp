@@ -0,0 +1,369 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-workers.cpp
+// desc: fork/join worker pool for the audio thread
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "x-workers.h"
+#include "x-rtguard.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#if defined(__PLATFORM_LINUX__)
+#include <sched.h>
+#endif
+using namespace std;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cpu_pause()
+// desc: spin-wait hint
+//-----------------------------------------------------------------------------
+static inline void cpu_pause()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__( "yield" );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// semaphore (only touched when a worker goes to / comes out of sleep)
+//-----------------------------------------------------------------------------
+static void sem_setup( XSEMAPHORE & s )
+{
+#if defined(__PLATFORM_MACOSX__)
+    s = dispatch_semaphore_create( 0 );
+#else
+    sem_init( &s, 0, 0 );
+#endif
+}
+
+static void sem_teardown( XSEMAPHORE & s )
+{
+#if defined(__PLATFORM_MACOSX__)
+    dispatch_release( s );
+#else
+    sem_destroy( &s );
+#endif
+}
+
+static void sem_signal( XSEMAPHORE & s )
+{
+#if defined(__PLATFORM_MACOSX__)
+    dispatch_semaphore_signal( s );
+#else
+    sem_post( &s );
+#endif
+}
+
+static void sem_block( XSEMAPHORE & s )
+{
+#if defined(__PLATFORM_MACOSX__)
+    dispatch_semaphore_wait( s, DISPATCH_TIME_FOREVER );
+#else
+    while( sem_wait( &s ) != 0 ) { }
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: worker_thread()
+// desc: thread routine
+//-----------------------------------------------------------------------------
+static THREAD_RETURN THREAD_TYPE worker_thread( void * data )
+{
+    XWorkerPool::Arg * arg = (XWorkerPool::Arg *)data;
+    arg->pool->work( arg->which );
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: XWorkerPool()
+// desc: constructor
+//-----------------------------------------------------------------------------
+XWorkerPool::XWorkerPool()
+    : m_numWorkers( 0 ), m_priority( 0 ), m_pin( false ), m_guard( true ), m_quit( false ),
+      m_job( NULL ), m_data( NULL ), m_count( 0 ), m_gen( 0 ), m_next( 0 ),
+      m_done( 0 )
+{
+    for( int i = 0; i < XWORKERS_MAX; i++ )
+        m_asleep[i] = false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~XWorkerPool()
+// desc: destructor
+//-----------------------------------------------------------------------------
+XWorkerPool::~XWorkerPool()
+{
+    stop();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: suggest()
+// desc: workers to use on this machine (0 == run serially)
+//-----------------------------------------------------------------------------
+int XWorkerPool::suggest( int max )
+{
+    // the audio thread takes a core of its own
+    int spare = (int)std::thread::hardware_concurrency() - 1;
+    if( spare > max ) spare = max;
+    if( spare > XWORKERS_MAX ) spare = XWORKERS_MAX;
+
+    return spare > 0 ? spare : 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start()
+// desc: start the workers
+//-----------------------------------------------------------------------------
+bool XWorkerPool::start( int numWorkers, int priority, bool pin, bool guard )
+{
+    // once
+    if( m_numWorkers > 0 ) return true;
+    // clamp
+    if( numWorkers > XWORKERS_MAX ) numWorkers = XWORKERS_MAX;
+
+    m_priority = priority;
+    m_pin = pin;
+    m_guard = guard;
+    m_quit = false;
+    for( int i = 0; i < numWorkers; i++ )
+    {
+        sem_setup( m_wake[i] );
+        m_args[i].pool = this;
+        m_args[i].which = i;
+        if( !m_threads[i].start( worker_thread, &m_args[i] ) )
+        {
+            // error message
+            cerr << "[x-workers]: cannot start worker " << i << "..." << endl;
+            sem_teardown( m_wake[i] );
+            break;
+        }
+        m_numWorkers++;
+    }
+
+    return m_numWorkers == numWorkers;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stop()
+// desc: stop and join the workers (not while run() is in progress)
+//-----------------------------------------------------------------------------
+void XWorkerPool::stop()
+{
+    if( m_numWorkers == 0 ) return;
+
+    // tell them, wake them
+    m_quit = true;
+    m_gen.fetch_add( 1 );
+    for( int i = 0; i < m_numWorkers; i++ )
+        sem_signal( m_wake[i] );
+    // join
+    for( int i = 0; i < m_numWorkers; i++ )
+    {
+        m_threads[i].wait();
+        m_threads[i].clear();
+        sem_teardown( m_wake[i] );
+    }
+
+    m_numWorkers = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: fork a batch, help with it, join (dispatcher only)
+//-----------------------------------------------------------------------------
+void XWorkerPool::run( XWorkerJob job, void * data, int count )
+{
+    // serial
+    if( m_numWorkers == 0 || count < 2 )
+    {
+        for( int i = 0; i < count; i++ ) job( i, data );
+        return;
+    }
+
+    // close the last batch first: a worker that is late for it may read
+    // this batch's job/data/count, and must then find nothing to claim
+    unsigned int gen = m_gen.load( std::memory_order_relaxed ) + 1;
+    m_next.store( (unsigned long long)( gen - 1 ) << 32 | 0xffffffffULL,
+                  std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    // publish the batch
+    m_job.store( job, std::memory_order_relaxed );
+    m_data.store( data, std::memory_order_relaxed );
+    m_count.store( count, std::memory_order_relaxed );
+    m_done.store( 0, std::memory_order_relaxed );
+    m_next.store( (unsigned long long)gen << 32, std::memory_order_release );
+    m_gen.store( gen, std::memory_order_seq_cst );
+
+    // wake whoever went to sleep
+    for( int i = 0; i < m_numWorkers; i++ )
+        if( m_asleep[i].exchange( false, std::memory_order_seq_cst ) )
+            sem_signal( m_wake[i] );
+
+    // the caller works too (so the batch finishes even if no one wakes up)
+    help( gen );
+
+    // join
+    while( m_done.load( std::memory_order_acquire ) < count )
+        cpu_pause();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: help()
+// desc: claim and run items of batch gen until there are none left
+//-----------------------------------------------------------------------------
+void XWorkerPool::help( unsigned int gen )
+{
+    XWorkerJob job = m_job.load( std::memory_order_relaxed );
+    void * data = m_data.load( std::memory_order_relaxed );
+    int count = m_count.load( std::memory_order_relaxed );
+    // pairs with the fence in run(): if job/data/count are from a later
+    // batch, gen's batch reads as closed below
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    unsigned long long next = m_next.load( std::memory_order_acquire );
+    while( true )
+    {
+        // someone else's batch (we read job/data/count too late) or all
+        // claimed (or closed)
+        if( (unsigned int)(next >> 32) != gen ) break;
+        unsigned int index = (unsigned int)(next & 0xffffffff);
+        if( index >= (unsigned int)count ) break;
+        // claim it
+        if( !m_next.compare_exchange_weak( next, next + 1, std::memory_order_acq_rel ) )
+            continue;
+        // run it
+        job( (int)index, data );
+        m_done.fetch_add( 1, std::memory_order_release );
+        next = m_next.load( std::memory_order_acquire );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: work()
+// desc: worker loop: spin a little after each batch, then sleep
+//-----------------------------------------------------------------------------
+void XWorkerPool::work( int which )
+{
+#if defined(__PLATFORM_LINUX__)
+    // pin (the audio thread floats; workers stay off core 0)
+    if( m_pin )
+    {
+        int cores = (int)std::thread::hardware_concurrency();
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        CPU_SET( ( which + 1 ) % ( cores > 0 ? cores : 1 ), &set );
+        pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+    }
+    // realtime, like the audio thread we're helping
+    if( m_priority > 0 )
+    {
+        struct sched_param param;
+        param.sched_priority = m_priority;
+        if( pthread_setschedparam( pthread_self(), SCHED_FIFO, &param ) != 0 && which == 0 )
+            cerr << "[x-workers]: workers not realtime (SCHED_FIFO denied)" << endl;
+    }
+#endif
+
+    unsigned int seen = m_gen.load();
+    while( !m_quit.load( std::memory_order_acquire ) )
+    {
+        // spin for the next batch
+        unsigned int gen = m_gen.load( std::memory_order_acquire );
+        if( gen == seen )
+        {
+            std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now()
+                + std::chrono::microseconds( XWORKERS_SPIN_US );
+            for( int i = 0; ( gen = m_gen.load( std::memory_order_acquire ) ) == seen; i++ )
+            {
+                cpu_pause();
+                if( ( i & 63 ) == 63 && std::chrono::steady_clock::now() > until ) break;
+            }
+        }
+        // nothing: sleep (announce first, then look once more)
+        if( gen == seen )
+        {
+            m_asleep[which].store( true, std::memory_order_seq_cst );
+            if( m_gen.load( std::memory_order_seq_cst ) == seen ||
+                !m_asleep[which].exchange( false, std::memory_order_seq_cst ) )
+                // either asleep for real, or the dispatcher already signalled
+                sem_block( m_wake[which] );
+            continue;
+        }
+
+        // help with it
+        seen = gen;
+        if( m_quit.load( std::memory_order_acquire ) ) break;
+        if( m_guard ) XRTGuard::enter();
+        help( gen );
+        if( m_guard ) XRTGuard::leave();
+    }
+}
@@ -0,0 +1,135 @@
+/*----------------------------------------------------------------------------
+  X-API: an API for audio/graphics/interaction programming
+         (sibling of Y-API; part of MCD API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: x-workers.h
+// desc: fork/join worker pool for the audio thread: pinned (and realtime,
+//       if allowed) workers that help the calling thread run a batch of
+//       jobs; dispatch and join are lock-free, idle workers sleep
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_X_WORKERS_H__
+#define __MCD_X_WORKERS_H__
+
+#include "x-def.h"
+#include "x-thread.h"
+#include <atomic>
+
+#if defined(__PLATFORM_MACOSX__)
+  #include <dispatch/dispatch.h>
+  typedef dispatch_semaphore_t XSEMAPHORE;
+#else
+  #include <semaphore.h>
+  typedef sem_t XSEMAPHORE;
+#endif
+
+// most workers
+#define XWORKERS_MAX 16
+// how long an idle worker spins before sleeping (microseconds; long enough
+// to stay awake between the batches of one callback)
+#define XWORKERS_SPIN_US 50
+
+// a job: run item index of a batch
+typedef void (* XWorkerJob)( int index, void * data );
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class XWorkerPool
+// desc: fork/join pool (one dispatcher: the audio thread)
+//-----------------------------------------------------------------------------
+class XWorkerPool
+{
+public:
+    XWorkerPool();
+    ~XWorkerPool();
+
+public: // control thread
+    // start numWorkers threads (0 == serial: run() does everything itself);
+    // priority > 0 asks for SCHED_FIFO, pin puts worker i on core i+1,
+    // guard runs jobs as XRTGuard sections (for audio work)
+    bool start( int numWorkers, int priority = 0, bool pin = true, bool guard = true );
+    // stop and join
+    void stop();
+    // number of workers running
+    int size() const { return m_numWorkers; }
+    // workers to use on this machine: one per spare core (at most max)
+    static int suggest( int max );
+
+public: // dispatcher (audio thread)
+    // run job( 0 .. count-1, data ) across the workers and the caller;
+    // returns when every item is done
+    void run( XWorkerJob job, void * data, int count );
+
+public:
+    // worker loop (should not be used by client)
+    void work( int which );
+    // what a worker thread gets (should not be used by client)
+    struct Arg
+    {
+        XWorkerPool * pool;
+        int which;
+    };
+
+protected:
+    // grab and run items of batch gen until none are left
+    void help( unsigned int gen );
+
+protected:
+    // workers
+    int m_numWorkers;
+    Arg m_args[XWORKERS_MAX];
+    XThread m_threads[XWORKERS_MAX];
+    XSEMAPHORE m_wake[XWORKERS_MAX];
+    std::atomic<bool> m_asleep[XWORKERS_MAX];
+    int m_priority;
+    bool m_pin;
+    bool m_guard;
+    std::atomic<bool> m_quit;
+
+    // the batch
+    std::atomic<XWorkerJob> m_job;
+    std::atomic<void *> m_data;
+    std::atomic<int> m_count;
+    // batch number (workers wait for it to change)
+    std::atomic<unsigned int> m_gen;
+    // batch number (high 32 bits) | next item (low 32 bits)
+    std::atomic<unsigned long long> m_next;
+    // items finished
+    std::atomic<int> m_done;
+};
+
+
+
+
+#endif
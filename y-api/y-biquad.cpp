@@ -0,0 +1,512 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-biquad.cpp
+// desc: biquad filter bank
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-biquad.h"
+#include "x-def.h"
+#include "x-simd.h"
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct YBiquadLanes
+// desc: coefficients and state of four lanes, in registers
+//-----------------------------------------------------------------------------
+struct YBiquadLanes
+{
+    xvec b0, b1, b2, a1, a2;
+    xvec s1, s2;
+
+    // load lanes [i, i+4) of a bank
+    inline void load( const float * const * p, int i )
+    {
+        b0 = xv_load( p[0] + i ); b1 = xv_load( p[1] + i ); b2 = xv_load( p[2] + i );
+        a1 = xv_load( p[3] + i ); a2 = xv_load( p[4] + i );
+        s1 = xv_load( p[5] + i ); s2 = xv_load( p[6] + i );
+    }
+    // put the state back
+    inline void save( float * const * p, int i )
+    {
+        xv_store( p[5] + i, s1 );
+        xv_store( p[6] + i, s2 );
+    }
+    // one sample, transposed direct form II (the x terms go first, so only
+    // an add, a multiply and a subtract wait on y)
+    inline xvec tick( xvec x )
+    {
+        xvec y = xv_add( xv_mul( b0, x ), s1 );
+        s1 = xv_sub( xv_add( xv_mul( b1, x ), s2 ), xv_mul( a1, y ) );
+        s2 = xv_sub( xv_mul( b2, x ), xv_mul( a2, y ) );
+        return y;
+    }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: process_kernel()
+// desc: G vectors of independent lanes, stepped together so their
+//       recursions overlap (stride: lanes per frame)
+//-----------------------------------------------------------------------------
+template <int G>
+static void process_kernel( float * const * p, float * buffer, unsigned int numFrames,
+                            int stride )
+{
+    YBiquadLanes lanes[G];
+    for( int g = 0; g < G; g++ )
+        lanes[g].load( p, g * YBIQUAD_VECTOR );
+
+    for( unsigned int i = 0; i < numFrames; i++, buffer += stride )
+        for( int g = 0; g < G; g++ )
+            xv_store( buffer + g * YBIQUAD_VECTOR,
+                      lanes[g].tick( xv_load( buffer + g * YBIQUAD_VECTOR ) ) );
+
+    for( int g = 0; g < G; g++ )
+        lanes[g].save( p, g * YBIQUAD_VECTOR );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cascade_kernel()
+// desc: pipelined stereo cascade over G vectors (2G stages); y holds each
+//       lane's last output, which is the next stage's next input
+//-----------------------------------------------------------------------------
+template <int G>
+static void cascade_kernel( float * const * p, float * last, float * buffer,
+                            unsigned int numFrames )
+{
+    YBiquadLanes lanes[G];
+    xvec y[G];
+    for( int g = 0; g < G; g++ )
+    {
+        lanes[g].load( p, g * YBIQUAD_VECTOR );
+        y[g] = xv_load( last + g * YBIQUAD_VECTOR );
+    }
+
+    for( unsigned int i = 0; i < numFrames; i++, buffer += 2 )
+    {
+        // inputs: the frame, then everything moved up a stage
+        xvec in[G];
+        in[0] = xv_in2( buffer, y[0] );
+        for( int g = 1; g < G; g++ )
+            in[g] = xv_shift2( y[g-1], y[g] );
+        // all stages at once
+        for( int g = 0; g < G; g++ )
+            y[g] = lanes[g].tick( in[g] );
+        // the last stage out
+        xv_out2( buffer, y[G-1] );
+    }
+
+    for( int g = 0; g < G; g++ )
+    {
+        lanes[g].save( p, g * YBIQUAD_VECTOR );
+        xv_store( last + g * YBIQUAD_VECTOR, y[g] );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: design()
+// desc: RBJ cookbook biquad
+//-----------------------------------------------------------------------------
+YBiquadCoefs YBiquadCoefs::design( YBiquadType type, float srate, float freq,
+                                   float q, float gainDB )
+{
+    // keep it below nyquist, and sane
+    if( freq > srate * 0.49f ) freq = srate * 0.49f;
+    if( freq < 1 ) freq = 1;
+    if( q < 0.01f ) q = 0.01f;
+
+    double w0 = 2 * M_PI * freq / srate;
+    double cw = cos( w0 );
+    double alpha = sin( w0 ) / ( 2 * q );
+    double A = pow( 10.0, gainDB / 40.0 );
+    double sq = 2 * sqrt( A ) * alpha;
+    double b0 = 1, b1 = 0, b2 = 0, a0 = 1, a1 = 0, a2 = 0;
+
+    switch( type )
+    {
+        case YBIQUAD_LOWPASS:
+            b0 = ( 1 - cw ) / 2; b1 = 1 - cw; b2 = b0;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case YBIQUAD_HIGHPASS:
+            b0 = ( 1 + cw ) / 2; b1 = -( 1 + cw ); b2 = b0;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case YBIQUAD_BANDPASS:
+            b0 = alpha; b1 = 0; b2 = -alpha;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case YBIQUAD_NOTCH:
+            b0 = 1; b1 = -2 * cw; b2 = 1;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case YBIQUAD_PEAK:
+            b0 = 1 + alpha * A; b1 = -2 * cw; b2 = 1 - alpha * A;
+            a0 = 1 + alpha / A; a1 = -2 * cw; a2 = 1 - alpha / A;
+            break;
+        case YBIQUAD_LOWSHELF:
+            b0 = A * ( ( A + 1 ) - ( A - 1 ) * cw + sq );
+            b1 = 2 * A * ( ( A - 1 ) - ( A + 1 ) * cw );
+            b2 = A * ( ( A + 1 ) - ( A - 1 ) * cw - sq );
+            a0 = ( A + 1 ) + ( A - 1 ) * cw + sq;
+            a1 = -2 * ( ( A - 1 ) + ( A + 1 ) * cw );
+            a2 = ( A + 1 ) + ( A - 1 ) * cw - sq;
+            break;
+        case YBIQUAD_HIGHSHELF:
+            b0 = A * ( ( A + 1 ) + ( A - 1 ) * cw + sq );
+            b1 = -2 * A * ( ( A - 1 ) + ( A + 1 ) * cw );
+            b2 = A * ( ( A + 1 ) + ( A - 1 ) * cw - sq );
+            a0 = ( A + 1 ) - ( A - 1 ) * cw + sq;
+            a1 = 2 * ( ( A - 1 ) - ( A + 1 ) * cw );
+            a2 = ( A + 1 ) - ( A - 1 ) * cw - sq;
+            break;
+    }
+
+    // normalize
+    YBiquadCoefs c;
+    c.b0 = b0 / a0; c.b1 = b1 / a0; c.b2 = b2 / a0;
+    c.a1 = a1 / a0; c.a2 = a2 / a0;
+
+    return c;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YBiquadTable()
+// desc: constructor: design every entry
+//-----------------------------------------------------------------------------
+YBiquadTable::YBiquadTable( YBiquadType type, float srate, float q, float gainDB,
+                            float lo, float hi, int size )
+{
+    // sanity check
+    if( size < 2 ) size = 2;
+    if( lo < 1 ) lo = 1;
+    if( hi <= lo ) hi = lo * 2;
+
+    m_size = size;
+    m_lo = lo;
+    m_hi = hi;
+    m_scale = ( size - 1 ) / logf( hi / lo );
+    m_table = new YBiquadCoefs[size];
+
+    // log-spaced
+    for( int i = 0; i < size; i++ )
+        m_table[i] = YBiquadCoefs::design( type, srate,
+                         lo * powf( hi / lo, (float)i / ( size - 1 ) ), q, gainDB );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YBiquadTable()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YBiquadTable::~YBiquadTable()
+{
+    SAFE_DELETE_ARRAY( m_table );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lookup()
+// desc: coefficients at freq (lerp between neighbours)
+//-----------------------------------------------------------------------------
+YBiquadCoefs YBiquadTable::lookup( float freq ) const
+{
+    // clamp
+    if( freq <= m_lo ) return m_table[0];
+    if( freq >= m_hi ) return m_table[m_size-1];
+
+    float pos = logf( freq / m_lo ) * m_scale;
+    int i = (int)pos;
+    if( i >= m_size - 1 ) return m_table[m_size-1];
+    float t = pos - i;
+    const YBiquadCoefs & a = m_table[i];
+    const YBiquadCoefs & b = m_table[i+1];
+
+    YBiquadCoefs c;
+    c.b0 = a.b0 + ( b.b0 - a.b0 ) * t;
+    c.b1 = a.b1 + ( b.b1 - a.b1 ) * t;
+    c.b2 = a.b2 + ( b.b2 - a.b2 ) * t;
+    c.a1 = a.a1 + ( b.a1 - a.a1 ) * t;
+    c.a2 = a.a2 + ( b.a2 - a.a2 ) * t;
+
+    return c;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YBiquadBank()
+// desc: constructor (every lane passes through)
+//-----------------------------------------------------------------------------
+YBiquadBank::YBiquadBank( int lanes )
+{
+    // whole vectors
+    if( lanes < YBIQUAD_VECTOR ) lanes = YBIQUAD_VECTOR;
+    if( lanes > YBIQUAD_MAX_LANES ) lanes = YBIQUAD_MAX_LANES;
+    m_lanes = ( lanes + YBIQUAD_VECTOR - 1 ) / YBIQUAD_VECTOR * YBIQUAD_VECTOR;
+
+    // eight arrays, 16-byte aligned
+    m_memory = new float[8 * YBIQUAD_MAX_LANES + YBIQUAD_VECTOR];
+    float * p = (float *)( ( (uintptr_t)m_memory + 15 ) & ~(uintptr_t)15 );
+    m_b0 = p; p += YBIQUAD_MAX_LANES;
+    m_b1 = p; p += YBIQUAD_MAX_LANES;
+    m_b2 = p; p += YBIQUAD_MAX_LANES;
+    m_a1 = p; p += YBIQUAD_MAX_LANES;
+    m_a2 = p; p += YBIQUAD_MAX_LANES;
+    m_s1 = p; p += YBIQUAD_MAX_LANES;
+    m_s2 = p; p += YBIQUAD_MAX_LANES;
+    m_y = p;
+
+    // pass-through
+    for( int i = 0; i < YBIQUAD_MAX_LANES; i++ )
+        set( i, YBiquadCoefs() );
+    clear();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YBiquadBank()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YBiquadBank::~YBiquadBank()
+{
+    SAFE_DELETE_ARRAY( m_memory );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set()
+// desc: set a lane's coefficients
+//-----------------------------------------------------------------------------
+void YBiquadBank::set( int lane, const YBiquadCoefs & c )
+{
+    // sanity check
+    if( lane < 0 || lane >= YBIQUAD_MAX_LANES ) return;
+
+    m_b0[lane] = c.b0;
+    m_b1[lane] = c.b1;
+    m_b2[lane] = c.b2;
+    m_a1[lane] = c.a1;
+    m_a2[lane] = c.a2;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: zero the state
+//-----------------------------------------------------------------------------
+void YBiquadBank::clear()
+{
+    memset( m_s1, 0, sizeof(float) * YBIQUAD_MAX_LANES );
+    memset( m_s2, 0, sizeof(float) * YBIQUAD_MAX_LANES );
+    memset( m_y, 0, sizeof(float) * YBIQUAD_MAX_LANES );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: process()
+// desc: independent lanes (numFrames x lanes, in place)
+//-----------------------------------------------------------------------------
+void YBiquadBank::process( float * buffer, unsigned int numFrames )
+{
+    XFlushDenormals ftz;
+    float * p[7] = { m_b0, m_b1, m_b2, m_a1, m_a2, m_s1, m_s2 };
+
+    switch( m_lanes / YBIQUAD_VECTOR )
+    {
+        case 1: process_kernel<1>( p, buffer, numFrames, m_lanes ); break;
+        case 2: process_kernel<2>( p, buffer, numFrames, m_lanes ); break;
+        case 3: process_kernel<3>( p, buffer, numFrames, m_lanes ); break;
+        case 4: process_kernel<4>( p, buffer, numFrames, m_lanes ); break;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cascade()
+// desc: pipelined stereo cascade (interleaved stereo, in place)
+//-----------------------------------------------------------------------------
+void YBiquadBank::cascade( float * buffer, unsigned int numFrames )
+{
+    XFlushDenormals ftz;
+    float * p[7] = { m_b0, m_b1, m_b2, m_a1, m_a2, m_s1, m_s2 };
+
+    switch( m_lanes / YBIQUAD_VECTOR )
+    {
+        case 1: cascade_kernel<1>( p, m_y, buffer, numFrames ); break;
+        case 2: cascade_kernel<2>( p, m_y, buffer, numFrames ); break;
+        case 3: cascade_kernel<3>( p, m_y, buffer, numFrames ); break;
+        case 4: cascade_kernel<4>( p, m_y, buffer, numFrames ); break;
+    }
+}
+
+
+
+
+// corners of the track EQ's shelves (Hz), and the cutoff range
+#define YTRACKEQ_LOW_CORNER 200
+#define YTRACKEQ_HIGH_CORNER 4000
+#define YTRACKEQ_LO 20
+#define YTRACKEQ_HI 20000
+
+// lanes of each stage (stage-major, L/R)
+enum { YTRACKEQ_HP = 0, YTRACKEQ_LOWSHELF, YTRACKEQ_HIGHSHELF, YTRACKEQ_LP };
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YTrackEQ()
+// desc: constructor (flat)
+//-----------------------------------------------------------------------------
+YTrackEQ::YTrackEQ( float srate )
+    : m_srate( srate ),
+      m_bank( YTRACKEQ_STAGES * 2 ),
+      m_highPass( YBIQUAD_HIGHPASS, srate, 0.7071f, 0, YTRACKEQ_LO, YTRACKEQ_HI ),
+      m_lowPass( YBIQUAD_LOWPASS, srate, 0.7071f, 0, YTRACKEQ_LO, YTRACKEQ_HI )
+{ }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YTrackEQ()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YTrackEQ::~YTrackEQ()
+{ }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setHighPass()
+// desc: high-pass cutoff (at the bottom of the range: bypassed)
+//-----------------------------------------------------------------------------
+void YTrackEQ::setHighPass( float freq )
+{
+    YBiquadCoefs c;
+    if( freq > m_highPass.lo() ) c = m_highPass.lookup( freq );
+    m_bank.set( YTRACKEQ_HP * 2, c );
+    m_bank.set( YTRACKEQ_HP * 2 + 1, c );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setLowPass()
+// desc: low-pass cutoff (at the top of the range: bypassed)
+//-----------------------------------------------------------------------------
+void YTrackEQ::setLowPass( float freq )
+{
+    YBiquadCoefs c;
+    if( freq < m_lowPass.hi() ) c = m_lowPass.lookup( freq );
+    m_bank.set( YTRACKEQ_LP * 2, c );
+    m_bank.set( YTRACKEQ_LP * 2 + 1, c );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setLowShelf()
+// desc: low shelf gain (dB)
+//-----------------------------------------------------------------------------
+void YTrackEQ::setLowShelf( float gainDB )
+{
+    YBiquadCoefs c = YBiquadCoefs::design( YBIQUAD_LOWSHELF, m_srate,
+                                           YTRACKEQ_LOW_CORNER, 0.7071f, gainDB );
+    m_bank.set( YTRACKEQ_LOWSHELF * 2, c );
+    m_bank.set( YTRACKEQ_LOWSHELF * 2 + 1, c );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setHighShelf()
+// desc: high shelf gain (dB)
+//-----------------------------------------------------------------------------
+void YTrackEQ::setHighShelf( float gainDB )
+{
+    YBiquadCoefs c = YBiquadCoefs::design( YBIQUAD_HIGHSHELF, m_srate,
+                                           YTRACKEQ_HIGH_CORNER, 0.7071f, gainDB );
+    m_bank.set( YTRACKEQ_HIGHSHELF * 2, c );
+    m_bank.set( YTRACKEQ_HIGHSHELF * 2 + 1, c );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: synthesize2()
+// desc: filter (interleaved stereo, in place)
+//-----------------------------------------------------------------------------
+int YTrackEQ::synthesize2( float * buffer, unsigned int numFrames )
+{
+    m_bank.cascade( buffer, numFrames );
+    return 0;
+}
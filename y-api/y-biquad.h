@@ -0,0 +1,202 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-biquad.h
+// desc: biquad filter bank: four (or eight, ...) transposed direct form II
+//       biquads run side by side in SIMD lanes; coefficient tables for
+//       cutoff sweeps; a four-stage stereo track EQ on eight lanes
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_BIQUAD_H__
+#define __MCD_Y_BIQUAD_H__
+
+// lanes per SIMD vector (a bank is a multiple of this)
+#define YBIQUAD_VECTOR 4
+// most lanes in a bank
+#define YBIQUAD_MAX_LANES 16
+// entries in a cutoff table
+#define YBIQUAD_TABLE 512
+// stages in a track EQ
+#define YTRACKEQ_STAGES 4
+
+
+
+
+// filter types (RBJ cookbook)
+enum YBiquadType
+{
+    YBIQUAD_LOWPASS = 0,
+    YBIQUAD_HIGHPASS,
+    YBIQUAD_BANDPASS,
+    YBIQUAD_NOTCH,
+    YBIQUAD_PEAK,
+    YBIQUAD_LOWSHELF,
+    YBIQUAD_HIGHSHELF
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct YBiquadCoefs
+// desc: normalized coefficients: y = b0 x + b1 x' + b2 x'' - a1 y' - a2 y''
+//-----------------------------------------------------------------------------
+struct YBiquadCoefs
+{
+    float b0, b1, b2, a1, a2;
+
+    // pass-through
+    YBiquadCoefs() : b0( 1 ), b1( 0 ), b2( 0 ), a1( 0 ), a2( 0 ) { }
+    // design one (gain in dB: peak and shelves only)
+    static YBiquadCoefs design( YBiquadType type, float srate, float freq,
+                                float q = 0.7071f, float gainDB = 0 );
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YBiquadTable
+// desc: coefficients for one type / Q / gain at log-spaced cutoffs, so a
+//       sweep is a lookup + lerp instead of trig (blends of neighbouring
+//       stable filters are stable: the stability triangle is convex)
+//-----------------------------------------------------------------------------
+class YBiquadTable
+{
+public:
+    YBiquadTable( YBiquadType type, float srate, float q = 0.7071f, float gainDB = 0,
+                  float lo = 20, float hi = 20000, int size = YBIQUAD_TABLE );
+    ~YBiquadTable();
+
+public:
+    // coefficients at freq (clamped to [lo, hi])
+    YBiquadCoefs lookup( float freq ) const;
+    // range
+    float lo() const { return m_lo; }
+    float hi() const { return m_hi; }
+
+protected:
+    YBiquadCoefs * m_table;
+    int m_size;
+    float m_lo;
+    float m_hi;
+    // entries per unit of log( freq )
+    float m_scale;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YBiquadBank
+// desc: a bank of biquads, one per lane, all stepped together; state and
+//       coefficients are laid out lane-major for the SIMD kernel
+//-----------------------------------------------------------------------------
+class YBiquadBank
+{
+public:
+    // lanes rounded up to a multiple of YBIQUAD_VECTOR
+    YBiquadBank( int lanes = YBIQUAD_VECTOR );
+    ~YBiquadBank();
+
+public:
+    // set a lane's coefficients (audio thread, or before it starts)
+    void set( int lane, const YBiquadCoefs & c );
+    // zero the state
+    void clear();
+    // number of lanes
+    int lanes() const { return m_lanes; }
+
+public: // audio
+    // independent lanes: buffer is numFrames x lanes(), in place
+    void process( float * buffer, unsigned int numFrames );
+    // stereo cascade: lanes are stage-major (stage 0 L, stage 0 R, stage 1 L,
+    // ...); each stage works on what the one before it produced a sample
+    // ago, so all stages step at once, at a latency of lanes()/2 - 1 samples
+    void cascade( float * buffer, unsigned int numFrames );
+
+protected:
+    int m_lanes;
+    // coefficients and state, YBIQUAD_MAX_LANES each (aligned)
+    float * m_memory;
+    float * m_b0;
+    float * m_b1;
+    float * m_b2;
+    float * m_a1;
+    float * m_a2;
+    float * m_s1;
+    float * m_s2;
+    // cascade: each lane's last output (the next stage's next input)
+    float * m_y;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YTrackEQ
+// desc: per-track tone shaping (stereo insert): high-pass, low shelf, high
+//       shelf, low-pass as one pipelined cascade on an eight-lane bank; a
+//       cutoff at the end of its range bypasses that stage
+//-----------------------------------------------------------------------------
+class YTrackEQ
+{
+public:
+    YTrackEQ( float srate );
+    ~YTrackEQ();
+
+public: // audio thread, or before it starts
+    // cutoffs (table lookups: fine for sweeps)
+    void setHighPass( float freq );
+    void setLowPass( float freq );
+    // shelves (in dB, at fixed corners)
+    void setLowShelf( float gainDB );
+    void setHighShelf( float gainDB );
+
+public:
+    // filter buffer (interleaved stereo, in place)
+    int synthesize2( float * buffer, unsigned int numFrames );
+    // added delay in samples
+    int latency() const { return YTRACKEQ_STAGES - 1; }
+
+protected:
+    float m_srate;
+    YBiquadBank m_bank;
+    YBiquadTable m_highPass;
+    YBiquadTable m_lowPass;
+};
+
+
+
+
+#endif
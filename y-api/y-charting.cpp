@@ -593,6 +593,7 @@ YLineChart::YLineChart()
 
     // zero out list
     m_line = NULL;
+    m_tail = NULL;
     m_leftViewable = NULL;
     m_rightViewable = NULL;
 
@@ -613,6 +614,7 @@ YLineChart::YLineChart()
 YLineChart::~YLineChart()
 {
     // clean up
+    cleanup();
 }
 
 
@@ -654,6 +656,10 @@ void YLineChart::cleanup()
     
     // zero out the list
     m_line = NULL;
+    m_tail = NULL;
+    m_leftViewable = NULL;
+    m_rightViewable = NULL;
+    m_vertices.clear();
 }
 
 
@@ -665,54 +671,71 @@ void YLineChart::cleanup()
 //-----------------------------------------------------------------------------
 void YLineChart::addValue( GLfloat x, GLfloat y )
 {
+    // empty list, or append to the right (the common case)
+    if( m_tail == NULL || m_tail->x < x )
+    {
+        // make new node
+        YLineNode * node = new YLineNode();
+        node->x = x;
+        node->y = y;
+        // link
+        node->prev = m_tail;
+        if( m_tail ) m_tail->next = node;
+        else m_line = node;
+        m_tail = node;
+        // done
+        return;
+    }
+
     // pointers
     YLineNode * curr = m_line;
-    YLineNode * next = NULL;
 
-    // find
-    while( curr != NULL )
+    // find the first node at or right of x
+    while( curr != NULL && curr->x < x )
+        curr = curr->next;
+
+    // check for duplicate
+    if( curr->x == x )
     {
-        // get next
-        next = curr->next;
-        
-        // check for duplicate
-        if( curr->x == x )
-        {
-            // update
-            curr->y = y;
-            // done
-            break;
-        }
-
-        // check
-        if( curr->x < x && ( !next || next->x > x ) )
-        {
-            // make new node
-            YLineNode * node = new YLineNode();
-            // set
-            node->x = x;
-            node->y = y;
-            
-            // link
-            node->prev = curr;
-            node->next = next;
-            
-            // re-link
-            curr->next = node;
-            if( next ) next->prev = node;
-            
-            // TODO: update left and right viewable
-            
-            // done
-            break;
-        }
-        
-        // advance
-        curr = next;
+        // update
+        curr->y = y;
+        return;
     }
 
-    // zero out the list
-    m_line = NULL;
+    // make new node
+    YLineNode * node = new YLineNode();
+    node->x = x;
+    node->y = y;
+    // link in front of curr
+    node->prev = curr->prev;
+    node->next = curr;
+    if( curr->prev ) curr->prev->next = node;
+    else m_line = node;
+    curr->prev = node;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: trim()
+// desc: remove all nodes left of X (for scrolling charts)
+//-----------------------------------------------------------------------------
+void YLineChart::trim( GLfloat x )
+{
+    // delete from the left
+    while( m_line != NULL && m_line->x < x )
+    {
+        YLineNode * next = m_line->next;
+        SAFE_DELETE( m_line );
+        m_line = next;
+    }
+
+    // fix up
+    if( m_line ) m_line->prev = NULL;
+    else m_tail = NULL;
+    // viewable pointers get recomputed in generate()
+    m_leftViewable = m_rightViewable = NULL;
 }
 
 
@@ -757,6 +780,9 @@ void YLineChart::update( YTimeInterval dt )
     m_rightBound.interp( dt );
     m_lowerBound.interp( dt );
     m_upperBound.interp( dt );
+
+    // regenerate
+    generate();
 }
 
 
@@ -768,6 +794,33 @@ void YLineChart::update( YTimeInterval dt )
 //-----------------------------------------------------------------------------
 void YLineChart::render()
 {
+    // disable lighting
+    glDisable( GL_LIGHTING );
+    // blend
+    glEnable( GL_BLEND );
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+
+    // enable
+    glEnableClientState( GL_VERTEX_ARRAY );
+
+    // frame
+    GLfloat frame[] = { 0, 0, m_width, 0, m_width, m_height, 0, m_height };
+    glColor4f( .5, .5, .5, alpha );
+    glLineWidth( 1 );
+    glVertexPointer( 2, GL_FLOAT, 0, frame );
+    glDrawArrays( GL_LINE_LOOP, 0, 4 );
+
+    // the line
+    if( m_vertices.size() > 1 )
+    {
+        glColor4f( col.x, col.y, col.z, alpha );
+        glVertexPointer( 2, GL_FLOAT, 0, &m_vertices[0] );
+        glDrawArrays( GL_LINE_STRIP, 0, m_vertices.size() );
+    }
+
+    // disable
+    glDisableClientState( GL_VERTEX_ARRAY );
+    glDisable( GL_BLEND );
 }
 
 
@@ -779,5 +832,41 @@ void YLineChart::render()
 //-----------------------------------------------------------------------------
 void YLineChart::generate()
 {
-    
+    // clear (keeps capacity)
+    m_vertices.clear();
+
+    // bounds
+    GLfloat left = m_leftBound.value;
+    GLfloat right = m_rightBound.value;
+    GLfloat lower = m_lowerBound.value;
+    GLfloat upper = m_upperBound.value;
+    // sanity check
+    if( right <= left || upper <= lower ) return;
+
+    // scale into width x height
+    GLfloat sx = m_width / (right - left);
+    GLfloat sy = m_height / (upper - lower);
+
+    // find left most viewable (include one node past each edge)
+    YLineNode * curr = m_line;
+    while( curr != NULL && curr->next != NULL && curr->next->x < left )
+        curr = curr->next;
+    m_leftViewable = curr;
+
+    // iterate to the right most viewable
+    while( curr != NULL )
+    {
+        // clamp y into view
+        GLfloat y = curr->y;
+        if( y < lower ) y = lower;
+        else if( y > upper ) y = upper;
+        // add
+        m_vertices.push_back( XPoint2D( (curr->x - left) * sx, (y - lower) * sy ) );
+        // remember
+        m_rightViewable = curr;
+        // done?
+        if( curr->x > right ) break;
+        // next
+        curr = curr->next;
+    }
 }
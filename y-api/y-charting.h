@@ -194,6 +194,8 @@ public:
     void viewX( GLfloat min, GLfloat max );
     // set Y range for viewing
     void viewY( GLfloat min, GLfloat max );
+    // remove all nodes left of X (for scrolling charts)
+    void trim( GLfloat x );
     
 public:
     // update
@@ -213,6 +215,8 @@ protected:
     
     // the list
     YLineNode * m_line;
+    // last node in the list
+    YLineNode * m_tail;
     // left most node in viewable region (even if partial node)
     YLineNode * m_leftViewable;
     // right most node
@@ -223,6 +227,9 @@ protected:
     Vector3D m_rightBound;
     Vector3D m_lowerBound;
     Vector3D m_upperBound;
+
+    // vertices for the viewable region
+    std::vector<XPoint2D> m_vertices;
 };
 
 
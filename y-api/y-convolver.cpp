@@ -0,0 +1,501 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-convolver.cpp
+// desc: convolution reverb (uniformly partitioned, overlap-save)
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-convolver.h"
+#include "y-fft.h"
+#include "x-def.h"
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+using namespace std;
+
+
+
+
+//-----------------------------------------------------------------------------
+// little-endian readers
+//-----------------------------------------------------------------------------
+static unsigned int le16( const unsigned char * p )
+{ return p[0] | ( p[1] << 8 ); }
+static unsigned int le32( const unsigned char * p )
+{ return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 ); }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_wav()
+// desc: read a .wav into interleaved floats
+//-----------------------------------------------------------------------------
+static bool read_wav( const std::string & path, std::vector<float> & out,
+                      int & channels, int & srate )
+{
+    FILE * file = fopen( path.c_str(), "rb" );
+    if( !file )
+    {
+        // error message
+        cerr << "[y-convolver]: cannot open '" << path << "'..." << endl;
+        return false;
+    }
+
+    unsigned char header[12];
+    unsigned int format = 0, bits = 0;
+    std::vector<unsigned char> data;
+    channels = 0;
+    // RIFF/WAVE
+    if( fread( header, 1, 12, file ) != 12 || memcmp( header, "RIFF", 4 ) ||
+        memcmp( header + 8, "WAVE", 4 ) )
+    {
+        // error message
+        cerr << "[y-convolver]: '" << path << "' is not a .wav file..." << endl;
+        fclose( file );
+        return false;
+    }
+
+    // chunks
+    unsigned char chunk[8];
+    while( fread( chunk, 1, 8, file ) == 8 )
+    {
+        unsigned int size = le32( chunk + 4 );
+        if( !memcmp( chunk, "fmt ", 4 ) && size >= 16 )
+        {
+            std::vector<unsigned char> fmt( size );
+            if( fread( &fmt[0], 1, size, file ) != size ) break;
+            format = le16( &fmt[0] );
+            channels = le16( &fmt[2] );
+            srate = le32( &fmt[4] );
+            bits = le16( &fmt[14] );
+            // WAVE_FORMAT_EXTENSIBLE: the real format leads the sub-format GUID
+            if( format == 0xFFFE && size >= 26 ) format = le16( &fmt[24] );
+        }
+        else if( !memcmp( chunk, "data", 4 ) )
+        {
+            // clamp to what's left (streamed .wavs write 0xFFFFFFFF here)
+            long here = ftell( file );
+            fseek( file, 0, SEEK_END );
+            long left = ftell( file ) - here;
+            fseek( file, here, SEEK_SET );
+            if( left < 0 ) left = 0;
+            if( size > (unsigned long)left ) size = (unsigned int)left;
+            data.resize( size );
+            if( size ) data.resize( fread( &data[0], 1, size, file ) );
+            break;
+        }
+        else
+        {
+            // skip (chunks are padded to even sizes)
+            fseek( file, size + ( size & 1 ), SEEK_CUR );
+        }
+    }
+    fclose( file );
+
+    // check
+    unsigned int bytes = bits / 8;
+    bool pcm = format == 1 && ( bits == 8 || bits == 16 || bits == 24 || bits == 32 );
+    bool flt = format == 3 && ( bits == 32 || bits == 64 );
+    if( channels <= 0 || ( !pcm && !flt ) )
+    {
+        // error message
+        cerr << "[y-convolver]: '" << path << "': unsupported format "
+             << format << " (" << bits << "-bit)..." << endl;
+        return false;
+    }
+
+    // convert
+    size_t count = data.size() / bytes;
+    out.resize( count - count % channels );
+    for( size_t i = 0; i < out.size(); i++ )
+    {
+        const unsigned char * p = &data[i * bytes];
+        if( flt && bits == 32 )
+        {
+            unsigned int u = le32( p ); float f;
+            memcpy( &f, &u, 4 ); out[i] = f;
+        }
+        else if( flt )
+        {
+            unsigned long long u = le32( p ) | ( (unsigned long long)le32( p + 4 ) << 32 );
+            double d; memcpy( &d, &u, 8 ); out[i] = (float)d;
+        }
+        else if( bits == 8 ) out[i] = ( p[0] - 128 ) / 128.0f;
+        else if( bits == 16 ) out[i] = (short)le16( p ) / 32768.0f;
+        else if( bits == 24 ) out[i] = ( (int)( ( p[0] << 8 ) | ( p[1] << 16 ) | ( (unsigned int)p[2] << 24 ) ) >> 8 ) / 8388608.0f;
+        else out[i] = (int)le32( p ) / 2147483648.0f;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YConvolver()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YConvolver::YConvolver( unsigned int blockSize )
+    : m_length( 0 ), m_numIR( 0 ), m_numParts( 0 ), m_fdlPos( 0 ), m_fill( 0 ),
+      m_acc( NULL ), m_scratch( NULL ), m_fxMix( 1 )
+{
+    // power of 2 (rfft), at least 4 (the direct part is unrolled by 4)
+    m_block = 4;
+    while( m_block < blockSize ) m_block <<= 1;
+    // its transform (shared, made now rather than on the audio thread)
+    m_fft = YFFTPlan::get( m_block );
+
+    for( int i = 0; i < YCONV_MAX_CHANNELS; i++ )
+        m_head[i] = m_spectra[i] = m_input[i] = m_fdl[i] = m_tail[i] = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YConvolver()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YConvolver::~YConvolver()
+{
+    cleanup();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cleanup()
+// desc: free everything
+//-----------------------------------------------------------------------------
+void YConvolver::cleanup()
+{
+    for( int i = 0; i < YCONV_MAX_CHANNELS; i++ )
+    {
+        SAFE_DELETE_ARRAY( m_head[i] );
+        SAFE_DELETE_ARRAY( m_spectra[i] );
+        SAFE_DELETE_ARRAY( m_input[i] );
+        SAFE_DELETE_ARRAY( m_fdl[i] );
+        SAFE_DELETE_ARRAY( m_tail[i] );
+    }
+    SAFE_DELETE_ARRAY( m_acc );
+    SAFE_DELETE_ARRAY( m_scratch );
+    m_length = 0;
+    m_numIR = 0;
+    m_numParts = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: load()
+// desc: load an impulse response from a .wav
+//-----------------------------------------------------------------------------
+bool YConvolver::load( const std::string & path, int srate )
+{
+    std::vector<float> ir;
+    int channels = 0, rate = srate;
+    if( !read_wav( path, ir, channels, rate ) )
+        return false;
+
+    // nothing in it
+    unsigned long frames = ir.size() / channels;
+    if( frames == 0 )
+    {
+        // error message
+        cerr << "[y-convolver]: '" << path << "' has no samples..." << endl;
+        return false;
+    }
+
+    // keep at most two channels
+    int keep = channels < YCONV_MAX_CHANNELS ? channels : YCONV_MAX_CHANNELS;
+    if( keep != channels )
+    {
+        for( unsigned long i = 0; i < frames; i++ )
+            for( int c = 0; c < keep; c++ )
+                ir[i*keep + c] = ir[i*channels + c];
+        channels = keep;
+        ir.resize( frames * keep );
+    }
+
+    // resample (linear; an impulse response doesn't need better)
+    if( rate > 0 && rate != srate && frames > 1 )
+    {
+        double step = (double)rate / srate;
+        unsigned long count = (unsigned long)( ( frames - 1 ) / step ) + 1;
+        std::vector<float> resampled( count * channels );
+        for( unsigned long i = 0; i < count; i++ )
+        {
+            double where = i * step;
+            unsigned long j = (unsigned long)where;
+            float frac = (float)( where - j );
+            for( int c = 0; c < channels; c++ )
+            {
+                float a = ir[j*channels + c];
+                float b = j + 1 < frames ? ir[(j+1)*channels + c] : 0;
+                resampled[i*channels + c] = a + frac * ( b - a );
+            }
+        }
+        ir.swap( resampled );
+        frames = count;
+    }
+
+    // log
+    cerr << "[y-convolver]: loaded '" << path << "': " << frames << " frames ("
+         << (float)frames / srate << "s), " << channels << " channel(s)" << endl;
+
+    return set( &ir[0], frames, channels );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set()
+// desc: set an impulse response; cut it up and transform the partitions
+//-----------------------------------------------------------------------------
+bool YConvolver::set( const float * ir, unsigned long numFrames, int numChannels )
+{
+    // sanity check
+    if( numChannels < 1 || numChannels > YCONV_MAX_CHANNELS )
+        return false;
+
+    cleanup();
+    if( numFrames == 0 ) return true;
+
+    unsigned int B = m_block;
+    unsigned int N2 = 2 * B;
+    m_length = numFrames;
+    m_numIR = numChannels;
+    m_numParts = ( numFrames + B - 1 ) / B - 1;
+
+    // the impulse response(s)
+    float * temp = new float[N2];
+    for( int c = 0; c < m_numIR; c++ )
+    {
+        // first partition, time reversed
+        m_head[c] = new float[B]();
+        for( unsigned int i = 0; i < B && i < numFrames; i++ )
+            m_head[c][B - 1 - i] = ir[i * numChannels + c];
+
+        // the rest, transformed (scaled by 2B: y-fft's round trip is 1/2B)
+        m_spectra[c] = new float[m_numParts * N2]();
+        for( unsigned int p = 0; p < m_numParts; p++ )
+        {
+            memset( temp, 0, sizeof(float) * N2 );
+            unsigned long start = ( p + 1 ) * (unsigned long)B;
+            for( unsigned int i = 0; i < B && start + i < numFrames; i++ )
+                temp[i] = ir[( start + i ) * numChannels + c] * N2;
+            m_fft->rfft( temp, FFT_FORWARD );
+            // split
+            float * re = m_spectra[c] + p * N2;
+            float * im = re + B;
+            for( unsigned int k = 0; k < B; k++ )
+            {
+                re[k] = temp[2*k];
+                im[k] = temp[2*k + 1];
+            }
+        }
+    }
+    SAFE_DELETE_ARRAY( temp );
+
+    // state
+    for( int c = 0; c < YCONV_MAX_CHANNELS; c++ )
+    {
+        m_input[c] = new float[N2]();
+        m_fdl[c] = new float[m_numParts * N2]();
+        m_tail[c] = new float[B]();
+    }
+    m_acc = new float[N2]();
+    m_scratch = new float[N2]();
+    m_fdlPos = 0;
+    m_fill = 0;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: clear the input history
+//-----------------------------------------------------------------------------
+void YConvolver::clear()
+{
+    if( m_length == 0 ) return;
+    for( int c = 0; c < YCONV_MAX_CHANNELS; c++ )
+    {
+        memset( m_input[c], 0, sizeof(float) * 2 * m_block );
+        memset( m_fdl[c], 0, sizeof(float) * m_numParts * 2 * m_block );
+        memset( m_tail[c], 0, sizeof(float) * m_block );
+    }
+    m_fill = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: synthesize2()
+// desc: fill buffer (interleaved stereo, in place)
+//-----------------------------------------------------------------------------
+int YConvolver::synthesize2( float * buffer, unsigned int numFrames )
+{
+    float mix = m_fxMix;
+    // nothing loaded: just the dry part
+    if( m_length == 0 )
+    {
+        for( unsigned int i = 0; i < numFrames * 2; i++ )
+            buffer[i] *= 1 - mix;
+        return 0;
+    }
+
+    unsigned int B = m_block;
+    for( unsigned int done = 0; done < numFrames; )
+    {
+        // up to the next boundary
+        unsigned int n = numFrames - done;
+        if( n > B - m_fill ) n = B - m_fill;
+
+        for( int c = 0; c < YCONV_MAX_CHANNELS; c++ )
+        {
+            float * buf = buffer + done * 2 + c;
+            float * in = m_input[c];
+            const float * head = m_head[c < m_numIR ? c : 0];
+            const float * tail = m_tail[c] + m_fill;
+            for( unsigned int i = 0; i < n; i++ )
+            {
+                float x = buf[2*i];
+                in[B + m_fill + i] = x;
+                // first partition, directly, against the last B inputs
+                const float * past = in + m_fill + i + 1;
+                float y0 = 0, y1 = 0, y2 = 0, y3 = 0;
+                for( unsigned int j = 0; j < B; j += 4 )
+                {
+                    y0 += past[j] * head[j];
+                    y1 += past[j+1] * head[j+1];
+                    y2 += past[j+2] * head[j+2];
+                    y3 += past[j+3] * head[j+3];
+                }
+                // plus the rest
+                float y = ( y0 + y1 ) + ( y2 + y3 ) + tail[i];
+                buf[2*i] = x + mix * ( y - x );
+            }
+        }
+
+        m_fill += n;
+        done += n;
+        // a block is in
+        if( m_fill == B ) boundary();
+    }
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: boundary()
+// desc: a block is in: transform the last 2B inputs into the delay line,
+//       multiply-accumulate against every later partition, and invert to
+//       get the next block's tail
+//-----------------------------------------------------------------------------
+void YConvolver::boundary()
+{
+    unsigned int B = m_block;
+    unsigned int N2 = 2 * B;
+
+    if( m_numParts > 0 )
+    {
+        // newest goes one slot back; older ones follow it
+        m_fdlPos = ( m_fdlPos + m_numParts - 1 ) % m_numParts;
+
+        for( int c = 0; c < YCONV_MAX_CHANNELS; c++ )
+        {
+            // transform the input (split into the delay line)
+            memcpy( m_scratch, m_input[c], sizeof(float) * N2 );
+            m_fft->rfft( m_scratch, FFT_FORWARD );
+            float * xr = m_fdl[c] + m_fdlPos * N2;
+            float * xi = xr + B;
+            for( unsigned int k = 0; k < B; k++ )
+            {
+                xr[k] = m_scratch[2*k];
+                xi[k] = m_scratch[2*k + 1];
+            }
+
+            // multiply-accumulate: X[newest - p] * H[p + 1]
+            float * ar = m_acc;
+            float * ai = m_acc + B;
+            memset( m_acc, 0, sizeof(float) * N2 );
+            const float * H = m_spectra[c < m_numIR ? c : 0];
+            for( unsigned int p = 0; p < m_numParts; p++ )
+            {
+                unsigned int slot = m_fdlPos + p;
+                if( slot >= m_numParts ) slot -= m_numParts;
+                const float * XR = m_fdl[c] + slot * N2;
+                const float * XI = XR + B;
+                const float * HR = H + p * N2;
+                const float * HI = HR + B;
+                // DC and Nyquist (both real)
+                ar[0] += XR[0] * HR[0];
+                ai[0] += XI[0] * HI[0];
+                // the rest
+                for( unsigned int k = 1; k < B; k++ )
+                {
+                    ar[k] += XR[k] * HR[k] - XI[k] * HI[k];
+                    ai[k] += XR[k] * HI[k] + XI[k] * HR[k];
+                }
+            }
+
+            // back (interleaved), keep the last B (overlap-save)
+            for( unsigned int k = 0; k < B; k++ )
+            {
+                m_scratch[2*k] = ar[k];
+                m_scratch[2*k + 1] = ai[k];
+            }
+            m_fft->rfft( m_scratch, FFT_INVERSE );
+            memcpy( m_tail[c], m_scratch + B, sizeof(float) * B );
+        }
+    }
+
+    // slide the input along
+    for( int c = 0; c < YCONV_MAX_CHANNELS; c++ )
+        memcpy( m_input[c], m_input[c] + B, sizeof(float) * B );
+    m_fill = 0;
+}
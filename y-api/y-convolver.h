@@ -0,0 +1,137 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-convolver.h
+// desc: convolution reverb: uniformly partitioned, overlap-save, on y-fft;
+//       the first partition runs in the time domain, so any block size
+//       (down to one frame) gets out with no added latency
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_CONVOLVER_H__
+#define __MCD_Y_CONVOLVER_H__
+
+#include <string>
+
+// forward reference
+class YFFTPlan;
+
+// default partition size (frames; power of 2)
+#define YCONV_BLOCK 256
+// max channels
+#define YCONV_MAX_CHANNELS 2
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YConvolver
+// desc: convolution reverb (interleaved stereo, in place)
+//
+//   the impulse response h is cut into partitions of B frames; h0 is run
+//   directly against the last B inputs, every sample; each later one is
+//   kept as the spectrum of [ hp | B zeros ] (2B point rfft). at each B
+//   boundary the last 2B inputs are transformed once into a frequency
+//   domain delay line, and the next block's tail is the inverse of
+//   sum_p( X[boundary - p + 1] * H[p] ) (last B points; overlap-save)
+//-----------------------------------------------------------------------------
+class YConvolver
+{
+public:
+    // constructor
+    YConvolver( unsigned int blockSize = YCONV_BLOCK );
+    // destructor
+    virtual ~YConvolver();
+
+public: // not while processing
+    // load an impulse response from a .wav (16/24/32-bit PCM or 32-bit
+    // float, mono or stereo), resampled to srate if needed
+    bool load( const std::string & path, int srate );
+    // set an impulse response (numChannels 1 or 2, interleaved)
+    bool set( const float * ir, unsigned long numFrames, int numChannels );
+    // clear the input history
+    void clear();
+
+public:
+    // fill buffer (interleaved stereo, in place)
+    virtual int synthesize2( float * buffer, unsigned int numFrames );
+    // wet/dry (1 == all reverb, e.g., on a send)
+    void setFxMix( float mix ) { m_fxMix = mix; }
+    // impulse response length (frames)
+    unsigned long length() const { return m_length; }
+    // number of partitions
+    unsigned int partitions() const { return m_numParts + 1; }
+
+protected:
+    // at a partition boundary: transform, multiply-accumulate, invert
+    void boundary();
+    // free everything
+    void cleanup();
+
+protected:
+    // partition size
+    unsigned int m_block;
+    // 2B point real fft
+    const YFFTPlan * m_fft;
+    // impulse response length / channels (1: same for both)
+    unsigned long m_length;
+    int m_numIR;
+    // frequency domain partitions (after the first)
+    unsigned int m_numParts;
+
+    // first partition, time reversed (per IR)
+    float * m_head[YCONV_MAX_CHANNELS];
+    // later partitions' spectra, numParts x 2B (per IR)
+    float * m_spectra[YCONV_MAX_CHANNELS];
+    // the last two blocks of input: [ previous | current ] (per channel)
+    float * m_input[YCONV_MAX_CHANNELS];
+    // (spectra are stored split: B real parts, then B imaginary parts,
+    // with DC and Nyquist, both real, in the first of each)
+    // past input spectra, numParts x 2B, newest at m_fdlPos (per channel)
+    float * m_fdl[YCONV_MAX_CHANNELS];
+    unsigned int m_fdlPos;
+    // this block's tail (per channel)
+    float * m_tail[YCONV_MAX_CHANNELS];
+    // frames into the current block
+    unsigned int m_fill;
+    // scratch (2B each): split accumulator, interleaved transform
+    float * m_acc;
+    float * m_scratch;
+
+    // wet/dry
+    float m_fxMix;
+};
+
+
+
+
+#endif
@@ -28,6 +28,7 @@
   U.S.A.
 -----------------------------------------------------------------------------*/
 
+
 //-----------------------------------------------------------------------------
 // name: y-echo.cpp
 // name: feedback echo effect
@@ -37,6 +38,138 @@
 //-----------------------------------------------------------------------------
 #include "y-echo.h"
 #include "x-fun.h"
+#include <math.h>
+#include <string.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YDelayLine()
+// desc: constructor (see init())
+//-----------------------------------------------------------------------------
+YDelayLine::YDelayLine()
+{
+    m_line = NULL;
+    m_length = 0;
+    m_writeIndex = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YDelayLine()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YDelayLine::~YDelayLine()
+{
+    SAFE_DELETE_ARRAY( m_line );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: init()
+// desc: allocate for delays up to maxDelay samples
+//-----------------------------------------------------------------------------
+void YDelayLine::init( long maxDelay )
+{
+    // length: max delay plus a block, rounded up to a power of 2
+    long need = maxDelay + YDELAYLINE_BLOCK + 2;
+    for( m_length = 1; m_length < need; m_length <<= 1 ) { }
+
+    // allocate (plus the mirror)
+    SAFE_DELETE_ARRAY( m_line );
+    m_line = new float[m_length + YDELAYLINE_BLOCK + 1];
+    m_writeIndex = 0;
+    clear();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: zero the line (and its mirror)
+//-----------------------------------------------------------------------------
+void YDelayLine::clear()
+{
+    if( m_line ) memset( m_line, 0, sizeof(float) * (m_length + YDELAYLINE_BLOCK + 1) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read()
+// desc: read a block; delay in samples, ramping by dInc
+//-----------------------------------------------------------------------------
+void YDelayLine::read( float * out, long numFrames, float d0, float dInc ) const
+{
+    const float * line = m_line;
+    long mask = m_length - 1;
+    long w = m_writeIndex;
+
+    if( dInc == 0 )
+    {
+        // steady delay: one fraction, one contiguous run (thanks to the mirror)
+        long di = (long)d0;
+        float alpha = d0 - di;
+        // sample at w-d lies between w-di-1 (weight alpha) and w-di
+        long r = ( w - di - 1 ) & mask;
+        for( long i = 0; i < numFrames; i++ )
+            out[i] = line[r+i] * alpha + line[r+i+1] * (1 - alpha);
+    }
+    else
+    {
+        // ramping delay: fractional read position per sample
+        for( long i = 0; i < numFrames; i++ )
+        {
+            float d = d0 + dInc * i;
+            long di = (long)d;
+            float alpha = d - di;
+            long r = ( w + i - di - 1 ) & mask;
+            out[i] = line[r] * alpha + line[r+1] * (1 - alpha);
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: write()
+// desc: write a block of in + fb * feedback at the write position
+//-----------------------------------------------------------------------------
+void YDelayLine::write( const float * in, const float * feedback, long numFrames,
+                        float fb0, float fbInc )
+{
+    float * line = m_line;
+    long w = m_writeIndex;
+
+    // up to two contiguous runs
+    long first = m_length - w;
+    if( first > numFrames ) first = numFrames;
+    float fb = fb0;
+    for( long i = 0; i < first; i++, fb += fbInc )
+        line[w+i] = in[i] + fb * feedback[i];
+    for( long i = first; i < numFrames; i++, fb += fbInc )
+        line[i-first] = in[i] + fb * feedback[i];
+    // keep the mirror in step with the start of the line
+    if( w + numFrames > m_length )
+    {
+        long n = w + numFrames - m_length;
+        if( n > YDELAYLINE_BLOCK + 1 ) n = YDELAYLINE_BLOCK + 1;
+        memcpy( line + m_length, line, sizeof(float) * n );
+    }
+    else if( w <= YDELAYLINE_BLOCK )
+    {
+        long end = w + numFrames < YDELAYLINE_BLOCK + 1 ? w + numFrames : YDELAYLINE_BLOCK + 1;
+        memcpy( line + m_length + w, line + w, sizeof(float) * (end - w) );
+    }
+}
 
 
 
@@ -53,41 +186,26 @@ YEcho::YEcho( int srate, float maxDelay, float delaySeconds,
     
     // sanity check
     assert( numChannels > 0 );
-    assert( numChannels <= 2 );
+    assert( numChannels <= YECHO_MAX_CHANNELS );
     
     // num channels
     m_numChannels = numChannels;
-    
-    // allocate
-    m_delay = new stk::DelayL[m_numChannels];
-    m_delaySamples = new float[m_numChannels];
-    m_iDelay = new Vector3D[m_numChannels];
-
     // set max delay
-    m_maxDelay = maxDelay;    
-    // set feedback
-    m_feedbackCoefficient = feedbackCoefficient;
-    // set fxMix
-    m_fxMix = fxMix;
-    
-    // iterate
+    m_maxDelay = maxDelay;
+
+    // allocate (everything up front; nothing in synthesize2())
     for( int i = 0; i < m_numChannels; i++ )
-    {
-        // set max
-        m_delay[i].setMaximumDelay( m_srate * m_maxDelay );
-        // set delay
-        m_delaySamples[i] = delaySeconds * m_srate;
-        // set delay
-        m_delay[i].setDelay( m_delaySamples[i] );
-        // clear delay
-        m_delay[i].clear();
-        // set slew
-        m_iDelay[i].set( delaySeconds, delaySeconds, 5 );
-    }
+        m_line[i].init( (long)( m_srate * m_maxDelay ) );
+    m_in = new float[YECHO_BLOCK];
+    m_out = new float[YECHO_BLOCK];
 
-    // set slew
-    m_iFeedback.set( m_feedbackCoefficient, m_feedbackCoefficient, 1 );
-    m_iFxMix.set( m_fxMix, m_fxMix, 1 );
+    // clamp
+    delaySeconds = XFun::clampf( delaySeconds, 0, m_maxDelay );
+    // set slews
+    for( int i = 0; i < m_numChannels; i++ )
+        m_iDelay[i].set( delaySeconds, delaySeconds, 5 );
+    m_iFeedback.set( feedbackCoefficient, feedbackCoefficient, 1 );
+    m_iFxMix.set( fxMix, fxMix, 1 );
 
     // toggle
     toggle( false );
@@ -103,14 +221,21 @@ YEcho::YEcho( int srate, float maxDelay, float delaySeconds,
 YEcho::~YEcho()
 {
     // clean up
-    delete [] m_delay;
-    delete [] m_delaySamples;
-    delete [] m_iDelay;
-    
-    // zero
-    m_delay = NULL;
-    m_delaySamples = NULL;
-    m_iDelay = NULL;
+    SAFE_DELETE_ARRAY( m_in );
+    SAFE_DELETE_ARRAY( m_out );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: clear the delay lines
+//-----------------------------------------------------------------------------
+void YEcho::clear()
+{
+    for( int i = 0; i < m_numChannels; i++ )
+        m_line[i].clear();
 }
 
 
@@ -165,41 +290,114 @@ void YEcho::setFxMix( float mix )
 
 
 
+//-----------------------------------------------------------------------------
+// name: advance()
+// desc: advance a slew by numFrames samples at once (same curve as calling
+//       interp( 1/srate ) per sample); returns the new value
+//-----------------------------------------------------------------------------
+float YEcho::advance( Vector3D & slew, unsigned int numFrames )
+{
+    // settled
+    if( slew.value == slew.goal ) return slew.value;
+
+    // value -> goal, geometrically, per sample
+    float k = 1.0f - slew.slew / m_srate;
+    slew.value = slew.goal + (slew.value - slew.goal) * powf( k, (float)numFrames );
+    // close enough
+    if( fabsf( slew.value - slew.goal ) < 1e-6f ) slew.value = slew.goal;
+
+    return slew.value;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: processChannel()
+// desc: one channel, one block (m_in -> m_out); delay in samples, and all
+//       parameters ramp linearly from the given start by the given step
+//-----------------------------------------------------------------------------
+void YEcho::processChannel( int chan, long numFrames, float d0, float dInc,
+                            float fb0, float fbInc, float mix0, float mixInc )
+{
+    float * in = m_in;
+    float * out = m_out;
+
+    // read, then write input + feedback
+    m_line[chan].read( out, numFrames, d0, dInc );
+    m_line[chan].write( in, out, numFrames, fb0, fbInc );
+
+    // mix
+    float mix = mix0;
+    for( long i = 0; i < numFrames; i++, mix += mixInc )
+        out[i] = in[i] + mix * ( out[i] - in[i] );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: synthesize2()
-// desc: do it!
+// desc: do it! (interleaved, in place)
 //-----------------------------------------------------------------------------
 int YEcho::synthesize2( float * buffer, unsigned int numFrames )
 {
-    // format
-    int frames = numFrames;
-    int channels = m_numChannels;
-    float * data = (float *)buffer;
+    // parameters at the start and the end of the buffer
+    float fbStart = m_iFeedback.value;
+    float fbEnd = advance( m_iFeedback, numFrames );
+    float mixStart = m_iFxMix.value;
+    float mixEnd = advance( m_iFxMix, numFrames );
+    float dStart[YECHO_MAX_CHANNELS], dEnd[YECHO_MAX_CHANNELS];
+    for( int j = 0; j < m_numChannels; j++ )
+    {
+        dStart[j] = m_iDelay[j].value * m_srate;
+        dEnd[j] = advance( m_iDelay[j], numFrames ) * m_srate;
+    }
+
+    // per-sample steps
+    float fbInc = ( fbEnd - fbStart ) / numFrames;
+    float mixInc = ( mixEnd - mixStart ) / numFrames;
 
-    // iterate
-    for( int i = 0; i < frames; i++ )
+    // blocks
+    for( unsigned int done = 0; done < numFrames; )
     {
-        float input_sample = 0.0;
-        float output_sample = 0.0;
+        // block size: a read must never see this block's writes, so no
+        // longer than the shortest delay in it
+        long n = numFrames - done;
+        if( n > YECHO_BLOCK ) n = YECHO_BLOCK;
+        for( int j = 0; j < m_numChannels; j++ )
+        {
+            float dInc = ( dEnd[j] - dStart[j] ) / numFrames;
+            float a = dStart[j] + dInc * done;
+            float b = a + dInc * n;
+            long shortest = (long)( a < b ? a : b );
+            if( shortest < 1 ) shortest = 1;
+            if( n > shortest ) n = shortest;
+        }
 
-        // iterate
-        for( int j = 0; j < channels; j++ )
+        for( int j = 0; j < m_numChannels; j++ )
         {
-            // interp
-            m_iDelay[j].interp( 1.0f / m_srate );
-            // set the delay
-            m_delaySamples[j] = m_srate * m_iDelay[j].value;
-            m_delay[j].setDelay( m_delaySamples[j] );
-            // get input
-            input_sample = data[i * channels + j];
-            // get delay output
-            output_sample = m_delay[j].nextOut();
-            // feedback
-            m_delay[j].tick( input_sample + output_sample * m_feedbackCoefficient );
-
-            // mix
-            data[i * channels + j] = (1 - m_fxMix)*input_sample + m_fxMix*output_sample;
+            // delay (in samples) across this block; at least one sample
+            float dInc = ( dEnd[j] - dStart[j] ) / numFrames;
+            float d0 = dStart[j] + dInc * done;
+            if( d0 < 1 ) d0 = 1;
+
+            // deinterleave
+            for( long i = 0; i < n; i++ )
+                m_in[i] = buffer[(done+i)*m_numChannels + j];
+            // process
+            processChannel( j, n, d0, d0 + dInc * n < 1 ? 0 : dInc,
+                            fbStart + fbInc * done, fbInc,
+                            mixStart + mixInc * done, mixInc );
+            // interleave
+            for( long i = 0; i < n; i++ )
+                buffer[(done+i)*m_numChannels + j] = m_out[i];
         }
+
+        // advance
+        for( int j = 0; j < m_numChannels; j++ )
+            m_line[j].advance( n );
+        done += n;
     }
     
     // return frames
@@ -28,6 +28,7 @@
   U.S.A.
 -----------------------------------------------------------------------------*/
 
+
 //-----------------------------------------------------------------------------
 // name: y-echo.h
 // name: feedback echo effect
@@ -38,15 +39,60 @@
 #ifndef __MCD_Y_ECHO_H__
 #define __MCD_Y_ECHO_H__
 
-#include "DelayL.h"
 #include "x-vector3d.h"
 
+// most frames a YDelayLine reads or writes at once (its mirrored tail)
+#define YDELAYLINE_BLOCK 256
+// frames processed per inner block
+#define YECHO_BLOCK YDELAYLINE_BLOCK
+// max channels
+#define YECHO_MAX_CHANNELS 2
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YDelayLine
+// desc: float delay line for block processing: power of 2 long, plus a
+//       YDELAYLINE_BLOCK+1 mirror of the start, so a block of reads never
+//       has to wrap; linear interpolation (shared by YEcho, YTapDelay)
+//-----------------------------------------------------------------------------
+class YDelayLine
+{
+public:
+    YDelayLine();
+    ~YDelayLine();
+
+public:
+    // allocate for delays up to maxDelay samples (before the audio starts)
+    void init( long maxDelay );
+    // zero it
+    void clear();
+
+public: // audio (numFrames <= YDELAYLINE_BLOCK, and no more than the delay)
+    // read a block at delay d0 samples (>= 1), ramping by dInc per sample
+    void read( float * out, long numFrames, float d0, float dInc ) const;
+    // write a block: in + fb * feedback, fb ramping from fb0 by fbInc
+    void write( const float * in, const float * feedback, long numFrames,
+                float fb0, float fbInc );
+    // move the write position past the block just written
+    void advance( long numFrames )
+    { m_writeIndex = ( m_writeIndex + numFrames ) & ( m_length - 1 ); }
+
+protected:
+    float * m_line;
+    long m_length;
+    // next write position
+    long m_writeIndex;
+};
+
 
 
 
 //-----------------------------------------------------------------------------
 // name: class YEcho
-// desc: feedback echo effect
+// desc: feedback echo effect (float, block at a time; parameters ramp
+//       linearly across each block)
 //-----------------------------------------------------------------------------
 class YEcho
 {
@@ -58,28 +104,39 @@ public:
     virtual ~YEcho();
 
 public:
-    // fill buffer
+    // fill buffer (interleaved stereo, in place)
     virtual int synthesize2( float * buffer, unsigned int numFrames );
     // toggle
     virtual void toggle( bool onOff );
+    // clear the delay lines
+    void clear();
 
 public:
     void setDelay( int chan, float inSeconds );
     void setFeedback( float coef );
     void setFxMix( float mix );
 
+protected:
+    // one channel, one block
+    void processChannel( int chan, long numFrames, float d0, float dInc,
+                         float fb0, float fbInc, float mix0, float mixInc );
+    // advance a slew by numFrames samples; returns the new value
+    float advance( Vector3D & slew, unsigned int numFrames );
+
 private:
     // delay
     float m_srate;
     int m_numChannels;
-    stk::DelayL * m_delay;
-    float * m_delaySamples;
     float m_maxDelay;
-    float m_feedbackCoefficient;
-    float m_fxMix;
 
-    // slews
-    Vector3D * m_iDelay;
+    // delay lines
+    YDelayLine m_line[YECHO_MAX_CHANNELS];
+    // scratch: one block of one channel
+    float * m_in;
+    float * m_out;
+
+    // slews (delay in seconds)
+    Vector3D m_iDelay[YECHO_MAX_CHANNELS];
     Vector3D m_iFeedback;
     Vector3D m_iFxMix;
     
@@ -36,11 +36,43 @@
 // date: spring 2011
 //-----------------------------------------------------------------------------
 #include "y-entity.h"
+#include "y-scene.h"
 #include "x-fun.h"
+#include "x-workers.h"
 #include <iostream>
 using namespace std;
 
 
+// update pool (see setUpdatePool()), and whether a fork is under way
+static XWorkerPool * g_updatePool = NULL;
+static bool g_forked = false;
+
+// a parallel update of children
+struct YEntityFork
+{
+    YEntity * const * children;
+    unsigned long count;
+    unsigned long grain;
+    YTimeInterval dt;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update_subtrees()
+// desc: update one job's worth of children (XWorkerJob)
+//-----------------------------------------------------------------------------
+static void update_subtrees( int index, void * data )
+{
+    YEntityFork * f = (YEntityFork *)data;
+    unsigned long begin = index * f->grain;
+    unsigned long end = begin + f->grain < f->count ? begin + f->grain : f->count;
+    for( unsigned long i = begin; i < end; i++ )
+        f->children[i]->updateAll( f->dt );
+}
+
+
 
 
 //-----------------------------------------------------------------------------
@@ -52,8 +84,23 @@ void YEntity::updateAll( YTimeInterval dt )
     // check
     if( !active ) return;
 
-    // update self
-    update( dt );
+    // update self (unless there's nothing to do)
+    if( !settled() ) update( dt );
+
+    // children in parallel
+    if( independent && children.size() > 1 && forkable() )
+    {
+        YEntityFork f;
+        f.children = &children[0];
+        f.count = children.size();
+        f.dt = dt;
+        int jobs = split( f.count, f.grain );
+        if( jobs > 1 )
+        {
+            fork( update_subtrees, &f, jobs );
+            return;
+        }
+    }
     
     // update children
     for( vector<YEntity *>::iterator itr = children.begin(); 
@@ -66,6 +113,78 @@ void YEntity::updateAll( YTimeInterval dt )
 
 
 
+//-----------------------------------------------------------------------------
+// name: setUpdatePool()
+// desc: pool for updating independent subtrees
+//-----------------------------------------------------------------------------
+void YEntity::setUpdatePool( XWorkerPool * pool )
+{
+    g_updatePool = pool;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: forkable()
+// desc: the pool, if there is one with workers and no fork under way (an
+//       independent subtree inside another one runs serially)
+//-----------------------------------------------------------------------------
+XWorkerPool * YEntity::forkable()
+{
+    if( g_updatePool == NULL || g_updatePool->size() == 0 || g_forked )
+        return NULL;
+
+    return g_updatePool;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fork()
+// desc: run jobs on the pool, with the caller helping; returns when done
+//-----------------------------------------------------------------------------
+void YEntity::fork( void (* job)( int, void * ), void * data, int count )
+{
+    g_forked = true;
+    g_updatePool->run( job, data, count );
+    g_forked = false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: split()
+// desc: a few jobs per thread, but no fewer than YENTITY_PARALLEL_GRAIN
+//       entities each
+//-----------------------------------------------------------------------------
+int YEntity::split( unsigned long n, unsigned long & grain )
+{
+    unsigned long jobs = ( g_updatePool->size() + 1 ) * YENTITY_PARALLEL_SPLIT;
+    grain = ( n + jobs - 1 ) / jobs;
+    if( grain < YENTITY_PARALLEL_GRAIN ) grain = YENTITY_PARALLEL_GRAIN;
+
+    return (int)( ( n + grain - 1 ) / grain );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wake()
+// desc: back into the scene's active set (tree entities check settled()
+//       every frame, so there's nothing to do for them)
+//-----------------------------------------------------------------------------
+void YEntity::wake()
+{
+    if( scene != NULL ) scene->wake( this );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: updateAllPostRender()
 //
@@ -102,6 +221,7 @@ std::string YEntity::desc() const
 
 
 
+#if defined(__BLOCKS__)
 //-----------------------------------------------------------------------------
 // name: apply
 // desc: applies a block of code to this entity and the entire subtree
@@ -118,6 +238,7 @@ void YEntity::apply( EntityBlock block )
         (*itr)->apply( block );
     }
 }
+#endif
 
 
 
@@ -395,6 +516,9 @@ void YText::fade( GLfloat _alpha, GLfloat slew )
         // immediate (slew is unchanged)
         m_iAlpha.updateSet( _alpha );
     }
+
+    // moving again
+    wake();
 }
 
 
@@ -406,8 +530,8 @@ void YText::fade( GLfloat _alpha, GLfloat slew )
 //-----------------------------------------------------------------------------
 void YText::update( YTimeInterval dt )
 {
-    // interpolate
-    m_iAlpha.interp( dt );
+    // interpolate (until there)
+    m_iAlpha.approach( dt );
     
     // set it
     alpha = m_iAlpha.value;
@@ -677,6 +801,8 @@ void YBokeh::setBokehParams( GLfloat time, GLfloat freq, GLfloat time_step,
     t_step = time_step;
     iRGB.update( rgb, .5 );
     iLoc.update( xyz, .5 );
+    // moving again
+    wake();
 }
 
 
@@ -691,9 +817,9 @@ void YBokeh::update( YTimeInterval dt )
     // update super
     YFlare::update( dt );
 
-    // interp
-    iRGB.interp( dt );
-    iLoc.interp( dt );
+    // interp (until there)
+    iRGB.approach( dt );
+    iLoc.approach( dt );
     
     // update
     col = iRGB.actual();
@@ -45,13 +45,23 @@
 
 // forward references
 class YEntity;
+class YFlatScene;
+class XWorkerPool;
 
+#if defined(__BLOCKS__)
 // A block that does something with an entity and returns true if it succeeds
 typedef void (^EntityBlock)( YEntity * );
+#endif
 
 // the data type to use for elapsed time
 typedef double YTimeInterval;
 
+// fewest entities per parallel update job (see YEntity::independent)
+#define YENTITY_PARALLEL_GRAIN 64
+// parallel update jobs per thread (the pool hands them out as threads
+// free up, so uneven subtrees even out)
+#define YENTITY_PARALLEL_SPLIT 4
+
 
 
 
@@ -65,7 +75,8 @@ class YEntity
 public:
     // constructor
     YEntity() : parent(NULL), sca(1, 1, 1), col(1, 1, 1), alpha(1), 
-            active(true), selected(false), hidden(false) { }
+            active(true), selected(false), hidden(false), independent(false),
+            scene(NULL) { }
 
 public:
     // use this for anything that even remotely effects the world state.
@@ -75,6 +86,12 @@ public:
     // updates you need to do after render; this is somewhat of a hack,
     // needed by FX to get GL state in render before it can update
     virtual void updatePostRender( YTimeInterval dt ) {}
+    // true when update() has nothing to do (e.g., every slew at its goal,
+    // and what they drive caught up); updateAll() skips update() while so
+    virtual bool settled() const { return false; }
+    // after changing a settled entity's state other than through its own
+    // setters: puts it back in its YFlatScene's active set (if any)
+    void wake();
     
 public:
     // updates with all children
@@ -92,8 +109,13 @@ public:
     // self or any parent selected?
     bool anyParentSelected();
 
+#if defined(__BLOCKS__)
     // apply a block to this entire subtree
     void apply( EntityBlock block );
+#endif
+    // pool for updating independent subtrees (NULL: serial; set it and the
+    // flags from the thread that calls updateAll())
+    static void setUpdatePool( XWorkerPool * pool );
     // print out a scene graph to the console for your amusement
     void dumpSceneGraph( int depth = 0 );
     // set the color of this and all children
@@ -127,6 +149,10 @@ public:
     bool hidden;
     // selected?
     bool selected;
+    // independent -- children's subtrees don't touch each other (or
+    // anything outside themselves) in update(), so updateAll() may run
+    // them in parallel on the update pool; drawing stays serial
+    bool independent;
     // name
     std::string name;
 
@@ -135,12 +161,21 @@ protected:
     void applyTransforms();
     // pop
     void popTransforms();
+    // the update pool, if there is one and we're not already in it
+    static XWorkerPool * forkable();
+    // run job( 0 .. count-1, data ) on the update pool
+    static void fork( void (* job)( int, void * ), void * data, int count );
+    // jobs and entities per job to split n entities into
+    static int split( unsigned long n, unsigned long & grain );
     
 protected: // never set these directly, always use addChild
     // parent in the scene graph
     YEntity * parent;
     // child nodes in the scene graph
     std::vector<YEntity *> children;
+    // the flattened scene we're stored in, if any (see YFlatScene)
+    YFlatScene * scene;
+    friend class YFlatScene;
     
 private:
     // make sure no subclasses are using the old
@@ -179,6 +214,8 @@ public:
 public:
     virtual void update( YTimeInterval dt );
     virtual void render();
+    virtual bool settled() const
+    { return m_iAlpha.settled() && alpha == m_iAlpha.value; }
 
 public:
     // static draw method
@@ -325,7 +362,7 @@ public:
     // is currently active, a question
     virtual bool isActive() const { return active; }
     // set alpha
-    virtual void setAlpha( GLfloat _alpha ) { alpha = _alpha; }
+    virtual void setAlpha( GLfloat _alpha ) { alpha = _alpha; wake(); }
     
 public:
     virtual void update( YTimeInterval dt );
@@ -372,12 +409,17 @@ public:
               GLfloat _alpha_factor, GLuint _texture );
     
     // set alpha
-    virtual void setAlpha( GLfloat _alpha ) { alpha = alpha_actual = _alpha; }
+    virtual void setAlpha( GLfloat _alpha ) { alpha = alpha_actual = _alpha; wake(); }
     // virtual void setAlpha( GLfloat _alpha ) { iAlpha.update( _alpha ); alpha_actual = _alpha; }
 
 public:
     virtual void update( YTimeInterval dt );
     virtual void render();
+    // slews there, no alpha / scale ramps, and not about to go out
+    virtual bool settled() const
+    { return iRGB.settled() && iLoc.settled() && col == iRGB.actual() &&
+             loc == iLoc.actual() && alpha_factor == 1 && scale_factor == 1 &&
+             alpha >= .01f; }
 
     // slew
     iSlew3D iRGB;
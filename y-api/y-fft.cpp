@@ -1,309 +1,964 @@
-/*----------------------------------------------------------------------------
-  Y-API: higher-level objects for audio/graphics/interaction programming
-         (sibling of X-API; part of MCD-API)
-
-  Copyright (c) 2013 Ge Wang
-    All rights reserved.
-    http://ccrma.stanford.edu/~ge/
-
-  Music, Computing, Design API
-    http://ccrma.stanford.edu/~ge/software/mcd-api/
-
-  Music, Computing, Design Group @ CCRMA, Stanford University
-    http://ccrma.stanford.edu/groups/mcd/
-
-  This program is free software; you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation; either version 2 of the License, or
-  (at your option) any later version.
-
-  This program is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with this program; if not, write to the Free Software
-  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
-  U.S.A.
------------------------------------------------------------------------------*/
-
-//-----------------------------------------------------------------------------
-// name: yfft.cpp
-// desc: fft impl - based on CARL distribution and chuck_fft.*
-//
-// authors: code from San Diego CARL package
-//          Ge Wang (ge@ccrma.stanford.edu)
-// date: spring 2013
-//-----------------------------------------------------------------------------
-#include "y-fft.h"
-#include <stdlib.h>
-#include <math.h>
-
-
-
-
-//-----------------------------------------------------------------------------
-// name: hanning()
-// desc: make window
-//-----------------------------------------------------------------------------
-void hanning( SAMPLE * window, unsigned long length )
-{
-    unsigned long i;
-    double pi, phase = 0, delta;
-
-    pi = 4.*atan(1.0);
-    delta = 2 * pi / (double) length;
-
-    for( i = 0; i < length; i++ )
-    {
-        window[i] = (SAMPLE)(0.5 * (1.0 - cos(phase)));
-        phase += delta;
-    }
-}
-
-
-
-
-//-----------------------------------------------------------------------------
-// name: hamming()
-// desc: make window
-//-----------------------------------------------------------------------------
-void hamming( SAMPLE * window, unsigned long length )
-{
-    unsigned long i;
-    double pi, phase = 0, delta;
-
-    pi = 4.*atan(1.0);
-    delta = 2 * pi / (double) length;
-
-    for( i = 0; i < length; i++ )
-    {
-        window[i] = (SAMPLE)(0.54 - .46*cos(phase));
-        phase += delta;
-    }
-}
-
-
-
-//-----------------------------------------------------------------------------
-// name: blackman()
-// desc: make window
-//-----------------------------------------------------------------------------
-void blackman( SAMPLE * window, unsigned long length )
-{
-    unsigned long i;
-    double pi, phase = 0, delta;
-
-    pi = 4.*atan(1.0);
-    delta = 2 * pi / (double) length;
-
-    for( i = 0; i < length; i++ )
-    {
-        window[i] = (SAMPLE)(0.42 - .5*cos(phase) + .08*cos(2*phase));
-        phase += delta;
-    }
-}
-
-
-
-
-//-----------------------------------------------------------------------------
-// name: apply_window()
-// desc: apply a window to data
-//-----------------------------------------------------------------------------
-void apply_window( SAMPLE * data, SAMPLE * window, unsigned long length )
-{
-    unsigned long i;
-
-    for( i = 0; i < length; i++ )
-        data[i] *= window[i];
-}
-
-static SAMPLE PI ;
-static SAMPLE TWOPI ;
-void bit_reverse( SAMPLE * x, long N );
-
-//-----------------------------------------------------------------------------
-// name: rfft()
-// desc: real value fft
-//
-//   these routines from the CARL software, spect.c
-//   check out the CARL CMusic distribution for more source code
-//
-//   if forward is true, rfft replaces 2*N real data points in x with N complex 
-//   values representing the positive frequency half of their Fourier spectrum,
-//   with x[1] replaced with the real part of the Nyquist frequency value.
-//
-//   if forward is false, rfft expects x to contain a positive frequency 
-//   spectrum arranged as before, and replaces it with 2*N real values.
-//
-//   N MUST be a power of 2.
-//
-//-----------------------------------------------------------------------------
-void rfft( SAMPLE * x, long N, unsigned int forward )
-{
-    static int first = 1 ;
-    SAMPLE c1, c2, h1r, h1i, h2r, h2i, wr, wi, wpr, wpi, temp, theta ;
-    SAMPLE xr, xi ;
-    long i, i1, i2, i3, i4, N2p1 ;
-
-    if( first )
-    {
-        PI = (SAMPLE) (4.*atan( 1. )) ;
-        TWOPI = (SAMPLE) (8.*atan( 1. )) ;
-        first = 0 ;
-    }
-
-    theta = PI/N ;
-    wr = 1. ;
-    wi = 0. ;
-    c1 = 0.5 ;
-
-    if( forward )
-    {
-        c2 = -0.5 ;
-        cfft( x, N, forward ) ;
-        xr = x[0] ;
-        xi = x[1] ;
-    }
-    else
-    {
-        c2 = 0.5 ;
-        theta = -theta ;
-        xr = x[1] ;
-        xi = 0. ;
-        x[1] = 0. ;
-    }
-    
-    wpr = (SAMPLE) (-2.*pow( sin( 0.5*theta ), 2. )) ;
-    wpi = (SAMPLE) sin( theta ) ;
-    N2p1 = (N<<1) + 1 ;
-    
-    for( i = 0 ; i <= N>>1 ; i++ )
-    {
-        i1 = i<<1 ;
-        i2 = i1 + 1 ;
-        i3 = N2p1 - i2 ;
-        i4 = i3 + 1 ;
-        if( i == 0 )
-        {
-            h1r =  c1*(x[i1] + xr ) ;
-            h1i =  c1*(x[i2] - xi ) ;
-            h2r = -c2*(x[i2] + xi ) ;
-            h2i =  c2*(x[i1] - xr ) ;
-            x[i1] =  h1r + wr*h2r - wi*h2i ;
-            x[i2] =  h1i + wr*h2i + wi*h2r ;
-            xr =  h1r - wr*h2r + wi*h2i ;
-            xi = -h1i + wr*h2i + wi*h2r ;
-        }
-        else
-        {
-            h1r =  c1*(x[i1] + x[i3] ) ;
-            h1i =  c1*(x[i2] - x[i4] ) ;
-            h2r = -c2*(x[i2] + x[i4] ) ;
-            h2i =  c2*(x[i1] - x[i3] ) ;
-            x[i1] =  h1r + wr*h2r - wi*h2i ;
-            x[i2] =  h1i + wr*h2i + wi*h2r ;
-            x[i3] =  h1r - wr*h2r + wi*h2i ;
-            x[i4] = -h1i + wr*h2i + wi*h2r ;
-        }
-
-        wr = (temp = wr)*wpr - wi*wpi + wr ;
-        wi = wi*wpr + temp*wpi + wi ;
-    }
-
-    if( forward )
-        x[1] = xr ;
-    else
-        cfft( x, N, forward ) ;
-}
-
-
-
-
-//-----------------------------------------------------------------------------
-// name: cfft()
-// desc: complex value fft
-//
-//   these routines from CARL software, spect.c
-//   check out the CARL CMusic distribution for more software
-//
-//   cfft replaces float array x containing NC complex values (2*NC float 
-//   values alternating real, imagininary, etc.) by its Fourier transform 
-//   if forward is true, or by its inverse Fourier transform ifforward is 
-//   false, using a recursive Fast Fourier transform method due to 
-//   Danielson and Lanczos.
-//
-//   NC MUST be a power of 2.
-//
-//-----------------------------------------------------------------------------
-void cfft( SAMPLE * x, long NC, unsigned int forward )
-{
-    SAMPLE wr, wi, wpr, wpi, theta, scale ;
-    long mmax, ND, m, i, j, delta ;
-    ND = NC<<1 ;
-    bit_reverse( x, ND ) ;
-    
-    for( mmax = 2 ; mmax < ND ; mmax = delta )
-    {
-        delta = mmax<<1 ;
-        theta = TWOPI/( forward? mmax : -mmax ) ;
-        wpr = (SAMPLE) (-2.*pow( sin( 0.5*theta ), 2. )) ;
-        wpi = (SAMPLE) sin( theta ) ;
-        wr = 1. ;
-        wi = 0. ;
-
-        for( m = 0 ; m < mmax ; m += 2 )
-        {
-            register SAMPLE rtemp, itemp ;
-            for( i = m ; i < ND ; i += delta )
-            {
-                j = i + mmax ;
-                rtemp = wr*x[j] - wi*x[j+1] ;
-                itemp = wr*x[j+1] + wi*x[j] ;
-                x[j] = x[i] - rtemp ;
-                x[j+1] = x[i+1] - itemp ;
-                x[i] += rtemp ;
-                x[i+1] += itemp ;
-            }
-
-            wr = (rtemp = wr)*wpr - wi*wpi + wr ;
-            wi = wi*wpr + rtemp*wpi + wi ;
-        }
-    }
-
-    // scale output
-    scale = (SAMPLE)(forward ? 1./ND : 2.) ;
-    {
-        register SAMPLE *xi=x, *xe=x+ND ;
-        while( xi < xe )
-            *xi++ *= scale ;
-    }
-}
-
-
-
-
-//-----------------------------------------------------------------------------
-// name: bit_reverse()
-// desc: bitreverse places float array x containing N/2 complex values
-//       into bit-reversed order
-//-----------------------------------------------------------------------------
-void bit_reverse( SAMPLE * x, long N )
-{
-    SAMPLE rtemp, itemp ;
-    long i, j, m ;
-    for( i = j = 0 ; i < N ; i += 2, j += m )
-    {
-        if( j > i )
-        {
-            rtemp = x[j] ; itemp = x[j+1] ; /* complex exchange */
-            x[j] = x[i] ; x[j+1] = x[i+1] ;
-            x[i] = rtemp ; x[i+1] = itemp ;
-        }
-
-        for( m = N>>1 ; m >= 2 && j >= m ; m >>= 1 )
-            j -= m ;
-    }
-}
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: yfft.cpp
+// desc: fft impl - based on CARL distribution and chuck_fft.*
+//
+// authors: code from San Diego CARL package
+//          Ge Wang (ge@ccrma.stanford.edu)
+// date: spring 2013
+//-----------------------------------------------------------------------------
+#include "y-fft.h"
+#include "x-def.h"
+#include "x-simd.h"
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: hanning()
+// desc: make window
+//-----------------------------------------------------------------------------
+void hanning( SAMPLE * window, unsigned long length )
+{
+    unsigned long i;
+    double pi, phase = 0, delta;
+
+    pi = 4.*atan(1.0);
+    delta = 2 * pi / (double) length;
+
+    for( i = 0; i < length; i++ )
+    {
+        window[i] = (SAMPLE)(0.5 * (1.0 - cos(phase)));
+        phase += delta;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: hamming()
+// desc: make window
+//-----------------------------------------------------------------------------
+void hamming( SAMPLE * window, unsigned long length )
+{
+    unsigned long i;
+    double pi, phase = 0, delta;
+
+    pi = 4.*atan(1.0);
+    delta = 2 * pi / (double) length;
+
+    for( i = 0; i < length; i++ )
+    {
+        window[i] = (SAMPLE)(0.54 - .46*cos(phase));
+        phase += delta;
+    }
+}
+
+
+
+//-----------------------------------------------------------------------------
+// name: blackman()
+// desc: make window
+//-----------------------------------------------------------------------------
+void blackman( SAMPLE * window, unsigned long length )
+{
+    unsigned long i;
+    double pi, phase = 0, delta;
+
+    pi = 4.*atan(1.0);
+    delta = 2 * pi / (double) length;
+
+    for( i = 0; i < length; i++ )
+    {
+        window[i] = (SAMPLE)(0.42 - .5*cos(phase) + .08*cos(2*phase));
+        phase += delta;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: apply_window()
+// desc: apply a window to data
+//-----------------------------------------------------------------------------
+void apply_window( SAMPLE * data, SAMPLE * window, unsigned long length )
+{
+    unsigned long i;
+
+    for( i = 0; i < length; i++ )
+        data[i] *= window[i];
+}
+
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rfft()
+// desc: real value fft
+//
+//   these routines from the CARL software, spect.c
+//   check out the CARL CMusic distribution for more source code
+//
+//   if forward is true, rfft replaces 2*N real data points in x with N complex 
+//   values representing the positive frequency half of their Fourier spectrum,
+//   with x[1] replaced with the real part of the Nyquist frequency value.
+//
+//   if forward is false, rfft expects x to contain a positive frequency 
+//   spectrum arranged as before, and replaces it with 2*N real values.
+//
+//   N MUST be a power of 2. (runs the shared YFFTPlan for N)
+//
+//-----------------------------------------------------------------------------
+void rfft( SAMPLE * x, long N, unsigned int forward )
+{
+    const YFFTPlan * plan = YFFTPlan::get( N );
+    if( plan ) plan->rfft( x, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cfft()
+// desc: complex value fft
+//
+//   cfft replaces float array x containing NC complex values (2*NC float 
+//   values alternating real, imagininary, etc.) by its Fourier transform 
+//   if forward is true, or by its inverse Fourier transform ifforward is 
+//   false.
+//
+//   NC MUST be a power of 2. (runs the shared YFFTPlan for NC)
+//
+//-----------------------------------------------------------------------------
+void cfft( SAMPLE * x, long NC, unsigned int forward )
+{
+    const YFFTPlan * plan = YFFTPlan::get( NC );
+    if( plan ) plan->cfft( x, forward );
+}
+
+
+
+
+// shared plans, by log2( NC )
+static std::atomic<YFFTPlan *> g_plans[YFFT_MAX_LOG2+1];
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get()
+// desc: the shared plan for NC (lock-free; if two threads race to make
+//       one, one of them wins and the other's is thrown away)
+//-----------------------------------------------------------------------------
+const YFFTPlan * YFFTPlan::get( long NC )
+{
+    // power of 2
+    if( NC < 1 || ( NC & ( NC - 1 ) ) ) return NULL;
+    int n = 0;
+    while( ( 1L << n ) < NC ) n++;
+    if( n > YFFT_MAX_LOG2 ) return NULL;
+
+    YFFTPlan * plan = g_plans[n].load( std::memory_order_acquire );
+    if( plan ) return plan;
+
+    // make one
+    YFFTPlan * mine = new YFFTPlan( NC );
+    if( g_plans[n].compare_exchange_strong( plan, mine, std::memory_order_acq_rel ) )
+        return mine;
+    // lost
+    delete mine;
+    return plan;
+}
+
+
+
+
+// shared windows, by type and log2( length )
+static std::atomic<SAMPLE *> g_windows[YFFT_NUM_WINDOWS][YFFT_MAX_LOG2+2];
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: window()
+// desc: the shared window table (lock-free, like get())
+//-----------------------------------------------------------------------------
+const SAMPLE * YFFTPlan::window( YFFTWindow type, long length )
+{
+    // power of 2
+    if( type < 0 || type >= YFFT_NUM_WINDOWS ) return NULL;
+    if( length < 1 || ( length & ( length - 1 ) ) ) return NULL;
+    int n = 0;
+    while( ( 1L << n ) < length ) n++;
+    if( n > YFFT_MAX_LOG2 + 1 ) return NULL;
+
+    SAMPLE * table = g_windows[type][n].load( std::memory_order_acquire );
+    if( table ) return table;
+
+    // make one
+    SAMPLE * mine = new SAMPLE[length];
+    switch( type )
+    {
+        case YFFT_HAMMING: hamming( mine, length ); break;
+        case YFFT_BLACKMAN: blackman( mine, length ); break;
+        default: hanning( mine, length ); break;
+    }
+    if( g_windows[type][n].compare_exchange_strong( table, mine, std::memory_order_acq_rel ) )
+        return mine;
+    // lost
+    delete [] mine;
+    return table;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YFFTPlan()
+// desc: constructor: all the tables (in double, rounded once)
+//-----------------------------------------------------------------------------
+YFFTPlan::YFFTPlan( long NC )
+{
+    m_NC = NC;
+    m_swaps = NULL;
+    m_numSwaps = 0;
+    m_reverse = NULL;
+    m_twiddles[0] = m_twiddles[1] = NULL;
+    m_rtwiddles = NULL;
+
+    int bits = 0;
+    while( ( 1L << bits ) < NC ) bits++;
+
+    // bit-reversal: the permutation, and swaps (each pair once)
+    m_swaps = new unsigned int[NC > 1 ? NC : 2];
+    m_reverse = new unsigned int[NC];
+    for( long i = 0; i < NC; i++ )
+    {
+        long j = 0;
+        for( int b = 0; b < bits; b++ )
+            if( i & ( 1L << b ) ) j |= 1L << ( bits - 1 - b );
+        m_reverse[i] = (unsigned int)j;
+        if( j > i )
+        {
+            m_swaps[m_numSwaps++] = (unsigned int)i;
+            m_swaps[m_numSwaps++] = (unsigned int)j;
+        }
+    }
+    m_numSwaps /= 2;
+
+    // radix-4 passes, after one radix-2 pass if the power is odd
+    m_radix2 = bits & 1;
+    long count = 0;
+    for( long L = m_radix2 ? 2 : 1; 4 * L <= NC; L *= 4 )
+        if( L >= 2 ) count += L * 12;
+
+    double pi = 4. * atan( 1. );
+    for( int dir = 0; dir < 2; dir++ )
+    {
+        // forward (dir 1) turns by +2pi/N
+        double sign = dir ? 1 : -1;
+        float * t = m_twiddles[dir] = new float[count > 0 ? count : 1];
+        for( long L = m_radix2 ? 2 : 1; 4 * L <= NC; L *= 4 )
+        {
+            // L == 1: no twiddles
+            if( L < 2 ) continue;
+            for( long k = 0; k < L; k += 2, t += 24 )
+                for( int p = 1; p <= 3; p++ )
+                    for( int h = 0; h < 2; h++ )
+                    {
+                        double theta = sign * 2 * pi * p * ( k + h ) / ( 4 * L );
+                        float * w = t + ( p - 1 ) * 8;
+                        w[2*h] = w[2*h+1] = (float)cos( theta );
+                        w[4+2*h] = -(float)sin( theta );
+                        w[4+2*h+1] = (float)sin( theta );
+                    }
+        }
+    }
+
+    // rfft
+    m_rtwiddles = new float[2 * ( NC / 2 + 1 )];
+    for( long k = 0; k <= NC / 2; k++ )
+    {
+        m_rtwiddles[2*k] = (float)cos( k * pi / NC );
+        m_rtwiddles[2*k+1] = (float)sin( k * pi / NC );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YFFTPlan()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YFFTPlan::~YFFTPlan()
+{
+    SAFE_DELETE_ARRAY( m_swaps );
+    SAFE_DELETE_ARRAY( m_reverse );
+    SAFE_DELETE_ARRAY( m_twiddles[0] );
+    SAFE_DELETE_ARRAY( m_twiddles[1] );
+    SAFE_DELETE_ARRAY( m_rtwiddles );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: radix4()
+// desc: one radix-4 decimation-in-time pass over groups of 4L points: the
+//       four quarters of a group hold the L point ffts of x[4n], x[4n+2],
+//       x[4n+1], x[4n+3] (radix-2 bit-reversed order)
+//-----------------------------------------------------------------------------
+void YFFTPlan::radix4( SAMPLE * x, long L, const float * twiddles,
+                       unsigned int forward ) const
+{
+    long ND = m_NC << 1;
+
+    // L == 1: W^0 == 1; j = +i forward, -i inverse
+    if( L == 1 )
+    {
+        float j = forward ? 1 : -1;
+        for( long g = 0; g < ND; g += 8 )
+        {
+            SAMPLE * a = x + g;
+            SAMPLE u0r = a[0] + a[2], u0i = a[1] + a[3];
+            SAMPLE u1r = a[0] - a[2], u1i = a[1] - a[3];
+            SAMPLE u2r = a[4] + a[6], u2i = a[5] + a[7];
+            SAMPLE dr = a[4] - a[6], di = a[5] - a[7];
+            // j * d
+            SAMPLE u3r = -j * di, u3i = j * dr;
+            a[0] = u0r + u2r; a[1] = u0i + u2i;
+            a[4] = u0r - u2r; a[5] = u0i - u2i;
+            a[2] = u1r + u3r; a[3] = u1i + u3i;
+            a[6] = u1r - u3r; a[7] = u1i - u3i;
+        }
+        return;
+    }
+
+    // two k at a time (two interleaved complex values per vector)
+    xvec jsign = forward ? xv_set( -1, 1, -1, 1 ) : xv_set( 1, -1, 1, -1 );
+    long span = 2 * L;
+    for( long g = 0; g < ND; g += 4 * span )
+    {
+        const float * t = twiddles;
+        for( long k = 0; k < span; k += 4, t += 24 )
+        {
+            SAMPLE * a = x + g + k;
+            xvec x0 = xv_load( a );
+            xvec x1 = xv_load( a + span );
+            xvec x2 = xv_load( a + 2 * span );
+            xvec x3 = xv_load( a + 3 * span );
+            // t1 = W^k x2, t2 = W^2k x1, t3 = W^3k x3
+            xvec t1 = xv_add( xv_mul( x2, xv_load( t ) ), xv_mul( xv_swap( x2 ), xv_load( t + 4 ) ) );
+            xvec t2 = xv_add( xv_mul( x1, xv_load( t + 8 ) ), xv_mul( xv_swap( x1 ), xv_load( t + 12 ) ) );
+            xvec t3 = xv_add( xv_mul( x3, xv_load( t + 16 ) ), xv_mul( xv_swap( x3 ), xv_load( t + 20 ) ) );
+            xvec u0 = xv_add( x0, t2 );
+            xvec u1 = xv_sub( x0, t2 );
+            xvec u2 = xv_add( t1, t3 );
+            // j ( t1 - t3 )
+            xvec u3 = xv_mul( xv_swap( xv_sub( t1, t3 ) ), jsign );
+            xv_store( a, xv_add( u0, u2 ) );
+            xv_store( a + span, xv_add( u1, u3 ) );
+            xv_store( a + 2 * span, xv_sub( u0, u2 ) );
+            xv_store( a + 3 * span, xv_sub( u1, u3 ) );
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cfft()
+// desc: complex fft (forward: e^{+i}, scaled by 1/2NC; inverse: scaled by 2)
+//-----------------------------------------------------------------------------
+void YFFTPlan::cfft( SAMPLE * x, unsigned int forward ) const
+{
+    // bit-reverse (complex values swapped as pairs)
+    for( long s = 0; s < m_numSwaps; s++ )
+    {
+        SAMPLE * a = x + 2 * m_swaps[2*s];
+        SAMPLE * b = x + 2 * m_swaps[2*s+1];
+        SAMPLE re = a[0], im = a[1];
+        a[0] = b[0]; a[1] = b[1];
+        b[0] = re; b[1] = im;
+    }
+
+    passes( x, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: passes()
+// desc: cfft() after the bit-reversal: butterflies + scaling
+//-----------------------------------------------------------------------------
+void YFFTPlan::passes( SAMPLE * x, unsigned int forward ) const
+{
+    long ND = m_NC << 1;
+
+    // odd power of 2: radix-2 first (W^0 == 1)
+    if( m_radix2 )
+    {
+        for( long i = 0; i < ND; i += 4 )
+        {
+            SAMPLE re = x[i+2], im = x[i+3];
+            x[i+2] = x[i] - re; x[i+3] = x[i+1] - im;
+            x[i] += re; x[i+1] += im;
+        }
+    }
+
+    // radix-4 the rest of the way
+    const float * t = m_twiddles[forward ? 1 : 0];
+    for( long L = m_radix2 ? 2 : 1; 4 * L <= m_NC; L *= 4 )
+    {
+        radix4( x, L, t, forward );
+        if( L >= 2 ) t += L * 12;
+    }
+
+    // scale output
+    SAMPLE scale = (SAMPLE)( forward ? 1. / ND : 2. );
+    long i = 0;
+    xvec s4 = xv_set1( scale );
+    for( ; i + 4 <= ND; i += 4 )
+        xv_store( x + i, xv_mul( xv_load( x + i ), s4 ) );
+    for( ; i < ND; i++ )
+        x[i] *= scale;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rfft()
+// desc: real fft via a complex fft of half the size (CARL, spect.c)
+//-----------------------------------------------------------------------------
+void YFFTPlan::rfft( SAMPLE * x, unsigned int forward ) const
+{
+    if( forward )
+    {
+        cfft( x, forward );
+        twist( x, forward );
+    }
+    else
+    {
+        twist( x, forward );
+        cfft( x, forward );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rfftWindowed()
+// desc: forward rfft of 2*NC points of src (circular: from start, wrapping
+//       at srcLength >= 2*NC) times window; the window is applied on the way into x,
+//       straight into bit-reversed order (no copy, no swap pass)
+//-----------------------------------------------------------------------------
+void YFFTPlan::rfftWindowed( SAMPLE * x, const SAMPLE * src, long srcLength,
+                             long start, const SAMPLE * window ) const
+{
+    long s = start % srcLength;
+    // complex points wholly before src wraps
+    long before = ( srcLength - s ) >> 1;
+    if( before > m_NC ) before = m_NC;
+
+    // load: window, permute; two complex points per vector
+    long j = 0;
+    for( ; j + 1 < before; j += 2 )
+    {
+        xvec v = xv_mul( xv_load( src + s + 2 * j ), xv_load( window + 2 * j ) );
+        xv_out2lo( x + 2 * m_reverse[j], v );
+        xv_out2( x + 2 * m_reverse[j+1], v );
+    }
+    for( ; j < before; j++ )
+    {
+        SAMPLE * d = x + 2 * m_reverse[j];
+        d[0] = src[s + 2 * j] * window[2*j];
+        d[1] = src[s + 2 * j + 1] * window[2*j+1];
+    }
+    // a point straddling the wrap
+    if( j < m_NC && ( ( srcLength - s ) & 1 ) )
+    {
+        SAMPLE * d = x + 2 * m_reverse[j];
+        d[0] = src[srcLength - 1] * window[2*j];
+        d[1] = src[0] * window[2*j+1];
+        j++;
+    }
+    // after the wrap: point j starts at src[s + 2j - srcLength]
+    long offset = s - srcLength;
+    for( ; j + 1 < m_NC; j += 2 )
+    {
+        xvec v = xv_mul( xv_load( src + ( offset + 2 * j ) ), xv_load( window + 2 * j ) );
+        xv_out2lo( x + 2 * m_reverse[j], v );
+        xv_out2( x + 2 * m_reverse[j+1], v );
+    }
+    for( ; j < m_NC; j++ )
+    {
+        SAMPLE * d = x + 2 * m_reverse[j];
+        d[0] = src[offset + 2 * j] * window[2*j];
+        d[1] = src[offset + 2 * j + 1] * window[2*j+1];
+    }
+
+    // the rest of rfft()
+    passes( x, FFT_FORWARD );
+    twist( x, FFT_FORWARD );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: twist()
+// desc: rfft()'s pass between the real data and the half-size complex fft
+//       (after cfft() forward, before it inverse)
+//-----------------------------------------------------------------------------
+void YFFTPlan::twist( SAMPLE * x, unsigned int forward ) const
+{
+    long N = m_NC;
+    SAMPLE c1, c2, h1r, h1i, h2r, h2i, wr, wi, sign ;
+    SAMPLE xr, xi ;
+    long i, i1, i2, i3, i4, N2p1 ;
+
+    c1 = 0.5 ;
+
+    if( forward )
+    {
+        c2 = -0.5 ;
+        sign = 1 ;
+        xr = x[0] ;
+        xi = x[1] ;
+    }
+    else
+    {
+        c2 = 0.5 ;
+        sign = -1 ;
+        xr = x[1] ;
+        xi = 0. ;
+        x[1] = 0. ;
+    }
+
+    N2p1 = (N<<1) + 1 ;
+
+    for( i = 0 ; i <= N>>1 ; i++ )
+    {
+        i1 = i<<1 ;
+        i2 = i1 + 1 ;
+        i3 = N2p1 - i2 ;
+        i4 = i3 + 1 ;
+        wr = m_rtwiddles[i1] ;
+        wi = sign * m_rtwiddles[i2] ;
+        if( i == 0 )
+        {
+            h1r =  c1*(x[i1] + xr ) ;
+            h1i =  c1*(x[i2] - xi ) ;
+            h2r = -c2*(x[i2] + xi ) ;
+            h2i =  c2*(x[i1] - xr ) ;
+            x[i1] =  h1r + wr*h2r - wi*h2i ;
+            x[i2] =  h1i + wr*h2i + wi*h2r ;
+            xr =  h1r - wr*h2r + wi*h2i ;
+            xi = -h1i + wr*h2i + wi*h2r ;
+        }
+        else
+        {
+            h1r =  c1*(x[i1] + x[i3] ) ;
+            h1i =  c1*(x[i2] - x[i4] ) ;
+            h2r = -c2*(x[i2] + x[i4] ) ;
+            h2i =  c2*(x[i1] - x[i3] ) ;
+            x[i1] =  h1r + wr*h2r - wi*h2i ;
+            x[i2] =  h1i + wr*h2i + wi*h2r ;
+            x[i3] =  h1r - wr*h2r + wi*h2i ;
+            x[i4] = -h1i + wr*h2i + wi*h2r ;
+        }
+    }
+
+    if( forward )
+        x[1] = xr ;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// batches: the scalar algorithm, with every float a column of K lanes; T is
+// YFFTVectorLanes (four transforms) or YFFTScalarLanes (the leftovers), and
+// T::V its value type (plain structs, not a template on xvec: its vector
+// attributes don't survive being a template argument)
+//-----------------------------------------------------------------------------
+static inline float xv_add( float a, float b ) { return a + b; }
+static inline float xv_sub( float a, float b ) { return a - b; }
+static inline float xv_mul( float a, float b ) { return a * b; }
+
+struct YFFTVectorLanes
+{
+    typedef xvec V;
+    enum { width = XSIMD_WIDTH };
+    static inline xvec load( const float * p ) { return xv_load( p ); }
+    static inline void store( float * p, xvec v ) { xv_store( p, v ); }
+    static inline xvec set1( float v ) { return xv_set1( v ); }
+};
+struct YFFTScalarLanes
+{
+    typedef float V;
+    enum { width = 1 };
+    static inline float load( const float * p ) { return *p; }
+    static inline void store( float * p, float v ) { *p = v; }
+    static inline float set1( float v ) { return v; }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: batch_radix4()
+// desc: one radix-4 butterfly (complex points j, j+L, j+2L, j+3L) on the
+//       lanes [l, l + width); w: W^k, W^2k, W^3k as re, im pairs
+//-----------------------------------------------------------------------------
+template <typename T>
+static inline void batch_radix4( SAMPLE * x, long K, long l, long j, long L,
+                                 const float * w, float jsign )
+{
+    typedef typename T::V V;
+    SAMPLE * r0 = x + 2 * j * K + l;
+    SAMPLE * r1 = r0 + 2 * L * K;
+    SAMPLE * r2 = r1 + 2 * L * K;
+    SAMPLE * r3 = r2 + 2 * L * K;
+    V x0r = T::load( r0 ), x0i = T::load( r0 + K );
+    V x1r = T::load( r1 ), x1i = T::load( r1 + K );
+    V x2r = T::load( r2 ), x2i = T::load( r2 + K );
+    V x3r = T::load( r3 ), x3i = T::load( r3 + K );
+
+    // t1 = W^k x2, t2 = W^2k x1, t3 = W^3k x3
+    V t1r = x2r, t1i = x2i, t2r = x1r, t2i = x1i, t3r = x3r, t3i = x3i;
+    if( w )
+    {
+        V c = T::set1( w[0] ), s = T::set1( w[1] );
+        t1r = xv_sub( xv_mul( x2r, c ), xv_mul( x2i, s ) );
+        t1i = xv_add( xv_mul( x2r, s ), xv_mul( x2i, c ) );
+        c = T::set1( w[2] ); s = T::set1( w[3] );
+        t2r = xv_sub( xv_mul( x1r, c ), xv_mul( x1i, s ) );
+        t2i = xv_add( xv_mul( x1r, s ), xv_mul( x1i, c ) );
+        c = T::set1( w[4] ); s = T::set1( w[5] );
+        t3r = xv_sub( xv_mul( x3r, c ), xv_mul( x3i, s ) );
+        t3i = xv_add( xv_mul( x3r, s ), xv_mul( x3i, c ) );
+    }
+
+    V u0r = xv_add( x0r, t2r ), u0i = xv_add( x0i, t2i );
+    V u1r = xv_sub( x0r, t2r ), u1i = xv_sub( x0i, t2i );
+    V u2r = xv_add( t1r, t3r ), u2i = xv_add( t1i, t3i );
+    // j ( t1 - t3 ): j = +i forward, -i inverse
+    V js = T::set1( jsign );
+    V u3r = xv_mul( xv_sub( t3i, t1i ), js );
+    V u3i = xv_mul( xv_sub( t1r, t3r ), js );
+
+    T::store( r0, xv_add( u0r, u2r ) ); T::store( r0 + K, xv_add( u0i, u2i ) );
+    T::store( r1, xv_add( u1r, u3r ) ); T::store( r1 + K, xv_add( u1i, u3i ) );
+    T::store( r2, xv_sub( u0r, u2r ) ); T::store( r2 + K, xv_sub( u0i, u2i ) );
+    T::store( r3, xv_sub( u1r, u3r ) ); T::store( r3 + K, xv_sub( u1i, u3i ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: batch_post()
+// desc: rfft's pre/post pass for point i >= 1, on lanes [l, l + width)
+//-----------------------------------------------------------------------------
+template <typename T>
+static inline void batch_post( SAMPLE * x, long K, long l, long N, long i,
+                               float wrs, float wis, float c2s )
+{
+    typedef typename T::V V;
+    SAMPLE * p1 = x + ( 2 * i ) * K + l;
+    SAMPLE * p2 = p1 + K;
+    SAMPLE * p3 = x + ( 2 * N - 2 * i ) * K + l;
+    SAMPLE * p4 = p3 + K;
+    V x1 = T::load( p1 ), x2 = T::load( p2 ), x3 = T::load( p3 ), x4 = T::load( p4 );
+    V c1 = T::set1( 0.5f ), c2 = T::set1( c2s ), mc2 = T::set1( -c2s );
+    V wr = T::set1( wrs ), wi = T::set1( wis );
+
+    V h1r = xv_mul( c1, xv_add( x1, x3 ) );
+    V h1i = xv_mul( c1, xv_sub( x2, x4 ) );
+    V h2r = xv_mul( mc2, xv_add( x2, x4 ) );
+    V h2i = xv_mul( c2, xv_sub( x1, x3 ) );
+    V a = xv_sub( xv_mul( wr, h2r ), xv_mul( wi, h2i ) );
+    V b = xv_add( xv_mul( wr, h2i ), xv_mul( wi, h2r ) );
+    T::store( p1, xv_add( h1r, a ) );
+    T::store( p2, xv_add( h1i, b ) );
+    T::store( p3, xv_sub( h1r, a ) );
+    T::store( p4, xv_sub( b, h1i ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cfftBatch()
+// desc: K complex ffts (lane-interleaved), same results as cfft() on each
+//-----------------------------------------------------------------------------
+void YFFTPlan::cfftBatch( SAMPLE * x, long K, unsigned int forward ) const
+{
+    // sanity check
+    if( K < 1 ) return;
+
+    long ND = m_NC << 1;
+    long K4 = K - K % XSIMD_WIDTH;
+
+    // bit-reverse: swap whole rows (re and im rows are adjacent)
+    for( long s = 0; s < m_numSwaps; s++ )
+    {
+        SAMPLE * a = x + 2 * m_swaps[2*s] * K;
+        SAMPLE * b = x + 2 * m_swaps[2*s+1] * K;
+        long l = 0;
+        for( ; l + XSIMD_WIDTH <= 2 * K; l += XSIMD_WIDTH )
+        {
+            xvec t = xv_load( a + l );
+            xv_store( a + l, xv_load( b + l ) );
+            xv_store( b + l, t );
+        }
+        for( ; l < 2 * K; l++ )
+        {
+            SAMPLE t = a[l]; a[l] = b[l]; b[l] = t;
+        }
+    }
+
+    // odd power of 2: radix-2 first
+    if( m_radix2 )
+    {
+        for( long i = 0; i < ND; i += 4 )
+        {
+            SAMPLE * a = x + i * K;
+            SAMPLE * b = a + 2 * K;
+            long l = 0;
+            for( ; l + XSIMD_WIDTH <= 2 * K; l += XSIMD_WIDTH )
+            {
+                xvec u = xv_load( a + l ), v = xv_load( b + l );
+                xv_store( a + l, xv_add( u, v ) );
+                xv_store( b + l, xv_sub( u, v ) );
+            }
+            for( ; l < 2 * K; l++ )
+            {
+                SAMPLE u = a[l], v = b[l];
+                a[l] = u + v; b[l] = u - v;
+            }
+        }
+    }
+
+    // radix-4 passes
+    float jsign = forward ? 1 : -1;
+    const float * t = m_twiddles[forward ? 1 : 0];
+    for( long L = m_radix2 ? 2 : 1; 4 * L <= m_NC; L *= 4 )
+    {
+        for( long g = 0; g < m_NC; g += 4 * L )
+        {
+            for( long k = 0; k < L; k++ )
+            {
+                // this k's twiddles, out of the vector table
+                float w[6];
+                const float * tw = NULL;
+                if( L >= 2 )
+                {
+                    const float * v = t + ( k >> 1 ) * 24 + 2 * ( k & 1 );
+                    for( int p = 0; p < 3; p++ )
+                    {
+                        w[2*p] = v[p*8];
+                        w[2*p+1] = v[p*8+5];
+                    }
+                    tw = w;
+                }
+                long l = 0;
+                for( ; l < K4; l += XSIMD_WIDTH )
+                    batch_radix4<YFFTVectorLanes>( x, K, l, g + k, L, tw, jsign );
+                for( ; l < K; l++ )
+                    batch_radix4<YFFTScalarLanes>( x, K, l, g + k, L, tw, jsign );
+            }
+        }
+        if( L >= 2 ) t += L * 12;
+    }
+
+    // scale output
+    SAMPLE scale = (SAMPLE)( forward ? 1. / ND : 2. );
+    long n = ND * K, i = 0;
+    xvec s4 = xv_set1( scale );
+    for( ; i + XSIMD_WIDTH <= n; i += XSIMD_WIDTH )
+        xv_store( x + i, xv_mul( xv_load( x + i ), s4 ) );
+    for( ; i < n; i++ )
+        x[i] *= scale;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rfftBatch()
+// desc: K real ffts (lane-interleaved), same results as rfft() on each
+//-----------------------------------------------------------------------------
+void YFFTPlan::rfftBatch( SAMPLE * x, long K, unsigned int forward ) const
+{
+    // sanity check
+    if( K < 1 ) return;
+
+    long N = m_NC;
+    long K4 = K - K % XSIMD_WIDTH;
+    float c2 = forward ? -0.5f : 0.5f;
+    float sign = forward ? 1 : -1;
+
+    if( forward ) cfftBatch( x, K, forward );
+
+    // point 0 (DC / nyquist, packed), per lane
+    for( long l = 0; l < K; l++ )
+    {
+        SAMPLE x0 = x[l], x1 = x[K + l];
+        SAMPLE xr = forward ? x0 : x1;
+        SAMPLE xi = forward ? x1 : 0;
+        if( !forward ) x1 = 0;
+        SAMPLE h1r =  0.5f * ( x0 + xr );
+        SAMPLE h1i =  0.5f * ( x1 - xi );
+        SAMPLE h2r = -c2 * ( x1 + xi );
+        SAMPLE h2i =  c2 * ( x0 - xr );
+        x[l] = h1r + h2r;
+        x[K + l] = forward ? h1r - h2r : h1i + h2i;
+    }
+
+    // the rest, mirrored pairs
+    for( long i = 1; i <= N >> 1; i++ )
+    {
+        float wr = m_rtwiddles[2*i], wi = sign * m_rtwiddles[2*i+1];
+        long l = 0;
+        for( ; l < K4; l += XSIMD_WIDTH )
+            batch_post<YFFTVectorLanes>( x, K, l, N, i, wr, wi, c2 );
+        for( ; l < K; l++ )
+            batch_post<YFFTScalarLanes>( x, K, l, N, i, wr, wi, c2 );
+    }
+
+    if( !forward ) cfftBatch( x, K, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: interleave()
+// desc: K buffers -> one batch (x[p*K + k] = in[k][p])
+//-----------------------------------------------------------------------------
+void YFFTPlan::interleave( const SAMPLE * const * in, SAMPLE * out, long length, long K )
+{
+    long p = 0;
+    // 4 x 4 tiles: four points of four buffers, transposed
+    for( ; p + XSIMD_WIDTH <= length; p += XSIMD_WIDTH )
+    {
+        SAMPLE * o = out + p * K;
+        long k = 0;
+        for( ; k + XSIMD_WIDTH <= K; k += XSIMD_WIDTH )
+        {
+            xvec a = xv_load( in[k] + p ), b = xv_load( in[k+1] + p );
+            xvec c = xv_load( in[k+2] + p ), d = xv_load( in[k+3] + p );
+            xv_transpose4( a, b, c, d );
+            xv_store( o + k, a ); xv_store( o + K + k, b );
+            xv_store( o + 2*K + k, c ); xv_store( o + 3*K + k, d );
+        }
+        for( ; k < K; k++ )
+            for( long i = 0; i < XSIMD_WIDTH; i++ )
+                o[i*K + k] = in[k][p + i];
+    }
+    // leftover points
+    for( ; p < length; p++ )
+        for( long k = 0; k < K; k++ )
+            out[p*K + k] = in[k][p];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: deinterleave()
+// desc: one batch -> K buffers
+//-----------------------------------------------------------------------------
+void YFFTPlan::deinterleave( const SAMPLE * in, SAMPLE * const * out, long length, long K )
+{
+    long p = 0;
+    // 4 x 4 tiles
+    for( ; p + XSIMD_WIDTH <= length; p += XSIMD_WIDTH )
+    {
+        const SAMPLE * r = in + p * K;
+        long k = 0;
+        for( ; k + XSIMD_WIDTH <= K; k += XSIMD_WIDTH )
+        {
+            xvec a = xv_load( r + k ), b = xv_load( r + K + k );
+            xvec c = xv_load( r + 2*K + k ), d = xv_load( r + 3*K + k );
+            xv_transpose4( a, b, c, d );
+            xv_store( out[k] + p, a ); xv_store( out[k+1] + p, b );
+            xv_store( out[k+2] + p, c ); xv_store( out[k+3] + p, d );
+        }
+        for( ; k < K; k++ )
+            for( long i = 0; i < XSIMD_WIDTH; i++ )
+                out[k][p + i] = r[i*K + k];
+    }
+    // leftover points
+    for( ; p < length; p++ )
+        for( long k = 0; k < K; k++ )
+            out[k][p] = in[p*K + k];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: rfft_batch()
+// desc: K real ffts of 2*N points (shared plan)
+//-----------------------------------------------------------------------------
+void rfft_batch( SAMPLE * x, long N, long K, unsigned int forward )
+{
+    const YFFTPlan * plan = YFFTPlan::get( N );
+    if( plan ) plan->rfftBatch( x, K, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cfft_batch()
+// desc: K complex ffts of NC points (shared plan)
+//-----------------------------------------------------------------------------
+void cfft_batch( SAMPLE * x, long NC, long K, unsigned int forward )
+{
+    const YFFTPlan * plan = YFFTPlan::get( NC );
+    if( plan ) plan->cfftBatch( x, K, forward );
+}
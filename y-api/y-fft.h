@@ -67,6 +67,10 @@ void apply_window( SAMPLE * data, SAMPLE * window, unsigned long length );
 void rfft( SAMPLE * x, long N, unsigned int forward );
 // complex fft, NC must be power of 2
 void cfft( SAMPLE * x, long NC, unsigned int forward );
+// K real / complex ffts at once, lane-interleaved: point p of transform k
+// is x[p*K + k] (see YFFTPlan::interleave())
+void rfft_batch( SAMPLE * x, long N, long K, unsigned int forward );
+void cfft_batch( SAMPLE * x, long NC, long K, unsigned int forward );
 
 // c linkage
 #if ( defined( __cplusplus ) || defined( _cplusplus ) )
@@ -74,4 +78,89 @@ void cfft( SAMPLE * x, long NC, unsigned int forward );
 #endif
 
 
+
+
+// largest plan: 2^YFFT_MAX_LOG2 complex points
+#define YFFT_MAX_LOG2 24
+
+// window shapes (see YFFTPlan::window())
+enum YFFTWindow
+{
+    YFFT_HANNING = 0,
+    YFFT_HAMMING,
+    YFFT_BLACKMAN,
+    YFFT_NUM_WINDOWS
+};
+
+//-----------------------------------------------------------------------------
+// name: class YFFTPlan
+// desc: everything an fft of one size needs, worked out once: bit-reversal
+//       swaps, radix-4 twiddles (both directions), rfft twiddles; same
+//       layout and scaling as rfft() / cfft(), which use shared plans.
+//       a plan is read-only after construction: any number of threads can
+//       run it at once
+//-----------------------------------------------------------------------------
+class YFFTPlan
+{
+public:
+    // NC complex points (power of 2)
+    YFFTPlan( long NC );
+    ~YFFTPlan();
+
+public:
+    // complex fft of NC points (2*NC floats), in place
+    void cfft( SAMPLE * x, unsigned int forward ) const;
+    // real fft of 2*NC points (packed: x[1] is nyquist), in place
+    void rfft( SAMPLE * x, unsigned int forward ) const;
+    // forward rfft of window * 2*NC points of src, read circularly from start
+    // (wrapping at srcLength >= 2*NC), into x: windowed on the way in
+    void rfftWindowed( SAMPLE * x, const SAMPLE * src, long srcLength,
+                       long start, const SAMPLE * window ) const;
+    // complex points
+    long size() const { return m_NC; }
+
+public: // batches: K transforms at once, lane-interleaved (x[p*K + k]); four
+        // transforms per SIMD vector, all at the same butterfly. K a multiple
+        // of 4 is the fast case (pad with silence); leftovers run scalar
+    // K complex ffts of NC points
+    void cfftBatch( SAMPLE * x, long K, unsigned int forward ) const;
+    // K real ffts of 2*NC points
+    void rfftBatch( SAMPLE * x, long K, unsigned int forward ) const;
+    // K separate buffers of length floats <-> one lane-interleaved batch
+    static void interleave( const SAMPLE * const * in, SAMPLE * out, long length, long K );
+    static void deinterleave( const SAMPLE * in, SAMPLE * const * out, long length, long K );
+
+public:
+    // the shared plan for NC complex points (NULL if not a power of 2); made
+    // on first use (allocates: get it before the audio starts), never freed
+    static const YFFTPlan * get( long NC );
+    // the shared window of length points (power of 2, else NULL); same
+    // lifetime and rules as get()
+    static const SAMPLE * window( YFFTWindow type, long length );
+
+protected:
+    // cfft() after the bit-reversal
+    void passes( SAMPLE * x, unsigned int forward ) const;
+    // rfft()'s real <-> half-size complex pass
+    void twist( SAMPLE * x, unsigned int forward ) const;
+    // one radix-4 pass: groups of 4L points
+    void radix4( SAMPLE * x, long L, const float * twiddles, unsigned int forward ) const;
+
+protected:
+    long m_NC;
+    // bit-reversal: complex index pairs to swap
+    unsigned int * m_swaps;
+    long m_numSwaps;
+    // bit-reversal: the permutation itself (complex indices)
+    unsigned int * m_reverse;
+    // whether there's a radix-2 pass first (odd power of 2)
+    bool m_radix2;
+    // radix-4 twiddles, per direction: each pass (L >= 2) in turn, per pair
+    // of k: W^k, W^2k, W^3k as [ re re re' re' ], [ -im im -im' im' ]
+    float * m_twiddles[2];
+    // rfft twiddles: cos, sin of k pi / NC, k = 0 .. NC/2
+    float * m_rtwiddles;
+};
+
+
 #endif
@@ -100,6 +100,8 @@ bool YFluidSynth::init( int srate, int polyphony )
     if( polyphony <= 0 ) polyphony = 1;
     else if( polyphony > 256 ) polyphony = 256;
     fluid_settings_setint( m_settings, (char *)"synth.polyphony", polyphony );
+    // keep sample data resident (voices shouldn't page-fault in the callback)
+    fluid_settings_setint( m_settings, (char *)"synth.lock-memory", 1 );
     // instantiate the synth
     m_synth = new_fluid_synth( m_settings );
     
@@ -0,0 +1,599 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+
+//-----------------------------------------------------------------------------
+// name: y-graph.cpp
+// desc: small DSP graph, compiled to a flat program
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-graph.h"
+#include "x-def.h"
+#include <iostream>
+#include <string.h>
+using namespace std;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YGraphProgram()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YGraphProgram::YGraphProgram( unsigned int _maxFrames )
+    : numSlots( 0 ), maxFrames( _maxFrames ), m_arena( NULL ), m_out( NULL ),
+      m_frames( 0 ), m_level( 0 )
+{ }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YGraphProgram()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YGraphProgram::~YGraphProgram()
+{
+    SAFE_DELETE_ARRAY( m_arena );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: allocate()
+// desc: allocate the arena (zeroed, so the audio thread never faults a
+//       fresh page)
+//-----------------------------------------------------------------------------
+void YGraphProgram::allocate( int _numSlots )
+{
+    SAFE_DELETE_ARRAY( m_arena );
+    numSlots = _numSlots;
+    if( numSlots > 0 )
+        m_arena = new float[numSlots * maxFrames * YGRAPH_CHANNELS]();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: run it into output (audio thread), maxFrames at a time; tasks of a
+//       level go to the pool, levels run in order
+//-----------------------------------------------------------------------------
+void YGraphProgram::run( float * output, unsigned int numFrames, XWorkerPool * pool )
+{
+    for( unsigned int done = 0; done < numFrames; )
+    {
+        // this piece
+        unsigned int frames = numFrames - done;
+        if( frames > maxFrames ) frames = maxFrames;
+        m_out = output + done * YGRAPH_CHANNELS;
+        m_frames = frames;
+
+        for( size_t l = 0; l + 1 < levels.size(); l++ )
+        {
+            m_level = levels[l];
+            int count = levels[l+1] - levels[l];
+            // fork/join (the pool runs it here if it has no workers)
+            if( pool && count > 1 ) pool->run( runTask, this, count );
+            else for( int t = 0; t < count; t++ ) runTask( t, this );
+        }
+
+        done += frames;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: runTask()
+// desc: run task index of the current level (any thread)
+//-----------------------------------------------------------------------------
+void YGraphProgram::runTask( int index, void * data )
+{
+    YGraphProgram * p = (YGraphProgram *)data;
+    const YGraphTask & task = p->tasks[p->m_level + index];
+    for( int i = task.begin; i < task.end; i++ )
+        p->exec( p->ops[i] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: exec()
+// desc: run one op on the current piece
+//-----------------------------------------------------------------------------
+void YGraphProgram::exec( const YGraphOp & op )
+{
+    unsigned int n = m_frames * YGRAPH_CHANNELS;
+    // resolve buffers
+    float * dst = op.dst == YGRAPH_OUTPUT ? m_out :
+                  m_arena + op.dst * maxFrames * YGRAPH_CHANNELS;
+    float * src = op.src == YGRAPH_OUTPUT ? m_out :
+                  m_arena + op.src * maxFrames * YGRAPH_CHANNELS;
+    float gain = op.gain;
+
+    switch( op.type )
+    {
+        case YGraphOp::CLEAR:
+            memset( dst, 0, sizeof(float) * n );
+            break;
+        case YGraphOp::COPY:
+            if( gain == 1 ) memmove( dst, src, sizeof(float) * n );
+            else for( unsigned int j = 0; j < n; j++ ) dst[j] = gain * src[j];
+            break;
+        case YGraphOp::MIX:
+            for( unsigned int j = 0; j < n; j++ ) dst[j] += gain * src[j];
+            break;
+        case YGraphOp::PROCESS:
+            op.dsp->process( dst, m_frames );
+            break;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: dump()
+// desc: print it
+//-----------------------------------------------------------------------------
+void YGraphProgram::dump() const
+{
+    static const char * types[] = { "clear", "copy", "mix", "process" };
+    cerr << "[y-graph]: " << ops.size() << " ops, " << tasks.size() << " tasks, "
+         << levels.size() - 1 << " levels, " << numSlots << " buffers" << endl;
+    for( size_t l = 0; l + 1 < levels.size(); l++ )
+    {
+        for( int t = levels[l]; t < levels[l+1]; t++ )
+        {
+            cerr << "[y-graph]: level " << l << ", task " << t << ":" << endl;
+            for( int i = tasks[t].begin; i < tasks[t].end; i++ )
+            {
+                const YGraphOp & op = ops[i];
+                cerr << "[y-graph]: | " << i << ": " << types[op.type] << " ";
+                if( op.type == YGraphOp::COPY || op.type == YGraphOp::MIX )
+                    cerr << "$" << op.src << " * " << op.gain << " -> ";
+                if( op.dst == YGRAPH_OUTPUT ) cerr << "out";
+                else cerr << "$" << op.dst;
+                cerr << " (" << names[i] << ")" << endl;
+            }
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YGraph()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YGraph::YGraph( unsigned int maxFrames )
+    : m_master( -1 ), m_maxFrames( maxFrames ), m_pool( NULL ), m_current( NULL ),
+      m_pending( NULL ), m_retired( NULL )
+{ }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YGraph()
+// desc: destructor (audio must be stopped)
+//-----------------------------------------------------------------------------
+YGraph::~YGraph()
+{
+    SAFE_DELETE( m_current );
+    delete m_pending.exchange( NULL );
+    delete m_retired.exchange( NULL );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: addNode()
+// desc: add a node; returns its id
+//-----------------------------------------------------------------------------
+int YGraph::addNode( const std::string & name, YDSP * dsp )
+{
+    Node node;
+    node.name = name;
+    node.dsp = dsp;
+    m_nodes.push_back( node );
+
+    return m_nodes.size() - 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: find()
+// desc: find a node by name
+//-----------------------------------------------------------------------------
+int YGraph::find( const std::string & name ) const
+{
+    for( size_t i = 0; i < m_nodes.size(); i++ )
+        if( m_nodes[i].name == name ) return i;
+    return -1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: connect()
+// desc: feed from's output into to's input
+//-----------------------------------------------------------------------------
+bool YGraph::connect( int from, int to, float gain )
+{
+    // sanity check
+    if( from < 0 || to < 0 || from >= (int)m_nodes.size() || to >= (int)m_nodes.size() )
+        return false;
+    // already?
+    if( setGain( from, to, gain ) ) return true;
+
+    Edge e;
+    e.from = from;
+    e.gain = gain;
+    m_nodes[to].inputs.push_back( e );
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: disconnect()
+// desc: remove a connection
+//-----------------------------------------------------------------------------
+bool YGraph::disconnect( int from, int to )
+{
+    // sanity check
+    if( to < 0 || to >= (int)m_nodes.size() ) return false;
+
+    std::vector<Edge> & inputs = m_nodes[to].inputs;
+    for( size_t i = 0; i < inputs.size(); i++ )
+    {
+        if( inputs[i].from == from )
+        {
+            inputs.erase( inputs.begin() + i );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setGain()
+// desc: set gain on an existing connection
+//-----------------------------------------------------------------------------
+bool YGraph::setGain( int from, int to, float gain )
+{
+    // sanity check
+    if( to < 0 || to >= (int)m_nodes.size() ) return false;
+
+    std::vector<Edge> & inputs = m_nodes[to].inputs;
+    for( size_t i = 0; i < inputs.size(); i++ )
+    {
+        if( inputs[i].from == from )
+        {
+            inputs[i].gain = gain;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: compile()
+// desc: compile the graph into a program:
+//   1. keep only what feeds the master
+//   2. order it so every node runs after its inputs (Kahn), or fail on a cycle
+//   3. cut it into tasks: a node with a single input that feeds only it
+//      joins that input's task (so a track's insert chain is one task);
+//      anything else starts a task one level past its inputs' tasks; tasks
+//      within a level are independent, and run in parallel
+//   4. walk the levels handing out arena buffers: a buffer is free again,
+//      from the next level on, once everything that reads it has run; a
+//      node takes over the buffer of an input that feeds only it (so insert
+//      chains run in place)
+//-----------------------------------------------------------------------------
+YGraphProgram * YGraph::compile( std::string & error ) const
+{
+    int numNodes = m_nodes.size();
+    // check
+    if( m_master < 0 || m_master >= numNodes )
+    {
+        error = "no master";
+        return NULL;
+    }
+
+    // 1. what's reachable from the master (walking inputs backwards)
+    std::vector<bool> live( numNodes, false );
+    std::vector<int> stack( 1, m_master );
+    live[m_master] = true;
+    while( stack.size() )
+    {
+        int v = stack.back(); stack.pop_back();
+        for( size_t i = 0; i < m_nodes[v].inputs.size(); i++ )
+        {
+            int u = m_nodes[v].inputs[i].from;
+            if( !live[u] ) { live[u] = true; stack.push_back( u ); }
+        }
+    }
+
+    // 2. topological order
+    std::vector<int> indegree( numNodes, 0 );
+    std::vector< std::vector<int> > consumers( numNodes );
+    int numLive = 0;
+    for( int v = 0; v < numNodes; v++ )
+    {
+        if( !live[v] ) continue;
+        numLive++;
+        for( size_t i = 0; i < m_nodes[v].inputs.size(); i++ )
+        {
+            indegree[v]++;
+            consumers[m_nodes[v].inputs[i].from].push_back( v );
+        }
+    }
+    std::vector<int> order;
+    for( int v = 0; v < numNodes; v++ )
+        if( live[v] && indegree[v] == 0 ) order.push_back( v );
+    for( size_t k = 0; k < order.size(); k++ )
+    {
+        int u = order[k];
+        for( size_t i = 0; i < consumers[u].size(); i++ )
+            if( --indegree[consumers[u][i]] == 0 ) order.push_back( consumers[u][i] );
+    }
+    if( (int)order.size() != numLive )
+    {
+        error = "cycle through:";
+        for( int v = 0; v < numNodes; v++ )
+            if( live[v] && indegree[v] > 0 ) error += " " + m_nodes[v].name;
+        return NULL;
+    }
+
+    // 3. tasks and levels
+    std::vector<int> task( numNodes, -1 );
+    std::vector<int> taskLevel;
+    std::vector< std::vector<int> > taskNodes;
+    int numLevels = 0;
+    for( size_t k = 0; k < order.size(); k++ )
+    {
+        int v = order[k];
+        const std::vector<Edge> & inputs = m_nodes[v].inputs;
+        // continue a chain
+        if( inputs.size() == 1 && consumers[inputs[0].from].size() == 1 )
+        {
+            task[v] = task[inputs[0].from];
+        }
+        // or start a task after everything it reads
+        else
+        {
+            int level = 0;
+            for( size_t i = 0; i < inputs.size(); i++ )
+                if( taskLevel[task[inputs[i].from]] + 1 > level )
+                    level = taskLevel[task[inputs[i].from]] + 1;
+            task[v] = taskLevel.size();
+            taskLevel.push_back( level );
+            taskNodes.push_back( std::vector<int>() );
+            if( level + 1 > numLevels ) numLevels = level + 1;
+        }
+        taskNodes[task[v]].push_back( v );
+    }
+
+    // 4. emit, level by level, handing out buffers
+    YGraphProgram * program = new YGraphProgram( m_maxFrames );
+    std::vector<YGraphOp> & ops = program->ops;
+    std::vector<std::string> & names = program->names;
+    std::vector<int> readers( numNodes, 0 );
+    for( int v = 0; v < numNodes; v++ ) readers[v] = consumers[v].size();
+    std::vector<int> slot( numNodes, -2 );
+    std::vector<int> freeSlots;
+    int numSlots = 0;
+    for( int level = 0; level < numLevels; level++ )
+    {
+        // buffers let go of in this level (reusable from the next)
+        std::vector<int> released;
+        program->levels.push_back( program->tasks.size() );
+
+        for( size_t t = 0; t < taskNodes.size(); t++ )
+        {
+            if( taskLevel[t] != level ) continue;
+            YGraphTask range;
+            range.begin = ops.size();
+
+            for( size_t k = 0; k < taskNodes[t].size(); k++ )
+            {
+                int v = taskNodes[t][k];
+                const Node & node = m_nodes[v];
+                const std::vector<Edge> & inputs = node.inputs;
+                YGraphOp op;
+                op.dsp = NULL;
+                op.gain = 1;
+
+                // take over the buffer of an input that feeds only this
+                int reuse = -1;
+                if( v != m_master )
+                    for( size_t i = 0; i < inputs.size() && reuse < 0; i++ )
+                        if( consumers[inputs[i].from].size() == 1 && slot[inputs[i].from] >= 0 )
+                            reuse = i;
+
+                // pick the output buffer
+                int dst;
+                if( v == m_master ) dst = YGRAPH_OUTPUT;
+                else if( reuse >= 0 ) dst = slot[inputs[reuse].from];
+                else if( freeSlots.size() ) { dst = freeSlots.back(); freeSlots.pop_back(); }
+                else dst = numSlots++;
+                slot[v] = dst;
+
+                // sum the inputs into it
+                if( inputs.size() == 0 )
+                {
+                    // sources overwrite; a bus or an insert with nothing
+                    // in it gets silence (not what's left in the slot)
+                    if( node.dsp == NULL || !node.dsp->source() )
+                    {
+                        op.type = YGraphOp::CLEAR; op.src = -1; op.dst = dst;
+                        ops.push_back( op ); names.push_back( node.name );
+                    }
+                }
+                else
+                {
+                    // the first (or the reused) input copies, the rest mix
+                    // (always in connection order: same sum on any thread)
+                    int first = reuse >= 0 ? reuse : 0;
+                    if( reuse < 0 || inputs[first].gain != 1 )
+                    {
+                        op.type = YGraphOp::COPY; op.src = slot[inputs[first].from];
+                        op.dst = dst; op.gain = inputs[first].gain;
+                        ops.push_back( op ); names.push_back( node.name );
+                    }
+                    for( size_t i = 0; i < inputs.size(); i++ )
+                    {
+                        if( (int)i == first ) continue;
+                        op.type = YGraphOp::MIX; op.src = slot[inputs[i].from];
+                        op.dst = dst; op.gain = inputs[i].gain;
+                        ops.push_back( op ); names.push_back( node.name );
+                    }
+                }
+
+                // run the node
+                if( node.dsp )
+                {
+                    op.type = YGraphOp::PROCESS; op.src = -1; op.dst = dst;
+                    op.gain = 1; op.dsp = node.dsp;
+                    ops.push_back( op ); names.push_back( node.name );
+                }
+
+                // inputs read for the last time give their buffers back
+                for( size_t i = 0; i < inputs.size(); i++ )
+                {
+                    int u = inputs[i].from;
+                    if( --readers[u] == 0 && slot[u] >= 0 && slot[u] != dst )
+                        released.push_back( slot[u] );
+                }
+            }
+
+            range.end = ops.size();
+            program->tasks.push_back( range );
+        }
+
+        freeSlots.insert( freeSlots.end(), released.begin(), released.end() );
+    }
+    program->levels.push_back( program->tasks.size() );
+
+    // the arena
+    program->allocate( numSlots );
+
+    return program;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: commit()
+// desc: compile and hand to the audio thread (picked up on its next run())
+//-----------------------------------------------------------------------------
+bool YGraph::commit()
+{
+    // compile
+    std::string error;
+    YGraphProgram * program = compile( error );
+    if( program == NULL )
+    {
+        // error message
+        cerr << "[y-graph]: cannot compile graph: " << error << endl;
+        return false;
+    }
+
+    // hand over; a program the audio thread never picked up is ours to delete
+    delete m_pending.exchange( program, std::memory_order_acq_rel );
+    // and whatever it's done with
+    collect();
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: collect()
+// desc: delete programs the audio thread is done with (control thread)
+//-----------------------------------------------------------------------------
+void YGraph::collect()
+{
+    delete m_retired.exchange( NULL, std::memory_order_acq_rel );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: render into output (audio thread)
+//-----------------------------------------------------------------------------
+void YGraph::run( float * output, unsigned int numFrames )
+{
+    // swap in a new program at this boundary, once the control thread has
+    // collected the last one (the audio thread never deletes anything)
+    if( m_pending.load( std::memory_order_acquire ) != NULL &&
+        m_retired.load( std::memory_order_acquire ) == NULL )
+    {
+        YGraphProgram * next = m_pending.exchange( NULL, std::memory_order_acq_rel );
+        if( next )
+        {
+            m_retired.store( m_current, std::memory_order_release );
+            m_current = next;
+        }
+    }
+
+    // go
+    if( m_current ) m_current->run( output, numFrames, m_pool );
+    else memset( output, 0, sizeof(float) * numFrames * YGRAPH_CHANNELS );
+}
@@ -0,0 +1,262 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-graph.h
+// desc: small DSP graph: nodes (sources, inserts, buses, master) joined by
+//       gain edges (sends), compiled on edit into a flat, topologically
+//       sorted program over a minimal buffer arena, and swapped into the
+//       audio thread without locks; independent chains (e.g., tracks) run
+//       in parallel on an XWorkerPool
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_GRAPH_H__
+#define __MCD_Y_GRAPH_H__
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include "x-workers.h"
+
+// all graph buffers are interleaved stereo
+#define YGRAPH_CHANNELS 2
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YDSP
+// desc: something a node runs: a source overwrites the buffer, an insert
+//       processes it in place (interleaved stereo)
+//-----------------------------------------------------------------------------
+class YDSP
+{
+public:
+    virtual ~YDSP() { }
+    // process numFrames (audio thread)
+    virtual void process( float * buffer, unsigned int numFrames ) = 0;
+    // does process() overwrite the buffer (a source)? an insert with no
+    // inputs gets silence to work on instead
+    virtual bool source() const { return false; }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YDSPAdapter
+// desc: anything with synthesize2( float *, unsigned int ) as a YDSP
+//       (e.g., YFluidSynth as a source, YEcho as an insert)
+//-----------------------------------------------------------------------------
+template <typename T>
+class YDSPAdapter : public YDSP
+{
+public:
+    YDSPAdapter( T * target, bool source = false )
+        : m_target( target ), m_source( source ) { }
+    virtual void process( float * buffer, unsigned int numFrames )
+    { m_target->synthesize2( buffer, numFrames ); }
+    virtual bool source() const { return m_source; }
+
+protected:
+    T * m_target;
+    bool m_source;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct YGraphOp
+// desc: one step of a compiled program
+//-----------------------------------------------------------------------------
+struct YGraphOp
+{
+    enum Type
+    {
+        CLEAR = 0,  // dst = 0
+        COPY,       // dst = gain * src
+        MIX,        // dst += gain * src
+        PROCESS     // dsp->process( dst )
+    };
+
+    // what
+    Type type;
+    // buffers (arena slots; YGRAPH_OUTPUT == the caller's buffer)
+    int src;
+    int dst;
+    // gain (COPY/MIX)
+    float gain;
+    // the dsp (PROCESS)
+    YDSP * dsp;
+};
+
+// slot that means "the output buffer passed to run()"
+#define YGRAPH_OUTPUT (-1)
+
+// a task: ops [begin, end), run in order on one thread
+struct YGraphTask
+{
+    int begin;
+    int end;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YGraphProgram
+// desc: a compiled graph: ops grouped into tasks, tasks into levels (the
+//       tasks of a level don't depend on each other) + arena
+//-----------------------------------------------------------------------------
+class YGraphProgram
+{
+public:
+    YGraphProgram( unsigned int maxFrames );
+    ~YGraphProgram();
+
+public:
+    // allocate the arena
+    void allocate( int numSlots );
+    // run it into output (audio thread; any numFrames); levels with more
+    // than one task are spread over pool, if any
+    void run( float * output, unsigned int numFrames, XWorkerPool * pool = NULL );
+    // print it
+    void dump() const;
+
+public:
+    // the steps
+    std::vector<YGraphOp> ops;
+    // the tasks, level by level
+    std::vector<YGraphTask> tasks;
+    // first task of each level (+ tasks.size() at the end)
+    std::vector<int> levels;
+    // number of arena buffers
+    int numSlots;
+    // frames per arena buffer
+    unsigned int maxFrames;
+    // node names by step (for dump())
+    std::vector<std::string> names;
+
+protected:
+    // run a task of the current level (XWorkerJob)
+    static void runTask( int index, void * data );
+    // run an op on the current piece
+    void exec( const YGraphOp & op );
+
+protected:
+    // the arena (numSlots x maxFrames x YGRAPH_CHANNELS)
+    float * m_arena;
+    // the current piece, and level (set by run() before each fork)
+    float * m_out;
+    unsigned int m_frames;
+    int m_level;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YGraph
+// desc: editable graph (control thread) + the live program (audio thread)
+//-----------------------------------------------------------------------------
+class YGraph
+{
+public:
+    YGraph( unsigned int maxFrames );
+    ~YGraph();
+
+public: // editing (control thread); nothing changes until commit()
+    // add a node (dsp may be NULL: a plain bus); returns its id
+    int addNode( const std::string & name, YDSP * dsp = NULL );
+    // find a node by name (-1 if none)
+    int find( const std::string & name ) const;
+    // feed from's output into to's input, scaled (a send if gain < 1)
+    bool connect( int from, int to, float gain = 1 );
+    // remove a connection
+    bool disconnect( int from, int to );
+    // set gain on an existing connection
+    bool setGain( int from, int to, float gain );
+    // set the node whose output is the graph's output
+    void setMaster( int node ) { m_master = node; }
+    // run independent tasks on pool (NULL == serial; set before audio starts)
+    void setPool( XWorkerPool * pool ) { m_pool = pool; }
+    // compile and hand to the audio thread (false on error, e.g., a cycle)
+    bool commit();
+    // delete programs the audio thread is done with
+    void collect();
+
+public: // audio thread
+    // render into output (interleaved stereo)
+    void run( float * output, unsigned int numFrames );
+
+public:
+    // compile (no side effects); NULL + error on failure
+    YGraphProgram * compile( std::string & error ) const;
+
+protected:
+    // an edge
+    struct Edge
+    {
+        int from;
+        float gain;
+    };
+    // a node
+    struct Node
+    {
+        std::string name;
+        YDSP * dsp;
+        std::vector<Edge> inputs;
+    };
+
+protected:
+    // the nodes
+    std::vector<Node> m_nodes;
+    // output node
+    int m_master;
+    // arena buffer size
+    unsigned int m_maxFrames;
+    // workers (not ours)
+    XWorkerPool * m_pool;
+
+    // audio thread's program
+    YGraphProgram * m_current;
+    // next program (control -> audio)
+    std::atomic<YGraphProgram *> m_pending;
+    // last program (audio -> control, for deleting)
+    std::atomic<YGraphProgram *> m_retired;
+};
+
+
+
+
+#endif
@@ -0,0 +1,265 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-onset.cpp
+// desc: onsets and tempo from streaming spectra
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-onset.h"
+#include "x-def.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YOnsetDetector()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YOnsetDetector::YOnsetDetector( unsigned int numBins, float hopTime,
+                                float delta, float gap )
+{
+    m_numBins = numBins ? numBins : 1;
+    m_hopTime = hopTime;
+    m_delta = delta;
+    m_gap = gap;
+    m_last = new float[m_numBins];
+    // one-pole mean over YONSET_MEAN seconds of frames
+    m_alpha = 1 - expf( -hopTime / YONSET_MEAN );
+    reset();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YOnsetDetector()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YOnsetDetector::~YOnsetDetector()
+{
+    SAFE_DELETE_ARRAY( m_last );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reset()
+// desc: forget everything
+//-----------------------------------------------------------------------------
+void YOnsetDetector::reset()
+{
+    memset( m_last, 0, sizeof(float) * m_numBins );
+    m_flux[0] = m_flux[1] = m_flux[2] = 0;
+    m_mean = 0;
+    m_frames = 0;
+    m_onset = -1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: frame()
+// desc: flux for this frame; pick the previous one
+//-----------------------------------------------------------------------------
+bool YOnsetDetector::frame( const float * magnitudes )
+{
+    // flux: compressed rises, per bin
+    float sum = 0;
+    for( unsigned int k = 0; k < m_numBins; k++ )
+    {
+        float v = logf( 1 + YONSET_COMPRESS * magnitudes[k] );
+        float d = v - m_last[k];
+        if( d > 0 ) sum += d;
+        m_last[k] = v;
+    }
+    // (the very first frame rises from nothing)
+    if( m_frames == 0 ) sum = 0;
+
+    m_flux[2] = m_flux[1];
+    m_flux[1] = m_flux[0];
+    m_flux[0] = sum / m_numBins;
+    m_frames++;
+
+    // the previous frame: a local maximum, clear of the mean, and of the
+    // last onset (the mean doesn't see it until it's been judged)
+    bool onset = false;
+    double t = ( m_frames - 1 ) * (double)m_hopTime;
+    if( m_flux[1] > m_flux[2] && m_flux[1] >= m_flux[0] &&
+        m_flux[1] > m_mean + m_delta &&
+        ( m_onset < 0 || t - m_onset >= m_gap ) )
+    {
+        m_onset = t;
+        onset = true;
+    }
+    m_mean += m_alpha * ( m_flux[1] - m_mean );
+
+    return onset;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YTempoEstimator()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YTempoEstimator::YTempoEstimator( float minBPM )
+{
+    m_min = minBPM > 0 ? minBPM : YTEMPO_MIN;
+    reset();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reset()
+// desc: forget everything
+//-----------------------------------------------------------------------------
+void YTempoEstimator::reset()
+{
+    memset( m_bins, 0, sizeof(m_bins) );
+    m_count = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: onset()
+// desc: vote for the intervals to the last few onsets
+//-----------------------------------------------------------------------------
+void YTempoEstimator::onset( double t )
+{
+    // the histogram fades with time
+    if( m_count )
+    {
+        double last = m_onsets[( m_count - 1 ) % YTEMPO_ONSETS];
+        float fade = expf( -(float)( t - last ) / YTEMPO_MEMORY );
+        for( int i = 0; i < YTEMPO_BINS; i++ )
+            m_bins[i] *= fade;
+    }
+
+    // intervals, newest first; nearer ones count more
+    unsigned long n = m_count < YTEMPO_ONSETS ? m_count : YTEMPO_ONSETS;
+    for( unsigned long i = 1; i <= n; i++ )
+    {
+        double ioi = t - m_onsets[( m_count - i ) % YTEMPO_ONSETS];
+        if( ioi <= 0 || ioi > YTEMPO_MAX_IOI ) continue;
+        // fold into the octave (position in it, 0 - 1)
+        double octave = log2( 60 / ioi / m_min );
+        octave -= floor( octave );
+        // a triangle, 2 bins either side (circular)
+        float at = (float)( octave * YTEMPO_BINS );
+        int center = (int)floorf( at + .5f );
+        float weight = 1.0f / i;
+        for( int b = center - 2; b <= center + 2; b++ )
+        {
+            float w = 1 - fabsf( b - at ) / 2.5f;
+            if( w > 0 )
+                m_bins[( b + YTEMPO_BINS ) % YTEMPO_BINS] += weight * w;
+        }
+    }
+
+    m_onsets[m_count % YTEMPO_ONSETS] = t;
+    m_count++;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: peak()
+// desc: the biggest bin (-1 if none)
+//-----------------------------------------------------------------------------
+int YTempoEstimator::peak() const
+{
+    int best = -1;
+    float most = 0;
+    for( int i = 0; i < YTEMPO_BINS; i++ )
+        if( m_bins[i] > most ) { most = m_bins[i]; best = i; }
+    return best;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bpm()
+// desc: the peak, interpolated (parabola through it and its neighbours)
+//-----------------------------------------------------------------------------
+float YTempoEstimator::bpm() const
+{
+    int p = peak();
+    if( p < 0 ) return 0;
+
+    float a = m_bins[( p + YTEMPO_BINS - 1 ) % YTEMPO_BINS];
+    float b = m_bins[p];
+    float c = m_bins[( p + 1 ) % YTEMPO_BINS];
+    float den = a - 2 * b + c;
+    float offset = den < 0 ? .5f * ( a - c ) / den : 0;
+    float octave = ( p + offset ) / YTEMPO_BINS;
+    if( octave < 0 ) octave += 1;
+    if( octave >= 1 ) octave -= 1;
+
+    return m_min * powf( 2, octave );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: confidence()
+// desc: share of the votes within 2 bins of the peak
+//-----------------------------------------------------------------------------
+float YTempoEstimator::confidence() const
+{
+    int p = peak();
+    if( p < 0 ) return 0;
+
+    float total = 0, near = 0;
+    for( int i = 0; i < YTEMPO_BINS; i++ )
+    {
+        total += m_bins[i];
+        int d = abs( i - p );
+        if( d > YTEMPO_BINS / 2 ) d = YTEMPO_BINS - d;
+        if( d <= 2 ) near += m_bins[i];
+    }
+
+    return total > 0 ? near / total : 0;
+}
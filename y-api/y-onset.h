@@ -0,0 +1,155 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-onset.h
+// desc: onsets and tempo from streaming spectra: spectral flux per frame
+//       (log magnitudes, rises only), picked against a running mean with
+//       a three-frame local maximum; inter-onset intervals vote into a
+//       one-octave tempo histogram. constant memory, bounded work per frame
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_ONSET_H__
+#define __MCD_Y_ONSET_H__
+
+// magnitude compression: log( 1 + YONSET_COMPRESS |X| )
+#define YONSET_COMPRESS 100
+// a peak must clear the running mean by this much (flux per bin)
+#define YONSET_DELTA 0.05f
+// running mean time constant (seconds)
+#define YONSET_MEAN 0.5f
+// shortest time between onsets (seconds)
+#define YONSET_GAP 0.06f
+
+// tempo octave: [ YTEMPO_MIN, 2 YTEMPO_MIN ) beats per minute
+#define YTEMPO_MIN 60
+// histogram bins per octave
+#define YTEMPO_BINS 120
+// onsets remembered (each new one pairs with these)
+#define YTEMPO_ONSETS 8
+// longest interval that counts (seconds)
+#define YTEMPO_MAX_IOI 2.0f
+// histogram memory time constant (seconds)
+#define YTEMPO_MEMORY 4.0f
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YOnsetDetector
+// desc: spectral flux onset detector, one magnitude frame at a time; an
+//       onset is reported one frame late (it has to be a local maximum)
+//-----------------------------------------------------------------------------
+class YOnsetDetector
+{
+public:
+    // numBins magnitudes per frame, hopTime seconds apart
+    YOnsetDetector( unsigned int numBins, float hopTime,
+                    float delta = YONSET_DELTA, float gap = YONSET_GAP );
+    ~YOnsetDetector();
+
+public:
+    // next frame (e.g., YSpectrum's); true if the previous one was an onset
+    bool frame( const float * magnitudes );
+    // forget everything
+    void reset();
+
+public:
+    // time of the last onset (seconds of frames; the frame's newest hop)
+    double time() const { return m_onset; }
+    // the last frame's flux, and its running mean
+    float flux() const { return m_flux[0]; }
+    float mean() const { return m_mean; }
+    // frames seen
+    unsigned long long frames() const { return m_frames; }
+
+protected:
+    unsigned int m_numBins;
+    float m_hopTime;
+    float m_delta;
+    float m_gap;
+    // last frame, compressed
+    float * m_last;
+    // flux: this frame, one back, two back
+    float m_flux[3];
+    // running mean, and its coefficient
+    float m_mean;
+    float m_alpha;
+    unsigned long long m_frames;
+    // last onset (seconds; negative: none yet)
+    double m_onset;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YTempoEstimator
+// desc: tempo from onset times: each onset's intervals to the last few,
+//       folded into one octave, vote into a decaying histogram
+//-----------------------------------------------------------------------------
+class YTempoEstimator
+{
+public:
+    YTempoEstimator( float minBPM = YTEMPO_MIN );
+
+public:
+    // an onset at t seconds (increasing)
+    void onset( double t );
+    // forget everything
+    void reset();
+
+public:
+    // best tempo, in [ min, 2 min ) (0 if nothing yet)
+    float bpm() const;
+    // how much of the histogram backs it (0 - 1)
+    float confidence() const;
+    // onsets seen
+    unsigned long count() const { return m_count; }
+
+protected:
+    // peak bin
+    int peak() const;
+
+protected:
+    float m_min;
+    // histogram (log-spaced, circular: an octave)
+    float m_bins[YTEMPO_BINS];
+    // last onsets (ring)
+    double m_onsets[YTEMPO_ONSETS];
+    unsigned long m_count;
+};
+
+
+
+
+#endif
@@ -0,0 +1,195 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-scene.cpp
+// desc: flattened scene
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-scene.h"
+
+
+// a parallel update of one table's active set
+struct YFlatFork
+{
+    YFlatTableBase * table;
+    const YFlatScene * scene;
+    unsigned long count;
+    unsigned long grain;
+    YTimeInterval dt;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update_range()
+// desc: update one job's worth of a table (XWorkerJob)
+//-----------------------------------------------------------------------------
+static void update_range( int index, void * data )
+{
+    YFlatFork * f = (YFlatFork *)data;
+    unsigned long begin = index * f->grain;
+    unsigned long end = begin + f->grain < f->count ? begin + f->grain : f->count;
+    f->table->update( f->dt, *f->scene, begin, end );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YFlatScene()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YFlatScene::YFlatScene()
+{
+    m_numChildren = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YFlatScene()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YFlatScene::~YFlatScene()
+{
+    // out of the graph before the tables go
+    for( size_t i = 0; i < m_entities.size(); i++ )
+        m_entities[i]->removeAllChildren();
+    removeAllChildren();
+
+    // the tables (and the entities in them)
+    for( size_t i = 0; i < m_tables.size(); i++ )
+        delete m_tables[i];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: numAwake()
+// desc: number in the active set
+//-----------------------------------------------------------------------------
+unsigned long YFlatScene::numAwake() const
+{
+    unsigned long n = 0;
+    for( size_t i = 0; i < m_tables.size(); i++ )
+        n += m_tables[i]->awake.size();
+
+    return n;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wake()
+// desc: back into the active set
+//-----------------------------------------------------------------------------
+void YFlatScene::wake( YEntity * e )
+{
+    for( size_t i = 0; i < m_tables.size(); i++ )
+    {
+        int index = m_tables[i]->index( e );
+        if( index >= 0 ) { m_tables[i]->wake( index ); return; }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: find()
+// desc: node index of one of our entities
+//-----------------------------------------------------------------------------
+int YFlatScene::find( const YEntity * e ) const
+{
+    for( size_t i = 0; i < m_tables.size(); i++ )
+    {
+        int index = m_tables[i]->index( e );
+        if( index >= 0 ) return m_tables[i]->nodes[index];
+    }
+
+    return -1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: updateAll()
+// desc: each table in one loop, then plain children
+//-----------------------------------------------------------------------------
+void YFlatScene::updateAll( YTimeInterval dt )
+{
+    // check
+    if( !active ) return;
+
+    // update self
+    update( dt );
+
+    // each type, its active set (split across the pool if independent and
+    // not nested: a job then reads only its own entities' active flags)
+    for( size_t i = 0; i < m_tables.size(); i++ )
+    {
+        YFlatTableBase * table = m_tables[i];
+        YFlatFork f;
+        int jobs = 1;
+        if( independent && !table->nested && forkable() )
+            jobs = split( table->awake.size(), f.grain );
+        if( jobs > 1 )
+        {
+            f.table = table;
+            f.scene = this;
+            f.count = table->awake.size();
+            f.dt = dt;
+            fork( update_range, &f, jobs );
+            table->compact();
+        }
+        else
+            table->update( dt, *this );
+    }
+
+    // plain children (sorted out again only when children change)
+    if( children.size() != m_numChildren )
+    {
+        m_plain.clear();
+        for( size_t i = 0; i < children.size(); i++ )
+            if( find( children[i] ) < 0 ) m_plain.push_back( children[i] );
+        m_numChildren = children.size();
+    }
+    // ... the usual way
+    for( size_t i = 0; i < m_plain.size(); i++ )
+        m_plain[i]->updateAll( dt );
+}
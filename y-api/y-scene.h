@@ -0,0 +1,305 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-scene.h
+// desc: flattened scene: entities stored by value in contiguous per-type
+//       tables (one allocation per type, not per entity) with parent
+//       indices, updated in one tight, non-virtual loop per type instead of
+//       a recursive walk, over only the entities still moving (an active
+//       set: settled ones drop out until woken); each entity is still a
+//       YEntity in the scene graph (addChild, drawAll, fields), so the
+//       usual API works on it as before
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_SCENE_H__
+#define __MCD_Y_SCENE_H__
+
+#include <vector>
+#include <typeinfo>
+#include "y-entity.h"
+
+// forward reference
+template <typename T> class YFlatTable;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YFlatTableBase
+// desc: a table of one type of entity (see YFlatTable)
+//-----------------------------------------------------------------------------
+class YFlatTableBase
+{
+public:
+    YFlatTableBase() : nested( false ) { }
+    virtual ~YFlatTableBase() { }
+
+public:
+    // update awake items [begin, end) that are live, marking the ones that
+    // settle as leaving (ranges can run in parallel)
+    virtual void update( YTimeInterval dt, const YFlatScene & scene,
+                         size_t begin, size_t end ) = 0;
+    // item index of an entity (-1 if it isn't one of ours)
+    virtual int index( const YEntity * e ) const = 0;
+    // the type stored
+    virtual const std::type_info & type() const = 0;
+
+public:
+    // update the whole active set, then drop the settled
+    void update( YTimeInterval dt, const YFlatScene & scene )
+    { update( dt, scene, 0, awake.size() ); compact(); }
+    // drop the ones leaving from the active set
+    void compact()
+    { size_t k = 0;
+      for( size_t j = 0; j < awake.size(); j++ )
+        if( asleep[awake[j]] == YFLAT_LEAVING ) asleep[awake[j]] = YFLAT_ASLEEP;
+        else awake[k++] = awake[j];
+      awake.resize( k ); }
+    // back into the active set (or never mind leaving it)
+    void wake( int i )
+    { if( asleep[i] == YFLAT_ASLEEP ) awake.push_back( i );
+      asleep[i] = YFLAT_AWAKE; }
+
+public:
+    // item states
+    enum { YFLAT_AWAKE = 0, YFLAT_ASLEEP, YFLAT_LEAVING };
+    // scene node index of each item
+    std::vector<int> nodes;
+    // the active set (item indices), and each item's state
+    std::vector<int> awake;
+    std::vector<char> asleep;
+    // any item under another entity (not the scene)? its liveness reads
+    // that entity's active flag, so the table never updates in parallel
+    bool nested;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YFlatScene
+// desc: a subtree whose entities live in per-type tables; updateAll() runs
+//       one loop per type over its awake entities, skipping any that aren't
+//       live (inactive, or under an inactive parent); one that's settled()
+//       after its update leaves the active set until wake() (its setters
+//       call that). plain (heap) entities can still be added directly to
+//       the scene and are updated as usual. if independent, each table
+//       whose entities are all directly under the scene has its active set
+//       split across the update pool (see YEntity), so updates must not
+//       wake() or touch other entities then (each job reads and writes
+//       only its own entities' flags); tables with nested entities update
+//       serially, after the tables made before them.
+//       NOTE: within a type, entities update in about creation order, and
+//       types in the order their tables were made (not depth first);
+//       entities live as long as the scene (deactivate them instead)
+//-----------------------------------------------------------------------------
+class YFlatScene : public YEntity
+{
+public:
+    YFlatScene();
+    virtual ~YFlatScene();
+
+public:
+    // make room for capacity entities of type T (before the first create<T>)
+    template <typename T> void reserve( unsigned long capacity );
+    // a new T, stored with the others of its type, added under parent (the
+    // scene if NULL, else one of the scene's entities); NULL if T's table
+    // is full or parent isn't ours
+    template <typename T> T * create( YEntity * parent = NULL );
+    // number of entities (over all tables)
+    unsigned long size() const { return m_entities.size(); }
+    // number in the active set
+    unsigned long numAwake() const;
+
+public:
+    // back into the active set (see YEntity::wake())
+    void wake( YEntity * e );
+    // is a node active, all the way up?
+    bool live( int node ) const
+    { for( ; node >= 0; node = m_parents[node] )
+        if( !m_entities[node]->active ) return false;
+      return true; }
+
+public:
+    // updates the tables, then any plain children
+    virtual void updateAll( YTimeInterval dt );
+
+protected:
+    // T's table (NULL if none yet)
+    template <typename T> YFlatTable<T> * table();
+    // node index of one of our entities (-1 if none)
+    int find( const YEntity * e ) const;
+
+protected:
+    // the tables, one per type
+    std::vector<YFlatTableBase *> m_tables;
+    // by node: the entity, its parent's node (-1: the scene)
+    std::vector<YEntity *> m_entities;
+    std::vector<int> m_parents;
+    // our children that aren't in a table, and how many children that was
+    // worked out from (children only grow, or are all removed)
+    std::vector<YEntity *> m_plain;
+    size_t m_numChildren;
+};
+
+// table capacity when create<T>() comes before reserve<T>()
+#define YFLAT_DEFAULT_CAPACITY 1024
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YFlatTable
+// desc: entities of type T, by value, in one array; capacity is fixed up
+//       front so pointers to them stay valid (same as YFlarePool)
+//-----------------------------------------------------------------------------
+template <typename T>
+class YFlatTable : public YFlatTableBase
+{
+public:
+    YFlatTable( unsigned long capacity ) { items.reserve( capacity ); }
+
+public:
+    // a new item for node, awake (NULL when full)
+    T * create( int node )
+    {
+        if( items.size() == items.capacity() ) return NULL;
+        items.resize( items.size() + 1 );
+        nodes.push_back( node );
+        asleep.push_back( 0 );
+        awake.push_back( (int)items.size() - 1 );
+        return &items.back();
+    }
+
+    // update awake, live items: T's own update() and settled(), called
+    // directly (not live: skipped, but stays in the set)
+    virtual void update( YTimeInterval dt, const YFlatScene & scene,
+                         size_t begin, size_t end )
+    {
+        for( size_t j = begin; j < end; j++ )
+        {
+            int i = awake[j];
+            if( !scene.live( nodes[i] ) ) continue;
+            items[i].T::update( dt );
+            // done: leaving the set
+            if( items[i].T::settled() ) asleep[i] = YFLAT_LEAVING;
+        }
+    }
+
+    // item index of an entity
+    virtual int index( const YEntity * e ) const
+    {
+        if( items.empty() ) return -1;
+        const T * t = static_cast<const T *>( e );
+        // by address: is it inside our array?
+        if( t < &items[0] || t >= &items[0] + items.size() ) return -1;
+        return (int)( t - &items[0] );
+    }
+
+    // the type
+    virtual const std::type_info & type() const { return typeid(T); }
+
+public:
+    // the entities
+    std::vector<T> items;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: table()
+// desc: T's table, if there is one
+//-----------------------------------------------------------------------------
+template <typename T>
+YFlatTable<T> * YFlatScene::table()
+{
+    for( size_t i = 0; i < m_tables.size(); i++ )
+        if( m_tables[i]->type() == typeid(T) )
+            return static_cast<YFlatTable<T> *>( m_tables[i] );
+    return NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reserve()
+// desc: make T's table, with room for capacity
+//-----------------------------------------------------------------------------
+template <typename T>
+void YFlatScene::reserve( unsigned long capacity )
+{
+    // already there (its capacity can't change; pointers are out there)
+    if( table<T>() ) return;
+    m_tables.push_back( new YFlatTable<T>( capacity ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: create()
+// desc: a new T under parent
+//-----------------------------------------------------------------------------
+template <typename T>
+T * YFlatScene::create( YEntity * parent )
+{
+    // parent's node
+    int p = -1;
+    if( parent != NULL && parent != this )
+    {
+        p = find( parent );
+        if( p < 0 ) return NULL;
+    }
+
+    // the table
+    if( !table<T>() ) reserve<T>( YFLAT_DEFAULT_CAPACITY );
+    T * e = table<T>()->create( (int)m_entities.size() );
+    if( e == NULL ) return NULL;
+    e->scene = this;
+    if( p >= 0 ) table<T>()->nested = true;
+
+    // the node
+    m_entities.push_back( e );
+    m_parents.push_back( p );
+    // into the graph (for drawing and the rest of the API)
+    ( parent != NULL ? parent : this )->addChild( e );
+
+    return e;
+}
+
+
+
+
+#endif
@@ -0,0 +1,253 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-spectrum.cpp
+// desc: streaming spectrum analyser
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-spectrum.h"
+#include "y-fft.h"
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+// ring (frames of slack for the analysis thread), chunk off it (frames)
+#define YSPECTRUM_RING 16384
+#define YSPECTRUM_CHUNK 512
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YSpectrum()
+// desc: constructor (allocates everything; nothing allocates after this)
+//-----------------------------------------------------------------------------
+YSpectrum::YSpectrum( float srate, unsigned int size, unsigned int hop,
+                      YSpectrumWindow window, unsigned int channels )
+    : m_ring( YSPECTRUM_RING * ( channels ? channels : 1 ) ),
+      m_callback( NULL ), m_callbackData( NULL ), m_frames( 0 ),
+      m_thread( NULL ), m_running( false )
+{
+    // sanity check
+    if( size < 4 ) size = 4;
+    if( hop < 1 ) hop = 1;
+    if( hop > size ) hop = size;
+    if( channels < 1 ) channels = 1;
+
+    m_srate = srate;
+    m_size = 4;
+    while( m_size < size ) m_size <<= 1;
+    m_hop = hop;
+    m_channels = channels;
+    m_fft = YFFTPlan::get( m_size / 2 );
+    m_cursor = 0;
+    m_head = 0;
+    m_fill = 0;
+
+    m_history = new SAMPLE[m_size]();
+    m_chunk = new SAMPLE[YSPECTRUM_CHUNK * channels];
+    m_scratch = new SAMPLE[m_size];
+    m_out.init( m_size / 2 );
+
+    // window
+    switch( window )
+    {
+        case YSPECTRUM_HAMMING: m_window = YFFTPlan::window( YFFT_HAMMING, m_size ); break;
+        case YSPECTRUM_BLACKMAN: m_window = YFFTPlan::window( YFFT_BLACKMAN, m_size ); break;
+        default: m_window = YFFTPlan::window( YFFT_HANNING, m_size ); break;
+    }
+
+    // rfft scales by 1/size; a sine of amplitude a at a bin center then
+    // reads a * sum( window ) / ( 2 size )
+    double sum = 0;
+    for( unsigned int i = 0; i < m_size; i++ )
+        sum += m_window[i];
+    m_norm = (float)( 2 * m_size / sum );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YSpectrum()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YSpectrum::~YSpectrum()
+{
+    stop();
+    SAFE_DELETE( m_thread );
+    SAFE_DELETE_ARRAY( m_history );
+    SAFE_DELETE_ARRAY( m_chunk );
+    SAFE_DELETE_ARRAY( m_scratch );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: push()
+// desc: hand over interleaved frames (audio thread: just a copy)
+//-----------------------------------------------------------------------------
+void YSpectrum::push( const SAMPLE * buffer, unsigned int numFrames )
+{
+    m_ring.put( buffer, (long)numFrames * m_channels );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start()
+// desc: run the analysis thread (from now on)
+//-----------------------------------------------------------------------------
+bool YSpectrum::start()
+{
+    // check
+    if( m_running.load() ) return true;
+
+    // from now
+    m_cursor = m_ring.written();
+    if( m_thread == NULL ) m_thread = new XThread();
+    m_running = true;
+    if( !m_thread->start( thread, this ) )
+    {
+        m_running = false;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stop()
+// desc: stop the analysis thread
+//-----------------------------------------------------------------------------
+void YSpectrum::stop()
+{
+    // check
+    if( !m_running.exchange( false ) ) return;
+
+    m_thread->wait();
+    m_thread->clear();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyse()
+// desc: drain the ring, a frame every hop
+//-----------------------------------------------------------------------------
+long YSpectrum::analyse()
+{
+    long produced = 0;
+    long n;
+
+    while( ( n = m_ring.get( m_cursor, m_chunk, YSPECTRUM_CHUNK * m_channels ) / m_channels ) > 0 )
+    {
+        const SAMPLE * in = m_chunk;
+        for( long i = 0; i < n; i++, in += m_channels )
+        {
+            // mix down into the newest hop
+            SAMPLE v = 0;
+            for( unsigned int c = 0; c < m_channels; c++ )
+                v += in[c];
+            m_history[m_head] = v / m_channels;
+            m_head = ( m_head + 1 ) & ( m_size - 1 );
+
+            // a hop's worth: analyse
+            if( ++m_fill == m_hop )
+            {
+                frame();
+                m_fill = 0;
+                produced++;
+            }
+        }
+    }
+
+    return produced;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: frame()
+// desc: window, fft, magnitudes, callback, publish
+//-----------------------------------------------------------------------------
+void YSpectrum::frame()
+{
+    // window + transform, oldest first (packed: x[1] is nyquist)
+    m_fft->rfftWindowed( m_scratch, m_history, m_size, m_head, m_window );
+
+    // magnitudes
+    float * mag = m_out.back();
+    mag[0] = fabs( m_scratch[0] ) * m_norm;
+    for( unsigned int k = 1; k < m_size / 2; k++ )
+    {
+        SAMPLE re = m_scratch[2*k], im = m_scratch[2*k+1];
+        mag[k] = sqrt( re * re + im * im ) * m_norm;
+    }
+
+    // whoever wants every frame
+    if( m_callback ) m_callback( mag, m_size / 2, m_callbackData );
+
+    // hand it over
+    m_out.publish();
+    m_frames++;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: thread()
+// desc: analysis thread: drain every half hop
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE YSpectrum::thread( void * data )
+{
+    YSpectrum * self = (YSpectrum *)data;
+    useconds_t nap = (useconds_t)( self->hopTime() * 500000 );
+    if( nap < 1000 ) nap = 1000;
+
+    while( self->m_running.load() )
+    {
+        self->analyse();
+        usleep( nap );
+    }
+
+    return 0;
+}
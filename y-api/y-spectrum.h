@@ -0,0 +1,160 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-spectrum.h
+// desc: streaming spectrum analyser: the audio thread drops frames into a
+//       ring (a copy, nothing else); an analysis thread runs overlapped,
+//       windowed ffts and publishes the latest magnitudes through a triple
+//       buffer, for the graphics (or anyone) to pick up
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_SPECTRUM_H__
+#define __MCD_Y_SPECTRUM_H__
+
+#include "x-audio.h"
+#include "x-buffer.h"
+#include "x-thread.h"
+#include <atomic>
+
+// default fft size and hop (frames)
+#define YSPECTRUM_SIZE 1024
+#define YSPECTRUM_HOP 256
+
+// forward reference
+class YFFTPlan;
+
+// every frame's magnitudes, on the analysis thread (see setCallback())
+typedef void (* YSpectrumCallback)( const float * magnitudes,
+                                    unsigned int numBins, void * data );
+
+// analysis window
+enum YSpectrumWindow
+{
+    YSPECTRUM_HANNING = 0,
+    YSPECTRUM_HAMMING,
+    YSPECTRUM_BLACKMAN
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YSpectrum
+// desc: streaming spectrum analyser (interleaved in, mixed to mono)
+//-----------------------------------------------------------------------------
+class YSpectrum
+{
+public:
+    // size: power of 2; hop <= size
+    YSpectrum( float srate, unsigned int size = YSPECTRUM_SIZE,
+               unsigned int hop = YSPECTRUM_HOP,
+               YSpectrumWindow window = YSPECTRUM_HANNING,
+               unsigned int channels = 2 );
+    ~YSpectrum();
+
+public: // audio thread
+    // hand over numFrames (interleaved); never blocks
+    void push( const SAMPLE * buffer, unsigned int numFrames );
+
+public: // analysis
+    // run the analysis thread
+    bool start();
+    // stop it
+    void stop();
+    // analyse whatever's waiting; returns frames produced (the thread calls
+    // this; call it directly when there's no thread, e.g., offline)
+    long analyse();
+    // see every frame as it's made, on the analysis thread (the reader
+    // side only gets the newest); set before start()
+    void setCallback( YSpectrumCallback callback, void * data = NULL )
+    { m_callback = callback; m_callbackData = data; }
+
+public: // reader (one thread, e.g., graphics)
+    // newest magnitudes (numBins(); a full-scale sine reads ~1)
+    const float * magnitudes() { return m_out.front(); }
+    // anything new since the last magnitudes()?
+    bool fresh() const { return m_out.fresh(); }
+
+public:
+    // bins (size / 2)
+    unsigned int numBins() const { return m_size / 2; }
+    // center frequency of a bin
+    float frequency( unsigned int bin ) const { return bin * m_srate / m_size; }
+    // analysis frames so far
+    unsigned long long frames() const { return m_frames.load(); }
+    // seconds between frames
+    float hopTime() const { return m_hop / m_srate; }
+
+protected:
+    // one frame from the history
+    void frame();
+    // analysis thread
+    static THREAD_RETURN THREAD_TYPE thread( void * data );
+
+protected:
+    float m_srate;
+    unsigned int m_size;
+    unsigned int m_hop;
+    unsigned int m_channels;
+    const YFFTPlan * m_fft;
+    // audio -> analysis
+    XRingBuffer<SAMPLE> m_ring;
+    unsigned long long m_cursor;
+    // the last size samples (mono; circular, oldest at m_head), and how
+    // many of the newest hop are in
+    SAMPLE * m_history;
+    unsigned int m_head;
+    unsigned int m_fill;
+    // interleaved chunk off the ring, fft scratch
+    SAMPLE * m_chunk;
+    SAMPLE * m_scratch;
+    // window (shared; see YFFTPlan::window())
+    const SAMPLE * m_window;
+    // magnitude scale (window gain, fft scaling)
+    float m_norm;
+    // analysis -> reader
+    XTripleBuffer<float> m_out;
+    // analysis -> callback
+    YSpectrumCallback m_callback;
+    void * m_callbackData;
+    std::atomic<unsigned long long> m_frames;
+
+    // the thread
+    XThread * m_thread;
+    std::atomic<bool> m_running;
+};
+
+
+
+
+#endif
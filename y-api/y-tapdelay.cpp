@@ -0,0 +1,313 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: y-tapdelay.cpp
+// desc: multi-tap delay on a shared line
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#include "y-tapdelay.h"
+#include "x-fun.h"
+#include <math.h>
+#include <string.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YTapDelay()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YTapDelay::YTapDelay( int srate, float maxDelay, float feedbackCoefficient,
+                      float fxMix )
+    : m_numTaps( 0 ), m_feedbackTap( -1 )
+{
+    m_srate = srate;
+    m_maxDelay = maxDelay;
+
+    // allocate (everything up front; nothing in synthesize2())
+    m_line.init( (long)( m_srate * m_maxDelay ) );
+    m_in = new float[YTAPDELAY_BLOCK];
+    m_tap = new float[YTAPDELAY_BLOCK];
+    m_feedback = new float[YTAPDELAY_BLOCK];
+    m_wet[0] = new float[YTAPDELAY_BLOCK];
+    m_wet[1] = new float[YTAPDELAY_BLOCK];
+
+    // set slews
+    m_iFeedback.set( feedbackCoefficient, feedbackCoefficient, 1 );
+    m_iFxMix.set( fxMix, fxMix, 1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YTapDelay()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YTapDelay::~YTapDelay()
+{
+    // clean up
+    SAFE_DELETE_ARRAY( m_in );
+    SAFE_DELETE_ARRAY( m_tap );
+    SAFE_DELETE_ARRAY( m_feedback );
+    SAFE_DELETE_ARRAY( m_wet[0] );
+    SAFE_DELETE_ARRAY( m_wet[1] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: clear the delay line
+//-----------------------------------------------------------------------------
+void YTapDelay::clear()
+{
+    m_line.clear();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: addTap()
+// desc: add a tap (set up before it's published to the audio thread)
+//-----------------------------------------------------------------------------
+int YTapDelay::addTap( float delaySeconds, float left, float right )
+{
+    int tap = m_numTaps.load();
+    // full
+    if( tap >= YTAPDELAY_MAX_TAPS ) return -1;
+
+    // clamp
+    float d = XFun::clampf( delaySeconds, 0, m_maxDelay );
+    // set slews
+    m_iDelay[tap].set( d, d, 5 );
+    m_iLeft[tap].set( left, left, 1 );
+    m_iRight[tap].set( right, right, 1 );
+    // publish
+    m_numTaps.store( tap + 1, std::memory_order_release );
+
+    return tap;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setDelay()
+// desc: set a tap's delay
+//-----------------------------------------------------------------------------
+void YTapDelay::setDelay( int tap, float inSeconds )
+{
+    // sanity check
+    assert( tap >= 0 );
+    assert( tap < YTAPDELAY_MAX_TAPS );
+
+    // clamp
+    float v = XFun::clampf( inSeconds, 0, m_maxDelay );
+    // set
+    m_iDelay[tap].update( v );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setGain()
+// desc: set a tap's left/right gains
+//-----------------------------------------------------------------------------
+void YTapDelay::setGain( int tap, float left, float right )
+{
+    // sanity check
+    assert( tap >= 0 );
+    assert( tap < YTAPDELAY_MAX_TAPS );
+
+    m_iLeft[tap].update( left );
+    m_iRight[tap].update( right );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setFeedback()
+// desc: set the feedback coefficient
+//-----------------------------------------------------------------------------
+void YTapDelay::setFeedback( float coef )
+{
+    // clamp
+    float v = XFun::clampf( coef, 0, 1 );
+    // set
+    m_iFeedback.update( v );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: setFxMix()
+// desc: set the dry/wet mix
+//-----------------------------------------------------------------------------
+void YTapDelay::setFxMix( float mix )
+{
+    // clamp
+    float v = XFun::clampf( mix, 0, 1 );
+    // set
+    m_iFxMix.update( v );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: advance()
+// desc: advance a slew by numFrames samples at once (same curve as calling
+//       interp( 1/srate ) per sample); returns the new value
+//-----------------------------------------------------------------------------
+float YTapDelay::advance( Vector3D & slew, unsigned int numFrames )
+{
+    // settled
+    if( slew.value == slew.goal ) return slew.value;
+
+    // value -> goal, geometrically, per sample
+    float k = 1.0f - slew.slew / m_srate;
+    slew.value = slew.goal + (slew.value - slew.goal) * powf( k, (float)numFrames );
+    // close enough
+    if( fabsf( slew.value - slew.goal ) < 1e-6f ) slew.value = slew.goal;
+
+    return slew.value;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: synthesize2()
+// desc: do it! (interleaved stereo, in place)
+//-----------------------------------------------------------------------------
+int YTapDelay::synthesize2( float * buffer, unsigned int numFrames )
+{
+    int taps = m_numTaps.load( std::memory_order_acquire );
+    int fbTap = m_feedbackTap < taps ? m_feedbackTap : -1;
+
+    // parameters at the start and the end of the buffer
+    float fbStart = m_iFeedback.value;
+    float fbEnd = advance( m_iFeedback, numFrames );
+    float mixStart = m_iFxMix.value;
+    float mixEnd = advance( m_iFxMix, numFrames );
+    float dStart[YTAPDELAY_MAX_TAPS], dEnd[YTAPDELAY_MAX_TAPS];
+    float lStart[YTAPDELAY_MAX_TAPS], lEnd[YTAPDELAY_MAX_TAPS];
+    float rStart[YTAPDELAY_MAX_TAPS], rEnd[YTAPDELAY_MAX_TAPS];
+    for( int t = 0; t < taps; t++ )
+    {
+        dStart[t] = m_iDelay[t].value * m_srate;
+        dEnd[t] = advance( m_iDelay[t], numFrames ) * m_srate;
+        lStart[t] = m_iLeft[t].value;
+        lEnd[t] = advance( m_iLeft[t], numFrames );
+        rStart[t] = m_iRight[t].value;
+        rEnd[t] = advance( m_iRight[t], numFrames );
+    }
+
+    // per-sample steps
+    float fbInc = ( fbEnd - fbStart ) / numFrames;
+    float mixInc = ( mixEnd - mixStart ) / numFrames;
+
+    // blocks
+    for( unsigned int done = 0; done < numFrames; )
+    {
+        // block size: a read must never see this block's writes, so no
+        // longer than the shortest delay in it
+        long n = numFrames - done;
+        if( n > YTAPDELAY_BLOCK ) n = YTAPDELAY_BLOCK;
+        for( int t = 0; t < taps; t++ )
+        {
+            float dInc = ( dEnd[t] - dStart[t] ) / numFrames;
+            float a = dStart[t] + dInc * done;
+            float b = a + dInc * n;
+            long shortest = (long)( a < b ? a : b );
+            if( shortest < 1 ) shortest = 1;
+            if( n > shortest ) n = shortest;
+        }
+
+        // input: both channels into the one line
+        float * frame = buffer + done * 2;
+        for( long i = 0; i < n; i++ )
+            m_in[i] = 0.5f * ( frame[2*i] + frame[2*i+1] );
+
+        // taps: read, pan, sum
+        memset( m_wet[0], 0, sizeof(float) * n );
+        memset( m_wet[1], 0, sizeof(float) * n );
+        for( int t = 0; t < taps; t++ )
+        {
+            // delay (in samples) across this block; at least one sample
+            float dInc = ( dEnd[t] - dStart[t] ) / numFrames;
+            float d0 = dStart[t] + dInc * done;
+            if( d0 < 1 ) d0 = 1;
+            m_line.read( m_tap, n, d0, d0 + dInc * n < 1 ? 0 : dInc );
+
+            // gains
+            float lInc = ( lEnd[t] - lStart[t] ) / numFrames;
+            float rInc = ( rEnd[t] - rStart[t] ) / numFrames;
+            float l = lStart[t] + lInc * done;
+            float r = rStart[t] + rInc * done;
+            for( long i = 0; i < n; i++, l += lInc, r += rInc )
+            {
+                m_wet[0][i] += l * m_tap[i];
+                m_wet[1][i] += r * m_tap[i];
+            }
+
+            // feedback source
+            if( t == fbTap ) memcpy( m_feedback, m_tap, sizeof(float) * n );
+        }
+        if( fbTap < 0 ) memset( m_feedback, 0, sizeof(float) * n );
+
+        // write
+        m_line.write( m_in, m_feedback, n, fbStart + fbInc * done, fbInc );
+
+        // mix
+        float mix = mixStart + mixInc * done;
+        for( long i = 0; i < n; i++, mix += mixInc )
+        {
+            frame[2*i] += mix * ( m_wet[0][i] - frame[2*i] );
+            frame[2*i+1] += mix * ( m_wet[1][i] - frame[2*i+1] );
+        }
+
+        // advance
+        m_line.advance( n );
+        done += n;
+    }
+
+    // return frames
+    return numFrames;
+}
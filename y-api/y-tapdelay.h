@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------
+  Y-API: higher-level objects for audio/graphics/interaction programming
+         (sibling of X-API; part of MCD-API)
+
+  Copyright (c) 2013 Ge Wang
+    All rights reserved.
+    http://ccrma.stanford.edu/~ge/
+
+  Music, Computing, Design API
+    http://ccrma.stanford.edu/~ge/software/mcd-api/
+
+  Music, Computing, Design Group @ CCRMA, Stanford University
+    http://ccrma.stanford.edu/groups/mcd/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+  U.S.A.
+-----------------------------------------------------------------------------*/
+
+
+//-----------------------------------------------------------------------------
+// name: y-tapdelay.h
+// desc: multi-tap delay: any number of fractional read taps (each with its
+//       own delay and left/right gain) on one shared delay line; one write
+//       and one read per tap per sample, and no memory per tap
+//
+// author: agent (agent@local)
+//   date: 2026
+//-----------------------------------------------------------------------------
+#ifndef __MCD_Y_TAPDELAY_H__
+#define __MCD_Y_TAPDELAY_H__
+
+#include "x-vector3d.h"
+#include "y-echo.h"
+#include <atomic>
+
+// frames processed per inner block
+#define YTAPDELAY_BLOCK YDELAYLINE_BLOCK
+// max taps
+#define YTAPDELAY_MAX_TAPS 16
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class YTapDelay
+// desc: multi-tap delay (stereo in, summed to mono into the line; taps
+//       panned back out to stereo); parameters ramp linearly across blocks
+//-----------------------------------------------------------------------------
+class YTapDelay
+{
+public:
+    // constructor
+    YTapDelay( int srate, float maxDelay = 2.0, float feedbackCoefficient = 0,
+               float fxMix = 1 );
+    // destructor
+    virtual ~YTapDelay();
+
+public:
+    // fill buffer (interleaved stereo, in place)
+    virtual int synthesize2( float * buffer, unsigned int numFrames );
+    // clear the delay line
+    void clear();
+
+public: // taps (no allocation: fine while running)
+    // add a tap; returns its index (-1 if there's no room)
+    int addTap( float delaySeconds, float left = 1, float right = 1 );
+    // set a tap's delay
+    void setDelay( int tap, float inSeconds );
+    // set a tap's gains
+    void setGain( int tap, float left, float right );
+    // number of taps
+    int numTaps() const { return m_numTaps.load(); }
+
+public:
+    // feed this tap (-1 == none) back into the line, scaled
+    void setFeedbackTap( int tap ) { m_feedbackTap = tap; }
+    void setFeedback( float coef );
+    void setFxMix( float mix );
+
+protected:
+    // advance a slew by numFrames samples; returns the new value
+    float advance( Vector3D & slew, unsigned int numFrames );
+
+private:
+    float m_srate;
+    float m_maxDelay;
+
+    // the line
+    YDelayLine m_line;
+    // scratch: one block of input, a tap, feedback, and the stereo sum
+    float * m_in;
+    float * m_tap;
+    float * m_feedback;
+    float * m_wet[2];
+
+    // taps (slews: delay in seconds, gains)
+    std::atomic<int> m_numTaps;
+    Vector3D m_iDelay[YTAPDELAY_MAX_TAPS];
+    Vector3D m_iLeft[YTAPDELAY_MAX_TAPS];
+    Vector3D m_iRight[YTAPDELAY_MAX_TAPS];
+    // feedback
+    int m_feedbackTap;
+    Vector3D m_iFeedback;
+    Vector3D m_iFxMix;
+};
+
+
+
+
+#endif
@@ -35,7 +35,12 @@
 // name: Ge Wang (ge@ccrma.stanford.edu)
 // date: spring 2013
 //-----------------------------------------------------------------------------
+// buffer objects (GL 1.5) are in glext.h on some platforms
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
 #include "y-waveform.h"
+#include <string.h>
 #include <iostream>
 using namespace std;
 
@@ -52,6 +57,18 @@ YWaveform::YWaveform()
     m_buffer = NULL;
     m_vertices = NULL;
     m_numFrames = 0;
+    m_size = 0;
+    m_written = 0;
+    memset( m_levels, 0, sizeof(m_levels) );
+    m_numLevels = 0;
+    m_span = 0;
+    m_columns = 0;
+    m_numVertices = 0;
+    m_maxVertices = 0;
+    m_vbo = 0;
+    m_vboVertices = 0;
+    m_dirty = true;
+    m_lastColumns = 0;
     // default width and height
     m_width = 2;
     m_height = 1;
@@ -71,6 +88,8 @@ YWaveform::~YWaveform()
 {
     // clean up
     cleanup();
+    // the vertex buffer
+    if( m_vbo ) glDeleteBuffers( 1, &m_vbo );
 }
 
 
@@ -84,9 +103,13 @@ bool YWaveform::init( unsigned int numFrames )
 {
     // clean up first
     cleanup();
+
+    // ring: a power of 2
+    m_size = 1;
+    while( m_size < numFrames ) m_size <<= 1;
     
     // try to allocate
-    m_buffer = new SAMPLE[numFrames];
+    m_buffer = new SAMPLE[m_size]();
     // check it
     if( !m_buffer )
     {
@@ -95,20 +118,19 @@ bool YWaveform::init( unsigned int numFrames )
         cleanup();
         return false;
     }
-    
-    // allocate vertex buffer
-    m_vertices = new XPoint2D[numFrames];
-    // check it
-    if( !m_vertices )
+
+    // pyramid levels, down to one block
+    m_numLevels = 1;
+    while( ( m_size >> m_numLevels ) >= 1 && m_numLevels < YWAVEFORM_MAX_LEVELS )
     {
-        // log
-        cerr << "[y-waveform]: cannot allocate vertex buffer..." << endl;
-        cleanup();
-        return false;
+        m_levels[m_numLevels] = new SAMPLE[2 * ( m_size >> m_numLevels )]();
+        m_numLevels++;
     }
     
     // set the buffer size
     m_numFrames = numFrames;
+    m_written = 0;
+    m_dirty = true;
     
     return true;
 }
@@ -125,9 +147,16 @@ void YWaveform::cleanup()
     // check
     if( m_buffer != NULL ) SAFE_DELETE_ARRAY( m_buffer );
     if( m_vertices != NULL ) SAFE_DELETE_ARRAY( m_vertices );
+    for( int l = 0; l < YWAVEFORM_MAX_LEVELS; l++ )
+        SAFE_DELETE_ARRAY( m_levels[l] );
     
     // zero out
     m_numFrames = 0;
+    m_size = 0;
+    m_numLevels = 0;
+    m_written = 0;
+    m_numVertices = 0;
+    m_maxVertices = 0;
 }
 
 
@@ -147,11 +176,101 @@ void YWaveform::set( const SAMPLE * monoBuffer, unsigned int numFrames )
     // compare against buffer size
     if( howmuch > m_numFrames ) howmuch = m_numFrames;
     
-    // copy it
-    memcpy( m_buffer, monoBuffer, numFrames*sizeof(SAMPLE) );
-    
-    // generate vertices
-    generate();
+    // start over, and copy it
+    m_written = 0;
+    push( monoBuffer, howmuch );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: push()
+// desc: append data (pyramid kept up as it goes)
+//-----------------------------------------------------------------------------
+void YWaveform::push( const SAMPLE * monoBuffer, unsigned int numFrames )
+{
+    // sanity check
+    if( !m_buffer ) return;
+
+    for( unsigned int i = 0; i < numFrames; i++ )
+        add( monoBuffer[i] );
+
+    // vertices are stale
+    m_dirty = true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: add()
+// desc: one sample in; each completed block updates the level above it
+//-----------------------------------------------------------------------------
+void YWaveform::add( SAMPLE v )
+{
+    m_buffer[m_written & ( m_size - 1 )] = v;
+    m_written++;
+
+    for( int l = 1; l < m_numLevels; l++ )
+    {
+        // block at level l complete?
+        if( m_written & ( ( 1ULL << l ) - 1 ) ) break;
+        unsigned long long b = ( m_written >> l ) - 1;
+        SAMPLE lo, hi;
+        if( l == 1 )
+        {
+            SAMPLE a = m_buffer[( 2 * b ) & ( m_size - 1 )];
+            SAMPLE c = m_buffer[( 2 * b + 1 ) & ( m_size - 1 )];
+            lo = a < c ? a : c; hi = a < c ? c : a;
+        }
+        else
+        {
+            unsigned long long mask = ( m_size >> ( l - 1 ) ) - 1;
+            const SAMPLE * a = m_levels[l-1] + 2 * ( ( 2 * b ) & mask );
+            const SAMPLE * c = m_levels[l-1] + 2 * ( ( 2 * b + 1 ) & mask );
+            lo = a[0] < c[0] ? a[0] : c[0];
+            hi = a[1] > c[1] ? a[1] : c[1];
+        }
+        SAMPLE * out = m_levels[l] + 2 * ( b & ( ( m_size >> l ) - 1 ) );
+        out[0] = lo; out[1] = hi;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: range()
+// desc: min / max of [begin, end) from the biggest aligned blocks that fit
+//       (O(log) of the length; everything must still be in the history)
+//-----------------------------------------------------------------------------
+void YWaveform::range( unsigned long long begin, unsigned long long end,
+                       SAMPLE & lo, SAMPLE & hi ) const
+{
+    lo = 1e30f; hi = -1e30f;
+    while( begin < end )
+    {
+        // biggest block starting here that fits
+        int l = 0;
+        while( l + 1 < m_numLevels && !( begin & ( ( 1ULL << ( l + 1 ) ) - 1 ) ) &&
+               begin + ( 1ULL << ( l + 1 ) ) <= end )
+            l++;
+
+        if( l == 0 )
+        {
+            SAMPLE v = m_buffer[begin & ( m_size - 1 )];
+            if( v < lo ) lo = v;
+            if( v > hi ) hi = v;
+        }
+        else
+        {
+            const SAMPLE * p = m_levels[l] + 2 * ( ( begin >> l ) & ( ( m_size >> l ) - 1 ) );
+            if( p[0] < lo ) lo = p[0];
+            if( p[1] > hi ) hi = p[1];
+        }
+        begin += 1ULL << l;
+    }
 }
 
 
@@ -177,10 +296,38 @@ void YWaveform::update( YTimeInterval dt )
 
 //-----------------------------------------------------------------------------
 // name: render()
-// desc: render
+// desc: render (regenerates / uploads only when something changed)
 //-----------------------------------------------------------------------------
 void YWaveform::render()
 {
+    // columns: as set, or the viewport's width
+    unsigned int columns = m_columns;
+    if( columns == 0 )
+    {
+        GLint viewport[4];
+        glGetIntegerv( GL_VIEWPORT, viewport );
+        columns = viewport[2] > 0 ? viewport[2] : 1;
+    }
+
+    // new vertices to the GPU (same buffer; it only ever grows)
+    if( m_dirty || columns != m_lastColumns )
+    {
+        generate( columns );
+        if( m_vbo == 0 ) glGenBuffers( 1, &m_vbo );
+        glBindBuffer( GL_ARRAY_BUFFER, m_vbo );
+        if( m_vboVertices < m_maxVertices )
+        {
+            m_vboVertices = m_maxVertices;
+            glBufferData( GL_ARRAY_BUFFER, m_vboVertices * sizeof(XPoint2D), NULL, GL_DYNAMIC_DRAW );
+        }
+        glBufferSubData( GL_ARRAY_BUFFER, 0, m_numVertices * sizeof(XPoint2D), m_vertices );
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        m_dirty = false;
+        m_lastColumns = columns;
+    }
+    // nothing
+    if( m_numVertices == 0 ) return;
+
     // disable light
     glDisable( GL_LIGHTING );
     // set blend function
@@ -193,10 +340,12 @@ void YWaveform::render()
 
     // set color
     glColor4f( col.x, col.y, col.z, alpha );
-    // set pointer
-    glVertexPointer( 2, GL_FLOAT, 0, m_vertices );
+    // set pointer (into the buffer object)
+    glBindBuffer( GL_ARRAY_BUFFER, m_vbo );
+    glVertexPointer( 2, GL_FLOAT, 0, NULL );
     // draw it
-    glDrawArrays( GL_LINE_STRIP, 0, m_numFrames );
+    glDrawArrays( GL_LINE_STRIP, 0, m_numVertices );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
     
     // disable client state
     glDisableClientState( GL_VERTEX_ARRAY );
@@ -209,22 +358,294 @@ void YWaveform::render()
 
 //-----------------------------------------------------------------------------
 // name: generate()
-// desc: generate vertices
+// desc: generate vertices: one per sample if they fit in the columns, else
+//       a min / max pair per column; columns sit on fixed multiples of their
+//       width (so they don't shimmer as the history scrolls)
 //-----------------------------------------------------------------------------
-void YWaveform::generate()
+void YWaveform::generate( unsigned int columns )
 {
     // sanity check
     if( !m_buffer ) return;
+    if( columns < 1 ) columns = 1;
+
+    // room: a pair per column, plus partial columns at each end
+    if( m_maxVertices < 2 * columns + 4 )
+    {
+        SAFE_DELETE_ARRAY( m_vertices );
+        m_maxVertices = 2 * columns + 4;
+        m_vertices = new XPoint2D[m_maxVertices];
+    }
+    m_numVertices = 0;
+
+    // what's shown: the newest span frames
+    unsigned long long span = m_span ? m_span : m_numFrames;
+    if( span > m_size ) span = m_size;
+    unsigned long long shown = m_written < span ? m_written : span;
+    if( shown == 0 ) return;
+    unsigned long long first = m_written - shown;
+
+    GLfloat x0 = -m_width/2;
+    GLfloat inc = m_width / span;
+
+    // few enough: every sample
+    if( shown <= columns )
+    {
+        for( unsigned long long i = first; i < m_written; i++ )
+        {
+            XPoint2D & v = m_vertices[m_numVertices++];
+            v.x = x0 + ( i - first ) * inc;
+            v.y = m_buffer[i & ( m_size - 1 )] * m_height;
+        }
+        return;
+    }
+
+    // column width (frames); each column is a few pyramid blocks
+    unsigned long long width = ( span + columns - 1 ) / columns;
+
+    // columns on multiples of width (the ends may be partial)
+    unsigned long long c = first - first % width;
+    bool flip = false;
+    for( ; c < m_written; c += width )
+    {
+        unsigned long long begin = c < first ? first : c;
+        unsigned long long end = c + width < m_written ? c + width : m_written;
+        SAMPLE lo, hi;
+        range( begin, end, lo, hi );
+        // zig-zag, so the strip doesn't cross back over each column
+        GLfloat x = x0 + ( ( begin + end ) / 2.0 - first ) * inc;
+        m_vertices[m_numVertices++] = XPoint2D( x, ( flip ? hi : lo ) * m_height );
+        m_vertices[m_numVertices++] = XPoint2D( x, ( flip ? lo : hi ) * m_height );
+        flip = !flip;
+    }
+}
+
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: YWaveformHistory()
+// desc: constructor
+//-----------------------------------------------------------------------------
+YWaveformHistory::YWaveformHistory()
+{
+    // zero out
+    m_columns = 0;
+    m_rows = 0;
+    m_minmax = NULL;
+    m_written = 0;
+    m_uploaded = 0;
+    m_texture = 0;
+    m_staging = NULL;
+    // default width and height
+    m_width = 2;
+    m_height = 1;
+
+    // set slew
+    m_iAlpha.set( 1, 1, 1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~YWaveformHistory()
+// desc: destructor
+//-----------------------------------------------------------------------------
+YWaveformHistory::~YWaveformHistory()
+{
+    // clean up
+    cleanup();
+    // the texture
+    if( m_texture ) glDeleteTextures( 1, &m_texture );
+}
+
+
 
-    SAMPLE x = -m_width/2;
-    SAMPLE inc = m_width / m_numFrames;
 
-    // iterate over buffer
-    for( int i = 0; i < m_numFrames; i++ )
+//-----------------------------------------------------------------------------
+// name: init()
+// desc: initialize
+//-----------------------------------------------------------------------------
+bool YWaveformHistory::init( unsigned int columns, unsigned int rows )
+{
+    // clean up first
+    cleanup();
+
+    // sanity check
+    m_columns = 1;
+    while( m_columns < columns ) m_columns <<= 1;
+    m_rows = rows < 2 ? 2 : rows;
+
+    // allocate
+    m_minmax = new SAMPLE[2 * m_columns]();
+    m_staging = new unsigned char[m_columns * m_rows];
+    m_written = 0;
+    m_uploaded = 0;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cleanup()
+// desc: clean up
+//-----------------------------------------------------------------------------
+void YWaveformHistory::cleanup()
+{
+    SAFE_DELETE_ARRAY( m_minmax );
+    SAFE_DELETE_ARRAY( m_staging );
+    m_columns = 0;
+    m_written = 0;
+    m_uploaded = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: column()
+// desc: the next column
+//-----------------------------------------------------------------------------
+void YWaveformHistory::column( SAMPLE lo, SAMPLE hi )
+{
+    // sanity check
+    if( !m_minmax ) return;
+
+    SAMPLE * c = m_minmax + 2 * ( m_written & ( m_columns - 1 ) );
+    c[0] = lo < hi ? lo : hi;
+    c[1] = lo < hi ? hi : lo;
+    m_written++;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: update
+//-----------------------------------------------------------------------------
+void YWaveformHistory::update( YTimeInterval dt )
+{
+    // interpolate
+    m_iAlpha.interp( dt );
+
+    // set
+    alpha = m_iAlpha.value;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: raster()
+// desc: a column's texels: lit from min to max (at least one)
+//-----------------------------------------------------------------------------
+void YWaveformHistory::raster( unsigned long long c, unsigned char * out,
+                               unsigned int stride ) const
+{
+    const SAMPLE * mm = m_minmax + 2 * ( c & ( m_columns - 1 ) );
+    // -1 .. 1 to rows
+    int lo = (int)floorf( ( mm[0] + 1 ) * .5f * m_rows );
+    int hi = (int)floorf( ( mm[1] + 1 ) * .5f * m_rows );
+    if( lo < 0 ) lo = 0;
+    if( hi >= (int)m_rows ) hi = m_rows - 1;
+    if( lo > hi ) lo = hi;
+
+    for( int r = 0; r < (int)m_rows; r++ )
+        out[r * stride] = ( r >= lo && r <= hi ) ? 255 : 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: upload()
+// desc: columns [begin, end), all in one stretch of the ring, as one
+//       sub-image
+//-----------------------------------------------------------------------------
+void YWaveformHistory::upload( unsigned long long begin, unsigned long long end )
+{
+    unsigned int n = (unsigned int)( end - begin );
+    if( n == 0 ) return;
+
+    for( unsigned int i = 0; i < n; i++ )
+        raster( begin + i, m_staging + i, n );
+
+    glTexSubImage2D( GL_TEXTURE_2D, 0, (GLint)( begin & ( m_columns - 1 ) ), 0,
+                     n, m_rows, GL_LUMINANCE, GL_UNSIGNED_BYTE, m_staging );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render()
+// desc: new columns to the texture, then one quad, oldest at the left
+//-----------------------------------------------------------------------------
+void YWaveformHistory::render()
+{
+    // sanity check
+    if( !m_minmax ) return;
+
+    // the texture (blank)
+    if( m_texture == 0 )
+    {
+        glGenTextures( 1, &m_texture );
+        glBindTexture( GL_TEXTURE_2D, m_texture );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+        memset( m_staging, 0, m_columns * m_rows );
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        glTexImage2D( GL_TEXTURE_2D, 0, GL_LUMINANCE, m_columns, m_rows, 0,
+                      GL_LUMINANCE, GL_UNSIGNED_BYTE, m_staging );
+    }
+    glBindTexture( GL_TEXTURE_2D, m_texture );
+
+    // new columns (no further back than the ring goes), split at the wrap
+    if( m_written - m_uploaded > m_columns ) m_uploaded = m_written - m_columns;
+    if( m_uploaded < m_written )
     {
-        // x coordinate
-        m_vertices[i].x = x; x += inc;
-        // y coordinate
-        m_vertices[i].y = m_buffer[i] * m_height;
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        unsigned long long wrap = ( m_uploaded | ( m_columns - 1 ) ) + 1;
+        if( wrap < m_written )
+        {
+            upload( m_uploaded, wrap );
+            upload( wrap, m_written );
+        }
+        else
+            upload( m_uploaded, m_written );
+        m_uploaded = m_written;
     }
+
+    // the oldest column is the next to be written
+    GLfloat s0 = (GLfloat)( m_written & ( m_columns - 1 ) ) / m_columns;
+    GLfloat s1 = s0 + 1;
+    GLfloat w = m_width / 2, h = m_height / 2;
+
+    // disable light
+    glDisable( GL_LIGHTING );
+    // additive, like YWaveform
+    glBlendFunc( GL_ONE, GL_ONE );
+    glEnable( GL_BLEND );
+    glEnable( GL_TEXTURE_2D );
+    glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+
+    // set color
+    glColor4f( col.x, col.y, col.z, alpha );
+    // one quad
+    glBegin( GL_QUADS );
+    glTexCoord2f( s0, 0 ); glVertex2f( -w, -h );
+    glTexCoord2f( s1, 0 ); glVertex2f( w, -h );
+    glTexCoord2f( s1, 1 ); glVertex2f( w, h );
+    glTexCoord2f( s0, 1 ); glVertex2f( -w, h );
+    glEnd();
+
+    glDisable( GL_TEXTURE_2D );
+    // disable blend
+    glDisable( GL_BLEND );
 }
@@ -42,12 +42,20 @@
 #include "x-gfx.h"
 #include "y-entity.h"
 
+// most pyramid levels (level l: min / max of 2^l samples)
+#define YWAVEFORM_MAX_LEVELS 32
+// history texture: columns (time) x rows (amplitude)
+#define YWAVEFORM_HISTORY_COLUMNS 1024
+#define YWAVEFORM_HISTORY_ROWS 128
+
 
 
 
 //-----------------------------------------------------------------------------
 // name: class YWaveform
-// desc: mono waveform visualization
+// desc: mono waveform visualization: a history of samples with a min / max
+//       pyramid kept up as they arrive, so any span draws at most one
+//       min / max pair per pixel column (from a persistent vertex buffer)
 //-----------------------------------------------------------------------------
 class YWaveform : public YEntity
 {
@@ -58,26 +66,32 @@ public:
     ~YWaveform();
 
 public:
-    // initialize
+    // initialize (history of numFrames)
     bool init( unsigned int numFrames );
     // clean up
     void cleanup();
     // set width
-    void setWidth( GLfloat width ) { m_width = width; generate(); }
+    void setWidth( GLfloat width ) { m_width = width; m_dirty = true; }
     // set height
-    void setHeight( GLfloat height ) { m_height = height; generate(); }
+    void setHeight( GLfloat height ) { m_height = height; m_dirty = true; }
     // get width
     GLfloat getWidth() const { return m_width; }
     // get height
     GLfloat getHeight() const { return m_height; }
+    // show the newest frames (0 == the whole history)
+    void setSpan( unsigned int frames ) { m_span = frames; m_dirty = true; }
+    // pixel columns across the width (0 == the viewport's width)
+    void setColumns( unsigned int columns ) { m_columns = columns; m_dirty = true; }
     // fade
     void fade( GLfloat targetAlpha, GLfloat slew = 1 )
     { if( slew <= 0 ) m_iAlpha.updateSet(targetAlpha);
       else m_iAlpha.update( targetAlpha, slew ); }
 
 public:
-    // copy data to be visualized
+    // copy data to be visualized (replaces the history)
     void set( const SAMPLE * monoBuffer, unsigned int numFrames );
+    // append data (the oldest falls off)
+    void push( const SAMPLE * monoBuffer, unsigned int numFrames );
 
 public:
     // update
@@ -85,17 +99,45 @@ public:
     // render
     void render();
 
+public:
+    // vertices for this many columns (render() does this; no GL)
+    void generate( unsigned int columns );
+    // the last generate()'s vertices (a line strip)
+    const XPoint2D * vertices() const { return m_vertices; }
+    unsigned int numVertices() const { return m_numVertices; }
+
 protected:
-    // generate vertices
-    void generate();
-    
+    // one sample in, pyramid up
+    void add( SAMPLE v );
+    // min / max of absolute frames [begin, end)
+    void range( unsigned long long begin, unsigned long long end,
+                SAMPLE & lo, SAMPLE & hi ) const;
+
 protected:
-    // buffer (mono)
+    // history (mono; ring of m_size, a power of 2)
     SAMPLE * m_buffer;
-    // buffer size
+    // history shown at most
     unsigned int m_numFrames;
-    // vertex array
+    unsigned int m_size;
+    // frames in so far
+    unsigned long long m_written;
+    // pyramid: level l (>= 1) is min, max pairs for m_size >> l blocks
+    SAMPLE * m_levels[YWAVEFORM_MAX_LEVELS];
+    int m_numLevels;
+    // span shown, columns across (0: defaults)
+    unsigned int m_span;
+    unsigned int m_columns;
+
+    // vertices (staging), count, room
     XPoint2D * m_vertices;
+    unsigned int m_numVertices;
+    unsigned int m_maxVertices;
+    // ... and on the GPU (made on first render; grows, never shrinks)
+    GLuint m_vbo;
+    unsigned int m_vboVertices;
+    // anything to regenerate / upload?
+    bool m_dirty;
+    unsigned int m_lastColumns;
 
     // width of waveform
     GLfloat m_width;
@@ -109,4 +151,82 @@ protected:
 
 
 
+
+//-----------------------------------------------------------------------------
+// name: class YWaveformHistory
+// desc: long scrolling waveform: one min / max column at a time, written
+//       into a ring texture (a sub-image per frame, new columns only) and
+//       drawn as one quad, scrolled by the ring's offset; the cost doesn't
+//       depend on how much history there is
+//-----------------------------------------------------------------------------
+class YWaveformHistory : public YEntity
+{
+public:
+    // constructor
+    YWaveformHistory();
+    // destructor
+    ~YWaveformHistory();
+
+public:
+    // initialize (columns: a power of 2)
+    bool init( unsigned int columns = YWAVEFORM_HISTORY_COLUMNS,
+               unsigned int rows = YWAVEFORM_HISTORY_ROWS );
+    // clean up
+    void cleanup();
+    // set width
+    void setWidth( GLfloat width ) { m_width = width; }
+    // set height
+    void setHeight( GLfloat height ) { m_height = height; }
+    // get width
+    GLfloat getWidth() const { return m_width; }
+    // get height
+    GLfloat getHeight() const { return m_height; }
+    // fade
+    void fade( GLfloat targetAlpha, GLfloat slew = 1 )
+    { if( slew <= 0 ) m_iAlpha.updateSet(targetAlpha);
+      else m_iAlpha.update( targetAlpha, slew ); }
+
+public:
+    // the next column (newest, at the right): min and max, -1 to 1
+    void column( SAMPLE lo, SAMPLE hi );
+    // columns so far
+    unsigned long long numColumns() const { return m_written; }
+
+public:
+    // update
+    void update( YTimeInterval dt );
+    // render
+    void render();
+
+protected:
+    // a column's texels (rows of them, bottom up)
+    void raster( unsigned long long c, unsigned char * out, unsigned int stride ) const;
+    // send columns [begin, end) (no wrap) to the texture
+    void upload( unsigned long long begin, unsigned long long end );
+
+protected:
+    // ring size (columns), texels per column
+    unsigned int m_columns;
+    unsigned int m_rows;
+    // min, max per column (ring)
+    SAMPLE * m_minmax;
+    // columns in, and on the texture
+    unsigned long long m_written;
+    unsigned long long m_uploaded;
+    // the texture (made on first render), sub-image staging (rows x columns)
+    GLuint m_texture;
+    unsigned char * m_staging;
+
+    // width of waveform
+    GLfloat m_width;
+    // height of waveform
+    GLfloat m_height;
+
+    // for fading
+    Vector3D m_iAlpha;
+};
+
+
+
+
 #endif